@@ -1995,6 +1995,125 @@ extern "C" {
  */
 #define SDL_HINT_RENDER_METAL_PREFER_LOW_POWER_DEVICE "SDL_RENDER_METAL_PREFER_LOW_POWER_DEVICE"
 
+/**
+ * A variable controlling how many GPU textures back a streaming texture in
+ * the Xbox Direct3D 8 renderer.
+ *
+ * Streaming textures are locked directly in GPU-visible memory, without a
+ * staging copy. Every lock moves on to the next buffer so the CPU does not
+ * write a frame the GPU is still reading; a lock of part of the texture
+ * copies the rest of the previous buffer first.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "1": Single buffer, locks may wait for the GPU
+ * - "2": Double buffering
+ * - "3": Triple buffering
+ *
+ * By default streaming textures are double buffered. The hint is checked
+ * when the texture is created.
+ */
+#define SDL_HINT_RENDER_XBOX_STREAMING_BUFFERS "SDL_RENDER_XBOX_STREAMING_BUFFERS"
+
+/**
+ * A variable controlling whether the Xbox Direct3D 8 renderer packs small
+ * textures into shared atlas pages.
+ *
+ * Static textures of up to 64x64 pixels in a non-FOURCC format are placed in
+ * 512x512 pages, one set of pages per pixel format. Copies from different
+ * textures in the same page can then be drawn in one batch. Space in a page
+ * is only reused once every texture in it has been destroyed.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "0": Every texture gets its own GPU texture (default)
+ * - "1": Small static textures share atlas pages
+ *
+ * The hint is checked when the texture is created.
+ */
+#define SDL_HINT_RENDER_XBOX_ATLAS "SDL_RENDER_XBOX_ATLAS"
+
+/**
+ * A variable controlling how many frame buffers the Xbox Direct3D 8 renderer
+ * uses.
+ *
+ * With triple buffering Present() only waits for the display when two
+ * finished frames are already queued, at the cost of one more frame of
+ * memory and latency.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "2": Double buffering (default)
+ * - "3": Triple buffering
+ *
+ * The hint is checked when the renderer is created.
+ */
+#define SDL_HINT_RENDER_XBOX_FRAME_BUFFERS "SDL_RENDER_XBOX_FRAME_BUFFERS"
+
+/**
+ * A variable controlling whether the Xbox Direct3D 8 renderer flips to a new
+ * frame without waiting for the vertical blank.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "0": Present at the vertical blank (default)
+ * - "1": Present immediately; frames may tear
+ *
+ * The hint is checked when the renderer is created.
+ */
+#define SDL_HINT_RENDER_XBOX_PRESENT_IMMEDIATE "SDL_RENDER_XBOX_PRESENT_IMMEDIATE"
+
+/**
+ * A variable controlling how much memory the Xbox Direct3D 8 renderer keeps
+ * in destroyed render target textures for reuse.
+ *
+ * A new target texture takes the memory of a destroyed one of the same size
+ * and format when one is kept, which avoids allocation spikes and
+ * fragmentation when targets are created and destroyed often. The least
+ * recently destroyed targets are freed first once the limit is reached.
+ *
+ * The value is the limit in kilobytes; "0" disables the pool. The default is
+ * "8192". The hint is checked when the renderer is created.
+ */
+#define SDL_HINT_RENDER_XBOX_TARGET_POOL "SDL_RENDER_XBOX_TARGET_POOL"
+
+/**
+ * A variable setting a budget for the texture memory of the Xbox Direct3D 8
+ * renderer.
+ *
+ * Static textures keep a staging copy of their pixels. When the
+ * D3DPOOL_DEFAULT memory of all textures exceeds the budget, the GPU copies
+ * of the least recently drawn static textures are freed, and rebuilt from
+ * the staging copy the next time they are drawn. The budget is enforced when
+ * a texture is created and after each present. Regardless of the budget,
+ * textures are evicted when creating a texture runs out of memory.
+ *
+ * The value is the budget in kilobytes; "0" (the default) sets no budget.
+ * The hint is checked when the renderer is created.
+ */
+#define SDL_HINT_RENDER_XBOX_TEXTURE_BUDGET "SDL_RENDER_XBOX_TEXTURE_BUDGET"
+
+/**
+ * A variable enabling the low latency mode of the Xbox DirectSound audio
+ * driver.
+ *
+ * Normally the driver writes one buffer of spec.samples ahead of the one
+ * playing. In low latency mode the DirectSound buffer is a ring of many
+ * small periods of spec.samples frames each, kept locked, and the driver
+ * writes the given number of periods ahead of the play cursor, skipping
+ * forward if it falls behind. Combine it with a small spec.samples such as
+ * 128 or 256 frames.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "0": Normal buffering (default)
+ * - "N": Keep N periods written ahead of the play cursor; "2" or "3" is a
+ *   good start
+ *
+ * The hint is checked when the audio device is opened.
+ */
+#define SDL_HINT_AUDIO_XBOX_LOW_LATENCY "SDL_AUDIO_XBOX_LOW_LATENCY"
+
 /**
  * A variable containing a list of ROG gamepad capable mice.
  *
@@ -631,6 +631,322 @@ extern DECLSPEC int SDLCALL SDL_GDKGetDefaultUser(XUserHandle * outUserHandle);
 
 #endif
 
+/* Platform specific functions for the original Xbox */
+#if defined(__XBOX__)
+
+/**
+ * Block-compressed texture formats accepted by the Xbox renderer.
+ *
+ * Textures in these formats must be SDL_TEXTUREACCESS_STATIC with
+ * power-of-two dimensions. SDL_UpdateTexture() takes the raw DXT blocks:
+ * `pitch` is the size in bytes of one row of 4x4 blocks, and the rect must
+ * start on a block boundary. They cannot be converted to or from surfaces.
+ */
+#define SDL_PIXELFORMAT_DXT1 SDL_DEFINE_PIXELFOURCC('D', 'X', 'T', '1')
+#define SDL_PIXELFORMAT_DXT3 SDL_DEFINE_PIXELFOURCC('D', 'X', 'T', '3')
+#define SDL_PIXELFORMAT_DXT5 SDL_DEFINE_PIXELFOURCC('D', 'X', 'T', '5')
+
+/**
+ * Per-frame counters collected by the Xbox Direct3D 8 renderer.
+ *
+ * `commands` is the number of draw commands SDL_render handed to the
+ * backend, `draws` is the number of DrawPrimitive calls actually issued after
+ * batching. The ratio between the two is the merge ratio. `upload_bytes` is
+ * the number of texel bytes copied from staging into GPU textures, in
+ * `texture_uploads` copies. `vertex_bytes` is the size of the vertices and
+ * indices queued. `states_issued` counts render state, texture stage state
+ * and texture bindings written to the device, `states_filtered` those
+ * dropped because the device already had that value.
+ *
+ * `gpu_time_us` is the time the GPU spent on the last frame it finished,
+ * which is usually a frame or two behind the other counters; see
+ * SDL_RenderGetXboxFrameTiming().
+ */
+typedef struct SDL_XboxRenderStats
+{
+    Uint32 commands;
+    Uint32 draws;
+    Uint32 upload_bytes;
+    Uint32 states_issued;
+    Uint32 states_filtered;
+    Uint32 texture_uploads;
+    Uint32 vertex_bytes;
+    Uint32 gpu_time_us;
+} SDL_XboxRenderStats;
+
+/**
+ * Get the counters of the last presented frame of an Xbox renderer.
+ *
+ * \param renderer the renderer to query.
+ * \param stats a pointer filled in with the counters of the last frame.
+ * \returns 0 on success or a negative error code if `renderer` is not the
+ *          Xbox Direct3D 8 renderer; call SDL_GetError() for more
+ *          information.
+ */
+extern DECLSPEC int SDLCALL SDL_RenderGetXboxStats(SDL_Renderer *renderer, SDL_XboxRenderStats *stats);
+
+/**
+ * Show or hide a bar graph of the render counters on an Xbox renderer.
+ *
+ * The bars are drawn over each presented frame, from the top: GPU time (256
+ * pixels per refresh period, red when over), draws, commands, states issued,
+ * kilobytes of texture uploads and kilobytes of vertices.
+ *
+ * \param renderer the Xbox renderer.
+ * \param enabled SDL_TRUE to draw the overlay, SDL_FALSE to stop.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \sa SDL_RenderGetXboxStats
+ */
+extern DECLSPEC int SDLCALL SDL_RenderSetXboxStatsOverlay(SDL_Renderer *renderer, SDL_bool enabled);
+
+/**
+ * Set the width of the points and lines an Xbox renderer draws.
+ *
+ * Points become squares of this size and lines are drawn this wide, both
+ * centred on the pixel they start from. The width applies to points and
+ * lines drawn after the call; it is in render coordinates and defaults to 1.
+ *
+ * \param renderer the Xbox renderer.
+ * \param width the width, greater than 0.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ */
+extern DECLSPEC int SDLCALL SDL_RenderSetXboxLineWidth(SDL_Renderer *renderer, float width);
+
+/**
+ * Texture memory used by the Xbox Direct3D 8 renderer, in bytes.
+ *
+ * `default_bytes` counts D3DPOOL_DEFAULT memory: the GPU copies of textures,
+ * streaming buffers, atlas pages and the idle render targets kept for reuse
+ * (`pooled_target_bytes`, see SDL_HINT_RENDER_XBOX_TARGET_POOL).
+ * `systemmem_bytes` counts the D3DPOOL_SYSTEMMEM staging copies of static
+ * textures. `evicted_textures` is the number of textures whose GPU copy is
+ * currently freed to stay within `budget_bytes` (see
+ * SDL_HINT_RENDER_XBOX_TEXTURE_BUDGET), `evictions` the number of GPU copies
+ * freed since the renderer was created.
+ */
+typedef struct SDL_XboxTextureMemory
+{
+    Uint32 default_bytes;
+    Uint32 systemmem_bytes;
+    Uint32 pooled_target_bytes;
+    Uint32 budget_bytes;
+    Uint32 evicted_textures;
+    Uint32 evictions;
+} SDL_XboxTextureMemory;
+
+/**
+ * Get the texture memory used by an Xbox renderer.
+ *
+ * \param renderer the renderer to query.
+ * \param memory a pointer filled in with the memory in use.
+ * \returns 0 on success or a negative error code if `renderer` is not the
+ *          Xbox Direct3D 8 renderer; call SDL_GetError() for more
+ *          information.
+ *
+ * \sa SDL_GetXboxTextureMemory
+ */
+extern DECLSPEC int SDLCALL SDL_RenderGetXboxTextureMemory(SDL_Renderer *renderer, SDL_XboxTextureMemory *memory);
+
+/**
+ * Get the memory used by one texture of an Xbox renderer.
+ *
+ * A texture placed in an atlas page reports the size of its area of the
+ * page.
+ *
+ * \param texture the texture to query.
+ * \param default_bytes a pointer filled in with the D3DPOOL_DEFAULT bytes,
+ *                      may be NULL.
+ * \param systemmem_bytes a pointer filled in with the D3DPOOL_SYSTEMMEM
+ *                        bytes, may be NULL.
+ * \returns 0 on success or a negative error code if `texture` does not
+ *          belong to the Xbox Direct3D 8 renderer; call SDL_GetError() for
+ *          more information.
+ *
+ * \sa SDL_RenderGetXboxTextureMemory
+ */
+extern DECLSPEC int SDLCALL SDL_GetXboxTextureMemory(SDL_Texture *texture, Uint32 *default_bytes, Uint32 *systemmem_bytes);
+
+/**
+ * Set colors in the palette of an SDL_PIXELFORMAT_INDEX8 texture of an Xbox
+ * renderer.
+ *
+ * The Xbox renderer supports INDEX8 textures (static or streaming, not
+ * render targets); the GPU looks their texels up in a 256 entry palette as
+ * it samples them, so changing the palette recolors the texture without
+ * uploading it again. A new texture starts with an opaque grey ramp.
+ * SDL_CreateTextureFromSurface() copies the palette of an INDEX8 surface.
+ *
+ * Draws already issued keep the colors they were issued with.
+ *
+ * \param texture the INDEX8 texture to change.
+ * \param colors an array of SDL_Color structures to copy into the palette.
+ * \param firstcolor the index of the first palette entry to modify.
+ * \param ncolors the number of entries to modify.
+ * \returns 0 on success or a negative error code if `texture` is not an
+ *          INDEX8 texture of the Xbox Direct3D 8 renderer; call
+ *          SDL_GetError() for more information.
+ */
+extern DECLSPEC int SDLCALL SDL_UpdateXboxTexturePalette(SDL_Texture *texture, const SDL_Color *colors, int firstcolor, int ncolors);
+
+/**
+ * Frame pacing information of the Xbox Direct3D 8 renderer.
+ *
+ * `vblank_count` counts vertical blanks since the display started, one per
+ * field in interlaced modes; `field` is the field being scanned out (0
+ * progressive, 1 odd, 2 even). `last_frame_vblanks` is the number of vertical
+ * blanks between the last two presents and `missed_vblanks` the sum, over all
+ * presents, of the vertical blanks beyond the present interval, i.e. how often
+ * the previous frame had to be shown again. `gpu_busy_us` is the time the
+ * GPU spent on the last frame it finished, `present_wait_us` the time the
+ * last present blocked the CPU waiting for a free buffer.
+ */
+typedef struct SDL_XboxFrameTiming
+{
+    Uint32 vblank_count;
+    int field;
+    Uint32 frames_presented;
+    Uint32 missed_vblanks;
+    Uint32 last_frame_vblanks;
+    Uint32 gpu_busy_us;
+    Uint32 present_wait_us;
+    int buffer_count;       /**< 2 or 3, see SDL_HINT_RENDER_XBOX_FRAME_BUFFERS */
+    SDL_bool immediate;     /**< see SDL_HINT_RENDER_XBOX_PRESENT_IMMEDIATE */
+} SDL_XboxFrameTiming;
+
+/**
+ * Get the frame pacing information of an Xbox renderer.
+ *
+ * \param renderer the renderer to query.
+ * \param timing a pointer filled in with the current frame pacing state.
+ * \returns 0 on success or a negative error code if `renderer` is not the
+ *          Xbox Direct3D 8 renderer; call SDL_GetError() for more
+ *          information.
+ *
+ * \sa SDL_RenderWaitXboxVBlank
+ */
+extern DECLSPEC int SDLCALL SDL_RenderGetXboxFrameTiming(SDL_Renderer *renderer, SDL_XboxFrameTiming *timing);
+
+/**
+ * Submit the queued draws of an Xbox renderer and wait for the next vertical
+ * blank.
+ *
+ * The GPU keeps working on the submitted draws while the CPU waits. This is
+ * useful to start a frame right after the vertical blank, e.g. with
+ * SDL_HINT_RENDER_XBOX_PRESENT_IMMEDIATE set.
+ *
+ * \param renderer the Xbox renderer.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \sa SDL_RenderGetXboxFrameTiming
+ */
+extern DECLSPEC int SDLCALL SDL_RenderWaitXboxVBlank(SDL_Renderer *renderer);
+
+/**
+ * Start an asynchronous copy of part of the current render target.
+ *
+ * Everything queued so far is drawn first, then the GPU copies `rect` into a
+ * readback surface without the CPU waiting for it. Collect the pixels a frame
+ * or two later with SDL_RenderGetXboxReadback(). Up to three readbacks can be
+ * in flight.
+ *
+ * \param renderer the Xbox renderer.
+ * \param rect the area to copy in render target pixels, or NULL for the
+ *             whole target; it is clipped to the target.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \sa SDL_RenderGetXboxReadback
+ */
+extern DECLSPEC int SDLCALL SDL_RenderRequestXboxReadback(SDL_Renderer *renderer, const SDL_Rect *rect);
+
+/**
+ * Get the pixels of the oldest readback, if the GPU has finished it.
+ *
+ * This never blocks. Readbacks complete in the order they were requested.
+ *
+ * \param renderer the Xbox renderer.
+ * \param rect filled in with the area that was copied, may be NULL.
+ * \param format the desired format of the pixel data.
+ * \param pixels a buffer large enough for the requested rect.
+ * \param pitch the pitch of the `pixels` buffer.
+ * \returns 1 if `pixels` was filled in, 0 if no readback is ready yet, or a
+ *          negative error code on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \sa SDL_RenderRequestXboxReadback
+ */
+extern DECLSPEC int SDLCALL SDL_RenderGetXboxReadback(SDL_Renderer *renderer, SDL_Rect *rect, Uint32 format, void *pixels, int pitch);
+
+/**
+ * A recorded sequence of render commands of the Xbox renderer.
+ *
+ * \sa SDL_RenderBeginXboxDisplayList
+ */
+typedef struct SDL_XboxDisplayList SDL_XboxDisplayList;
+
+/**
+ * Start recording render commands into a display list.
+ *
+ * Until SDL_RenderEndXboxDisplayList() is called, the draws issued on
+ * `renderer` are recorded instead of drawn. On the Xbox they are recorded into
+ * push buffers together with all the state they need, so a replay costs the
+ * CPU next to nothing.
+ *
+ * The list refers to the textures it draws with, as they are when it is
+ * replayed: updates made to them since recording are uploaded before the
+ * list runs. Those textures must outlive the list. Draws with streaming
+ * textures are kept as commands rather than push buffers, so they use the
+ * buffer that is current when the list runs. Once the device is reset, for
+ * example by a change of window size or vsync, running a list recorded
+ * before fails and the list has to be recorded again.
+ *
+ * \param renderer the Xbox renderer.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \sa SDL_RenderEndXboxDisplayList
+ * \sa SDL_RenderRunXboxDisplayList
+ */
+extern DECLSPEC int SDLCALL SDL_RenderBeginXboxDisplayList(SDL_Renderer *renderer);
+
+/**
+ * Finish recording a display list.
+ *
+ * \param renderer the Xbox renderer.
+ * \returns the recorded list, or NULL on failure; call SDL_GetError() for
+ *          more information.
+ *
+ * \sa SDL_RenderBeginXboxDisplayList
+ * \sa SDL_RenderDestroyXboxDisplayList
+ */
+extern DECLSPEC SDL_XboxDisplayList *SDLCALL SDL_RenderEndXboxDisplayList(SDL_Renderer *renderer);
+
+/**
+ * Draw a recorded display list on the current render target.
+ *
+ * The list is drawn after everything queued so far, with the viewport and
+ * clip rectangle that were set when it was recorded.
+ *
+ * \param renderer the renderer the list was recorded on.
+ * \param list the display list to draw.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ */
+extern DECLSPEC int SDLCALL SDL_RenderRunXboxDisplayList(SDL_Renderer *renderer, SDL_XboxDisplayList *list);
+
+/**
+ * Free a display list.
+ *
+ * \param list the display list to free, may be NULL.
+ */
+extern DECLSPEC void SDLCALL SDL_RenderDestroyXboxDisplayList(SDL_XboxDisplayList *list);
+
+#endif /* defined(__XBOX__) */
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
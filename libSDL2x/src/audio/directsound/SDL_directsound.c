@@ -23,6 +23,7 @@
 #ifdef SDL_AUDIO_DRIVER_DSOUND
 
 #include "SDL_timer.h"
+#include "SDL_hints.h"
 #ifndef __XBOX__
 #include "SDL_loadso.h"
 #endif
@@ -40,6 +41,11 @@
 #define WAVE_FORMAT_IEEE_FLOAT 0x0003
 #endif
 
+#ifdef __XBOX__
+/* number of periods in the ring of SDL_HINT_AUDIO_XBOX_LOW_LATENCY */
+#define DSOUND_LOW_LATENCY_CHUNKS 32
+#endif
+
 /* For Vista+, we can enumerate DSound devices with IMMDevice */
 #ifdef HAVE_MMDEVICEAPI_H
 static SDL_bool SupportsIMMDevice = SDL_FALSE;
@@ -229,6 +235,31 @@ static void DSOUND_DetectDevices(void)
 #endif /* HAVE_MMDEVICEAPI_H*/
 }
 
+/* Milliseconds until the play cursor reaches the end of its current chunk */
+static DWORD DSOUND_GetTimeLeftInChunk(_THIS, DWORD cursor)
+{
+    const DWORD left = this->spec.size - (cursor % this->spec.size);
+    const DWORD bytes_per_second = (SDL_AUDIO_BITSIZE(this->spec.format) / 8) * this->spec.channels * this->spec.freq;
+
+    return (DWORD)(((Uint64)left * 1000 + bytes_per_second - 1) / bytes_per_second);
+}
+
+/* Whether the next chunk can be written with the play cursor at cursor */
+static SDL_bool DSOUND_CanWriteChunk(_THIS, DWORD cursor)
+{
+#ifdef __XBOX__
+    if (this->hidden->ring) {
+        const DWORD numchunks = (DWORD)this->hidden->num_buffers;
+        const DWORD ahead = (this->hidden->writechunk + numchunks - cursor / this->spec.size) % numchunks;
+
+        /* more than half a ring ahead means the cursor overtook us, and
+           GetDeviceBuf skips forward */
+        return (ahead <= (DWORD)this->hidden->lead_chunks || ahead > numchunks / 2) ? SDL_TRUE : SDL_FALSE;
+    }
+#endif
+    return ((cursor / this->spec.size) != this->hidden->lastchunk) ? SDL_TRUE : SDL_FALSE;
+}
+
 static void DSOUND_WaitDevice(_THIS)
 {
     DWORD status = 0;
@@ -236,8 +267,9 @@ static void DSOUND_WaitDevice(_THIS)
     DWORD junk = 0;
     HRESULT result = DS_OK;
 
-    /* Semi-busy wait, since we have no way of getting play notification
-       on a primary mixing buffer located in hardware (DirectX 5.0)
+    /* On Xbox the buffer signals an event at every chunk boundary, so the
+       thread sleeps until a chunk is free. Elsewhere sleep for the time left
+       in the chunk being played.
      */
     result = IDirectSoundBuffer_GetCurrentPosition(this->hidden->mixbuf,
         &junk, &cursor);
@@ -253,10 +285,7 @@ static void DSOUND_WaitDevice(_THIS)
         return;
     }
 
-    while ((cursor / this->spec.size) == this->hidden->lastchunk) {
-        /* FIXME: find out how much time is left and sleep that long */
-        SDL_Delay(1);
-
+    while (!DSOUND_CanWriteChunk(this, cursor)) {
         /* Try to restore a lost sound buffer */
         IDirectSoundBuffer_GetStatus(this->hidden->mixbuf, &status);
 #ifndef __XBOX__
@@ -269,15 +298,31 @@ static void DSOUND_WaitDevice(_THIS)
         }
 #endif
         if (!(status & DSBSTATUS_PLAYING)) {
+            /* Start as soon as the first chunks are written: waiting for a
+               chunk boundary of a stopped buffer would only add latency. */
             result = IDirectSoundBuffer_Play(this->hidden->mixbuf, 0, 0,
                 DSBPLAY_LOOPING);
-            if (result == DS_OK) {
-                continue;
-            }
+            if (result != DS_OK) {
 #ifdef DEBUG_SOUND
-            SetDSerror("DirectSound Play", result);
+                SetDSerror("DirectSound Play", result);
 #endif
-            return;
+                return;
+            }
+        }
+        else {
+            const DWORD timeleft = DSOUND_GetTimeLeftInChunk(this, cursor);
+
+#ifdef __XBOX__
+            if (this->hidden->notify_event) {
+                /* a notification left over from an earlier chunk just
+                   loops */
+                WaitForSingleObject(this->hidden->notify_event, timeleft + 1);
+            }
+            else
+#endif
+            {
+                SDL_Delay(timeleft ? timeleft : 1);
+            }
         }
 
         /* Find out where we are playing */
@@ -292,6 +337,13 @@ static void DSOUND_WaitDevice(_THIS)
 
 static void DSOUND_PlayDevice(_THIS)
 {
+#ifdef __XBOX__
+    if (this->hidden->ring) {
+        /* the ring stays locked, just move on */
+        this->hidden->writechunk = (this->hidden->writechunk + 1) % this->hidden->num_buffers;
+        return;
+    }
+#endif
     /* Unlock the buffer, allowing it to play */
     if (this->hidden->locked_buf) {
         IDirectSoundBuffer_Unlock(this->hidden->mixbuf,
@@ -324,6 +376,18 @@ static Uint8* DSOUND_GetDeviceBuf(_THIS)
         return NULL;
     }
     cursor /= this->spec.size;
+#ifdef __XBOX__
+    if (this->hidden->ring) {
+        const DWORD numchunks = (DWORD)this->hidden->num_buffers;
+        const DWORD ahead = (this->hidden->writechunk + numchunks - cursor) % numchunks;
+
+        if (ahead == 0 || ahead > numchunks / 2) {
+            /* fell behind the play cursor, write just after it */
+            this->hidden->writechunk = (cursor + 1) % numchunks;
+        }
+        return this->hidden->ring + this->hidden->writechunk * this->spec.size;
+    }
+#endif
 #ifdef DEBUG_SOUND
     /* Detect audio dropouts */
     {
@@ -437,12 +501,22 @@ static void DSOUND_CloseDevice(_THIS)
     }
     if (this->hidden->mixbuf) {
         IDirectSoundBuffer_Stop(this->hidden->mixbuf);
+#ifdef __XBOX__
+        if (this->hidden->ring) {
+            IDirectSoundBuffer_Unlock(this->hidden->mixbuf, this->hidden->ring,
+                this->hidden->num_buffers * this->spec.size, NULL, 0);
+        }
+#endif
         IDirectSoundBuffer_Release(this->hidden->mixbuf);
     }
     if (this->hidden->sound) {
         IDirectSound_Release(this->hidden->sound);
     }
-#ifndef __XBOX__
+#ifdef __XBOX__
+    if (this->hidden->notify_event) {
+        CloseHandle(this->hidden->notify_event);
+    }
+#else
     if (this->hidden->capturebuf) {
         IDirectSoundCaptureBuffer_Stop(this->hidden->capturebuf);
         IDirectSoundCaptureBuffer_Release(this->hidden->capturebuf);
@@ -518,8 +592,8 @@ static int CreateSecondary(_THIS, const DWORD bufsize, WAVEFORMATEX* wfmt)
     /* Windows / desktop DSOUND */
     format.dwFlags = DSBCAPS_GETCURRENTPOSITION2 | DSBCAPS_GLOBALFOCUS;
 #else
-    /* Xbox: flags not needed / not present */
-    format.dwFlags = 0;
+    /* Xbox: only ask for the position notifications WaitDevice sleeps on */
+    format.dwFlags = DSBCAPS_CTRLPOSITIONNOTIFY;
 #endif
 
     format.dwBufferBytes = bufsize;
@@ -557,6 +631,29 @@ static int CreateSecondary(_THIS, const DWORD bufsize, WAVEFORMATEX* wfmt)
         /* Can be changed */
         IDirectSoundBuffer_SetVolume(*sndbuf, 0);
     }
+
+    /* one notification at the start of every chunk; without it WaitDevice
+       falls back to sleeping. OpenDevice may get here again for another
+       format, so the event is only created once. */
+    if (!this->hidden->notify_event) {
+        this->hidden->notify_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+    }
+    if (this->hidden->notify_event) {
+        const DWORD numchunks = bufsize / this->spec.size;
+        DSBPOSITIONNOTIFY* notify = SDL_stack_alloc(DSBPOSITIONNOTIFY, numchunks);
+        DWORD i;
+
+        for (i = 0; i < numchunks; ++i) {
+            notify[i].dwOffset = i * this->spec.size;
+            notify[i].hEventNotify = this->hidden->notify_event;
+        }
+        result = IDirectSoundBuffer_SetNotificationPositions(*sndbuf, numchunks, notify);
+        SDL_stack_free(notify);
+        if (result != DS_OK) {
+            CloseHandle(this->hidden->notify_event);
+            this->hidden->notify_event = NULL;
+        }
+    }
 #endif
 
     /* silence initial buffer */
@@ -607,7 +704,7 @@ static int CreateCaptureBuffer(_THIS, const DWORD bufsize, WAVEFORMATEX* wfmt)
 
 static int DSOUND_OpenDevice(_THIS, const char* devname)
 {
-    const DWORD numchunks = 8;
+    DWORD numchunks = 8;
     HRESULT result;
     SDL_bool tried_format = SDL_FALSE;
     SDL_bool iscapture = this->iscapture;
@@ -621,6 +718,17 @@ static int DSOUND_OpenDevice(_THIS, const char* devname)
     }
     SDL_zerop(this->hidden);
 
+#ifdef __XBOX__
+    if (!iscapture) {
+        const char* hint = SDL_GetHint(SDL_HINT_AUDIO_XBOX_LOW_LATENCY);
+        this->hidden->lead_chunks = hint ? SDL_atoi(hint) : 0;
+        if (this->hidden->lead_chunks > 0) {
+            numchunks = DSOUND_LOW_LATENCY_CHUNKS;
+            this->hidden->lead_chunks = SDL_min(this->hidden->lead_chunks, DSOUND_LOW_LATENCY_CHUNKS / 2);
+        }
+    }
+#endif
+
     /* Open the audio device */
     if (iscapture) {
 #ifdef _XBOX
@@ -735,6 +843,24 @@ static int DSOUND_OpenDevice(_THIS, const char* devname)
     }
 
 good:
+#ifdef __XBOX__
+    if (this->hidden->lead_chunks > 0) {
+        LPVOID ring = NULL;
+        LPVOID ptr2 = NULL;
+        DWORD ringlen = 0;
+        DWORD bytes2 = 0;
+
+        /* lock once and write periods straight into the buffer; WaitDevice
+           starts playback once the first lead_chunks are written */
+        result = IDirectSoundBuffer_Lock(this->hidden->mixbuf, 0, bufsize,
+            &ring, &ringlen, &ptr2, &bytes2, DSBLOCK_ENTIREBUFFER);
+        if (result != DS_OK) {
+            return SetDSerror("DirectSound Lock", result);
+        }
+        this->hidden->ring = (Uint8*)ring;
+        this->hidden->writechunk = 1;
+    }
+#endif
     /* Playback buffers auto-start in WaitDevice */
     return 0;
 }
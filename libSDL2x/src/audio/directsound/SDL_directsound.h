@@ -46,6 +46,12 @@ struct SDL_PrivateAudioData
     int num_buffers;
     DWORD lastchunk;
     Uint8 *locked_buf;
+#ifdef __XBOX__
+    HANDLE notify_event; /* signalled as the play cursor enters each chunk */
+    Uint8 *ring;         /* low latency mode: whole buffer, locked while open */
+    DWORD writechunk;    /* low latency mode: next chunk to write */
+    int lead_chunks;     /* low latency mode: chunks kept ahead of the cursor */
+#endif
 };
 
 #endif /* SDL_directsound_h_ */
@@ -24,6 +24,7 @@
 
 #include "SDL_hints.h"
 #include "SDL_render.h"
+#include "SDL_system.h"
 #include "SDL_timer.h"
 #include "SDL_sysrender.h"
 #include "software/SDL_render_sw_c.h"
@@ -1463,6 +1464,7 @@ SDL_Texture *SDL_CreateTextureFromSurface(SDL_Renderer *renderer, SDL_Surface *s
         format = renderer->info.texture_formats[0];
         for (i = 0; i < (int)renderer->info.num_texture_formats; ++i) {
             if (!SDL_ISPIXELFORMAT_FOURCC(renderer->info.texture_formats[i]) &&
+                !SDL_ISPIXELFORMAT_INDEXED(renderer->info.texture_formats[i]) &&
                 SDL_ISPIXELFORMAT_ALPHA(renderer->info.texture_formats[i]) == needAlpha) {
                 format = renderer->info.texture_formats[i];
                 break;
@@ -1510,6 +1512,14 @@ SDL_Texture *SDL_CreateTextureFromSurface(SDL_Renderer *renderer, SDL_Surface *s
         }
 #endif
 
+#if defined(__XBOX__) && SDL_VIDEO_RENDER_D3D
+        /* The Xbox renderer looks INDEX8 texels up in a palette on the GPU.
+         * Copy SDL_Surface palette to the texture */
+        if (SDL_ISPIXELFORMAT_INDEXED(format) && surface->format->palette) {
+            SDL_UpdateXboxTexturePalette(texture, surface->format->palette->colors, 0, surface->format->palette->ncolors);
+        }
+#endif
+
     } else {
         SDL_PixelFormat *dst_fmt;
         SDL_Surface *temp = NULL;
@@ -29,11 +29,14 @@
 
 #include "SDL_hints.h"
 #include "SDL_syswm.h"
+#include "SDL_system.h"
 #include "SDL_log.h"
 #include "SDL_assert.h"
 #include "../SDL_sysrender.h"
 #include "../SDL_d3dmath.h"
 #include "../../video/xbox/SDL_xboxvideo.h"
+#include "SDL_xbox_swizzle.h"
+#include "SDL_xbox_atlas.h"
 
 #define D3D_DEBUG_INFO
 
@@ -51,11 +54,112 @@ typedef struct
     SDL_bool cliprect_enabled_dirty;
     SDL_Rect cliprect;
     SDL_bool cliprect_dirty;
-    SDL_bool is_copy_ex;
     DWORD last_color;
     SDL_bool color_dirty;
 } D3D_DrawStateCache;
 
+#define D3D_MAX_READBACKS 3
+
+#define D3D_MAX_TEXTURE_STAGES 4
+
+/* Small static textures share swizzled atlas pages when
+   SDL_HINT_RENDER_XBOX_ATLAS is set. */
+#define D3D_ATLAS_PAGE_SIZE 512
+#define D3D_ATLAS_MAX_ENTRY 64
+
+typedef struct D3D_AtlasPage D3D_AtlasPage;
+
+/* Queued vertices go straight into a persistently mapped vertex buffer used
+   as a ring. Each chunk remembers the fence of the last flush that used it;
+   the writer waits on that fence before it wraps around into the chunk. */
+#define D3D_VERTEX_RING_SIZE (2 * 1024 * 1024)
+#define D3D_INDEX_RING_SIZE (256 * 1024)
+#define D3D_RING_CHUNKS 8
+
+typedef struct
+{
+    Uint8* base;            /* NULL if the buffer could not be created */
+    size_t size;
+    size_t cursor;          /* next free byte */
+    int chunk;              /* chunk the cursor is in */
+    Uint32 queued;          /* chunks holding data of the batch being queued */
+    Uint32 pending;         /* chunks whose fence may not have passed yet */
+    DWORD fence[D3D_RING_CHUNKS];
+} D3D_Ring;
+
+/* Set in SDL_RenderCommand.data.draw.first when the vertices of a command are
+   in SDL's vertex array instead of the vertex ring. */
+#define D3D_VERTICES_IN_QUEUE ((size_t)1 << (sizeof(size_t) * 8 - 1))
+/* Set as well when a quad command was queued as QuadVertex. */
+#define D3D_VERTICES_COMPACT (D3D_VERTICES_IN_QUEUE >> 1)
+#define D3D_VERTEX_FLAGS (D3D_VERTICES_IN_QUEUE | D3D_VERTICES_COMPACT)
+
+/* One flush of the command queue recorded while a display list is open. If
+   push buffer recording fails, or the flush draws with a streaming texture
+   whose current buffer changes after recording, the commands and vertices
+   are kept instead and replayed through the normal queue. */
+typedef struct
+{
+    IDirect3DPushBuffer8* pushbuffer;
+    Uint32 commands;            /* counted into the stats on replay */
+    Uint32 draws;
+    SDL_RenderCommand* cmds;
+    void* vertices;
+    size_t vertsize;
+    struct D3D_TextureRep** reps;   /* textures the segment draws with, each once */
+    int numreps;
+} D3D_DisplayListSegment;
+
+struct SDL_XboxDisplayList
+{
+    SDL_Renderer* renderer;
+    D3D_DisplayListSegment* segments;
+    int numsegments;
+    Uint32 resets;              /* D3D_RenderData.resets when it was recorded */
+};
+
+/* What the renderer last wrote to the device, so repeated writes of the same
+   value never reach the push buffer. A state is only trusted once its bit in
+   the matching 'valid' mask is set; D3D_InitRenderState clears them all. */
+typedef struct
+{
+    DWORD renderstate[D3DRS_MAX];
+    Uint32 renderstate_valid[(D3DRS_MAX + 31) / 32];
+    DWORD stagestate[D3D_MAX_TEXTURE_STAGES][D3DTSS_MAX];
+    Uint32 stagestate_valid[D3D_MAX_TEXTURE_STAGES][(D3DTSS_MAX + 31) / 32];
+    IDirect3DBaseTexture8* texture[D3D_MAX_TEXTURE_STAGES];
+    Uint32 texture_valid;
+} D3D_StateShadow;
+
+/* An idle render target texture, kept for the next target of the same size
+   and format. */
+typedef struct
+{
+    IDirect3DTexture8* texture;
+    int w, h;
+    D3DFORMAT d3dfmt;
+    Uint32 bytes;
+} D3D_PooledTarget;
+
+/* GPU timestamps of one frame, low 32 bits of the performance counter.
+   Written by push buffer callbacks at DPC time; 0 until the GPU got there. */
+#define D3D_FRAME_TIMES 4
+
+typedef struct
+{
+    volatile DWORD start;   /* GPU read the first command of the frame */
+    volatile DWORD end;     /* GPU finished the last write of the frame */
+} D3D_FrameTimes;
+
+/* A render target copy in flight; ready once 'fence' has passed. */
+typedef struct
+{
+    IDirect3DSurface8* surface;
+    SDL_Rect rect;
+    D3DFORMAT format;
+    DWORD fence;
+} D3D_Readback;
+
 typedef struct
 {
     IDirect3D8* d3d;
@@ -65,39 +169,104 @@ typedef struct
     SDL_bool updateSize;
     SDL_bool beginScene;
     SDL_bool enableSeparateAlphaBlend;
-    D3DTEXTUREFILTERTYPE scaleMode[8];
     IDirect3DSurface8* defaultRenderTarget;
     IDirect3DSurface8* currentRenderTarget;
-    LPDIRECT3DVERTEXBUFFER8 vertexBuffers[8];
-    size_t vertexBufferSize[8];
-    int currentVertexBuffer;
-    SDL_bool reportedVboProblem;
+    LPDIRECT3DVERTEXBUFFER8 vertexRingBuffer;
+    LPDIRECT3DINDEXBUFFER8 indexRingBuffer;
+    D3D_Ring vertexRing;
+    D3D_Ring indexRing;
+    UINT vertexRingStride;     /* stride stream 0 has the vertex ring bound with, 0 if not bound */
+    DWORD vertexShader;        /* D3D_FVF_VERTEX or compactShader */
+    DWORD compactShader;       /* QuadVertex declaration, 0 if it could not be created */
+    SDL_Texture* quadTexture;  /* texture of the last quad command queued */
+    SDL_BlendMode quadBlend;   /* its blend mode, SDL_BLENDMODE_INVALID if none */
+    DWORD quadColor;           /* its colour */
+    SDL_bool quadCompact;      /* whether it used QuadVertex */
+    float lineWidth;           /* of points and lines, SDL_RenderSetXboxLineWidth() */
     D3D_DrawStateCache drawstate;
+    D3D_StateShadow shadow;
     SDL_bool backbuffer_cleared;
+    SDL_XboxRenderStats stats;     /* frame being built */
+    SDL_XboxRenderStats laststats; /* last presented frame */
+    IDirect3DSurface8* readbackSurface; /* reused by RenderReadPixels */
+    D3D_Readback readbacks[D3D_MAX_READBACKS]; /* ring of async readbacks */
+    int firstReadback;
+    int numReadbacks;
+    D3D_AtlasPage* atlases;
+    SDL_XboxDisplayList* recording; /* open display list, if any */
+    Uint32 resets;              /* D3D_Reset() calls; display lists recorded before the last one are stale */
+    D3D_FrameTimes frametimes[D3D_FRAME_TIMES]; /* by frame number */
+    Uint32 gpuFrame;            /* frame being built */
+    Uint32 gpuFrameDone;        /* frames whose GPU times have been read */
+    SDL_bool gpuFrameStarted;   /* start callback of gpuFrame is queued */
+    DWORD lastGPUEnd;
+    Uint32 gpuBusy;             /* performance counter ticks */
+    Uint32 presentWait;         /* performance counter ticks */
+    DWORD lastVBlank;           /* VBlankCount after the previous present */
+    Uint32 framesPresented;
+    Uint32 missedVBlanks;
+    Uint32 lastFrameVBlanks;
+    Uint32 ticksPerUs;          /* performance counter frequency / 1000000 */
+    SDL_bool statsOverlay;      /* SDL_RenderSetXboxStatsOverlay() */
+    D3D_PooledTarget* targetPool;   /* least recently released first */
+    int numPooledTargets;
+    int maxPooledTargets;           /* allocated entries */
+    size_t pooledTargetBytes;
+    size_t targetPoolLimit;         /* SDL_HINT_RENDER_XBOX_TARGET_POOL, in bytes */
+    size_t textureBudget;           /* SDL_HINT_RENDER_XBOX_TEXTURE_BUDGET, in bytes; 0 = none */
+    Uint32 evictions;
 } D3D_RenderData;
 
-typedef struct
+#define D3D_MAX_STREAMING_BUFFERS 3
+#define D3D_MAX_PALETTES 2
+
+typedef struct D3D_TextureRep
 {
     SDL_bool dirty;
+    SDL_Rect dirtyrect;     /* union of staging writes not yet uploaded; valid while dirty */
     int w, h;
     DWORD usage;
     Uint32 format;
-    D3DFORMAT d3dfmt;
+    D3DFORMAT d3dfmt;       /* linear format; also the staging format */
+    SDL_bool swizzled;      /* GPU copy uses the swizzled twin of d3dfmt */
     IDirect3DTexture8* texture;
     IDirect3DTexture8* staging;
+    /* Streaming reps have no staging texture; they are written in place and
+       'texture' points at streaming[curstreaming]. */
+    IDirect3DTexture8* streaming[D3D_MAX_STREAMING_BUFFERS];
+    DWORD fences[D3D_MAX_STREAMING_BUFFERS];   /* passed once the GPU is done with a buffer; 0 = none */
+    int numstreaming;
+    int curstreaming;
+    Uint32 lastused;        /* frame it was last drawn with, for eviction */
+    int pins;               /* display lists drawing with it; never evicted while any */
 } D3D_TextureRep;
 
-typedef struct
+struct D3D_AtlasPage
 {
     D3D_TextureRep texture;
+    XBOX_AtlasPacker packer;
+    int refcount;
+    D3D_AtlasPage* next;
+};
+
+typedef struct
+{
+    D3D_TextureRep texture;     /* unused while the texture lives in an atlas page */
     D3DTEXTUREFILTERTYPE scaleMode;
 
-    SDL_bool yuv;
-    D3D_TextureRep utexture;
-    D3D_TextureRep vtexture;
-    Uint8* pixels;
+    D3D_AtlasPage* atlas;
+    SDL_Rect atlasrect;         /* where the texture sits in the atlas page */
+
+    SDL_bool yuv;           /* planar source packed into a YUY2 texture */
+    Uint8* pixels;          /* planar shadow copy while locked */
     int pitch;
     SDL_Rect locked_rect;
+
+    /* INDEX8 only. Updates go to the palette the GPU is not using, so they
+       never wait for draws already submitted. */
+    IDirect3DPalette8* palettes[D3D_MAX_PALETTES];
+    int curpalette;
+    D3DCOLOR colors[256];   /* CPU copy of palettes[curpalette] */
 } D3D_TextureData;
 
 typedef struct
@@ -107,6 +276,37 @@ typedef struct
     float u, v;
 } Vertex;
 
+#define D3D_FVF_VERTEX (D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1)
+
+/* Compact layout for quads, whose corners always share the command's colour:
+   the colour is set once per draw as the texture factor and the vertex unit
+   fills in z. 16 bytes instead of 24. */
+typedef struct
+{
+    float x, y;
+    float u, v;
+} QuadVertex;
+
+static const DWORD D3D_QuadVertexDecl[] = {
+    D3DVSD_STREAM(0),
+    D3DVSD_REG(D3DVSDE_POSITION, D3DVSDT_FLOAT2),
+    D3DVSD_REG(D3DVSDE_TEXCOORD0, D3DVSDT_FLOAT2),
+    D3DVSD_END()
+};
+
+/* Occupies one Vertex slot in front of the vertices of a GEOMETRY command.
+   When indexed, the 16-bit indices are in the index ring at 'startindex', or
+   for vertices in SDL's vertex array, follow the vertices padded to whole
+   Vertex slots. */
+typedef struct
+{
+    Uint32 num_vertices;
+    Uint32 num_indices; /* 0 = plain triangle list of num_vertices */
+    Uint32 startindex;
+} D3D_GeometryHeader;
+
+SDL_COMPILE_TIME_ASSERT(geometry_header_fits, sizeof(D3D_GeometryHeader) <= sizeof(Vertex));
+
 /* ---------------------- Helpers & error handling ---------------------- */
 
 static int D3D_SetError(const char* prefix, HRESULT result)
@@ -170,14 +370,51 @@ static D3DFORMAT PixelFormatToD3DFMT(Uint32 format)
     case SDL_PIXELFORMAT_RGB565:   return D3DFMT_LIN_R5G6B5;
     case SDL_PIXELFORMAT_RGB888:   return D3DFMT_LIN_X8R8G8B8;
     case SDL_PIXELFORMAT_ARGB8888: return D3DFMT_LIN_A8R8G8B8;
+    /* The texture unit converts YUY2/UYVY to RGB when sampling; planar
+       formats are packed into YUY2 on upload. */
     case SDL_PIXELFORMAT_YV12:
     case SDL_PIXELFORMAT_IYUV:
     case SDL_PIXELFORMAT_NV12:
-    case SDL_PIXELFORMAT_NV21:     return D3DFMT_LIN_L8;
+    case SDL_PIXELFORMAT_NV21:
+    case SDL_PIXELFORMAT_YUY2:     return D3DFMT_YUY2;
+    case SDL_PIXELFORMAT_UYVY:     return D3DFMT_UYVY;
+    case SDL_PIXELFORMAT_DXT1:     return D3DFMT_DXT1;
+    case SDL_PIXELFORMAT_DXT3:     return D3DFMT_DXT3;
+    case SDL_PIXELFORMAT_DXT5:     return D3DFMT_DXT5;
+    /* Indices are staged as L8 and sampled as P8, see D3D_GetSwizzledFormat. */
+    case SDL_PIXELFORMAT_INDEX8:   return D3DFMT_LIN_L8;
     default:                       return D3DFMT_UNKNOWN;
     }
 }
 
+/* Bytes per 4x4 block of a compressed format, 0 for everything else. */
+static int D3DFMTBlockBytes(D3DFORMAT format)
+{
+    switch (format) {
+    case D3DFMT_DXT1: return 8;
+    case D3DFMT_DXT3:
+    case D3DFMT_DXT5: return 16;
+    default:          return 0;
+    }
+}
+
+static D3DFORMAT D3DFMTToSwizzled(D3DFORMAT format)
+{
+    switch (format) {
+    case D3DFMT_LIN_R5G6B5:   return D3DFMT_R5G6B5;
+    case D3DFMT_LIN_X8R8G8B8: return D3DFMT_X8R8G8B8;
+    case D3DFMT_LIN_A8R8G8B8: return D3DFMT_A8R8G8B8;
+    default:                  return D3DFMT_UNKNOWN;
+    }
+}
+
+/* P8 has no linear twin on the NV2A, so INDEX8 textures stage their indices
+   as L8 and are always swizzled into a P8 GPU copy. */
+static D3DFORMAT D3D_GetSwizzledFormat(Uint32 format, D3DFORMAT d3dfmt)
+{
+    return (format == SDL_PIXELFORMAT_INDEX8) ? D3DFMT_P8 : D3DFMTToSwizzled(d3dfmt);
+}
+
 static Uint32 D3DFMTToPixelFormat(D3DFORMAT format)
 {
     switch (format) {
@@ -188,39 +425,121 @@ static Uint32 D3DFMTToPixelFormat(D3DFORMAT format)
     }
 }
 
+/* -------------------------- Device state shadow -------------------------- */
+
+static void D3D_InvalidateStateShadow(D3D_RenderData* data)
+{
+    SDL_zero(data->shadow.renderstate_valid);
+    SDL_zero(data->shadow.stagestate_valid);
+    data->shadow.texture_valid = 0;
+}
+
+static void D3D_SetRenderState(D3D_RenderData* data, D3DRENDERSTATETYPE state, DWORD value)
+{
+    D3D_StateShadow* shadow = &data->shadow;
+    const Uint32 bit = 1u << (state & 31);
+
+    if ((unsigned)state < D3DRS_MAX) {
+        if ((shadow->renderstate_valid[state >> 5] & bit) && shadow->renderstate[state] == value) {
+            ++data->stats.states_filtered;
+            return;
+        }
+        shadow->renderstate[state] = value;
+        shadow->renderstate_valid[state >> 5] |= bit;
+    }
+    ++data->stats.states_issued;
+    IDirect3DDevice8_SetRenderState(data->device, state, value);
+}
+
+static void D3D_SetTextureStageState(D3D_RenderData* data, DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD value)
+{
+    D3D_StateShadow* shadow = &data->shadow;
+    const Uint32 bit = 1u << (type & 31);
+
+    if (stage < D3D_MAX_TEXTURE_STAGES && (unsigned)type < D3DTSS_MAX) {
+        if ((shadow->stagestate_valid[stage][type >> 5] & bit) && shadow->stagestate[stage][type] == value) {
+            ++data->stats.states_filtered;
+            return;
+        }
+        shadow->stagestate[stage][type] = value;
+        shadow->stagestate_valid[stage][type >> 5] |= bit;
+    }
+    ++data->stats.states_issued;
+    IDirect3DDevice8_SetTextureStageState(data->device, stage, type, value);
+}
+
+static HRESULT D3D_SetTexture(D3D_RenderData* data, DWORD stage, IDirect3DBaseTexture8* texture)
+{
+    D3D_StateShadow* shadow = &data->shadow;
+    HRESULT hr;
+
+    if (stage < D3D_MAX_TEXTURE_STAGES) {
+        if ((shadow->texture_valid & (1u << stage)) && shadow->texture[stage] == texture) {
+            ++data->stats.states_filtered;
+            return D3D_OK;
+        }
+    }
+    ++data->stats.states_issued;
+    hr = IDirect3DDevice8_SetTexture(data->device, stage, texture);
+    if (stage < D3D_MAX_TEXTURE_STAGES) {
+        if (SUCCEEDED(hr)) {
+            shadow->texture[stage] = texture;
+            shadow->texture_valid |= (1u << stage);
+        } else {
+            shadow->texture_valid &= ~(1u << stage);
+        }
+    }
+    return hr;
+}
+
+/* Forgets what the draw state cache knows and unbinds the texture, so the
+   next draw sets up everything it needs. */
+static void D3D_InvalidateDrawState(D3D_RenderData* data)
+{
+    D3D_InvalidateStateShadow(data);
+    D3D_SetTexture(data, 0, NULL);
+    data->drawstate.texture = NULL;
+    data->drawstate.blend = SDL_BLENDMODE_INVALID;
+    data->drawstate.viewport_dirty = SDL_TRUE;
+    data->drawstate.cliprect_enabled_dirty = SDL_TRUE;
+    data->drawstate.cliprect_dirty = SDL_TRUE;
+}
+
 static void D3D_InitRenderState(D3D_RenderData* data)
 {
     D3DMATRIX matrix;
     IDirect3DDevice8* device = data->device;
 
-    IDirect3DDevice8_SetVertexShader(device, D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1);
+    D3D_InvalidateStateShadow(data);
+
+    IDirect3DDevice8_SetVertexShader(device, D3D_FVF_VERTEX);
+    data->vertexShader = D3D_FVF_VERTEX;
 
-    IDirect3DDevice8_SetRenderState(device, D3DRS_ZENABLE, D3DZB_FALSE);
-    IDirect3DDevice8_SetRenderState(device, D3DRS_ZWRITEENABLE, FALSE);
-    IDirect3DDevice8_SetRenderState(device, D3DRS_CULLMODE, D3DCULL_NONE);
-    IDirect3DDevice8_SetRenderState(device, D3DRS_LIGHTING, FALSE);
+    D3D_SetRenderState(data, D3DRS_ZENABLE, D3DZB_FALSE);
+    D3D_SetRenderState(data, D3DRS_ZWRITEENABLE, FALSE);
+    D3D_SetRenderState(data, D3DRS_CULLMODE, D3DCULL_NONE);
+    D3D_SetRenderState(data, D3DRS_LIGHTING, FALSE);
 
-    IDirect3DDevice8_SetRenderState(device, D3DRS_ALPHABLENDENABLE, TRUE);
-    IDirect3DDevice8_SetRenderState(device, D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
-    IDirect3DDevice8_SetRenderState(device, D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
-    IDirect3DDevice8_SetRenderState(device, D3DRS_ALPHATESTENABLE, FALSE);
+    D3D_SetRenderState(data, D3DRS_ALPHABLENDENABLE, TRUE);
+    D3D_SetRenderState(data, D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
+    D3D_SetRenderState(data, D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
+    D3D_SetRenderState(data, D3DRS_ALPHATESTENABLE, FALSE);
 
-    IDirect3DDevice8_SetTextureStageState(device, 0, D3DTSS_COLOROP, D3DTOP_MODULATE);
-    IDirect3DDevice8_SetTextureStageState(device, 0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
-    IDirect3DDevice8_SetTextureStageState(device, 0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
-    IDirect3DDevice8_SetTextureStageState(device, 0, D3DTSS_ALPHAOP, D3DTOP_MODULATE);
-    IDirect3DDevice8_SetTextureStageState(device, 0, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
-    IDirect3DDevice8_SetTextureStageState(device, 0, D3DTSS_ALPHAARG2, D3DTA_DIFFUSE);
+    D3D_SetTextureStageState(data, 0, D3DTSS_COLOROP, D3DTOP_MODULATE);
+    D3D_SetTextureStageState(data, 0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+    D3D_SetTextureStageState(data, 0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
+    D3D_SetTextureStageState(data, 0, D3DTSS_ALPHAOP, D3DTOP_MODULATE);
+    D3D_SetTextureStageState(data, 0, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
+    D3D_SetTextureStageState(data, 0, D3DTSS_ALPHAARG2, D3DTA_DIFFUSE);
 
-    IDirect3DDevice8_SetTextureStageState(device, 1, D3DTSS_COLOROP, D3DTOP_DISABLE);
-    IDirect3DDevice8_SetTextureStageState(device, 1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+    D3D_SetTextureStageState(data, 1, D3DTSS_COLOROP, D3DTOP_DISABLE);
+    D3D_SetTextureStageState(data, 1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
 
     SDL_zero(matrix);
     matrix.m[0][0] = 1.0f; matrix.m[1][1] = 1.0f; matrix.m[2][2] = 1.0f; matrix.m[3][3] = 1.0f;
     IDirect3DDevice8_SetTransform(device, D3DTS_WORLD, &matrix);
     IDirect3DDevice8_SetTransform(device, D3DTS_VIEW, &matrix);
 
-    SDL_memset(data->scaleMode, 0xFF, sizeof(data->scaleMode));
     data->beginScene = SDL_TRUE;
 
     /* Apply interlace/progressive stability based on current mode */
@@ -232,6 +551,99 @@ static int D3D_Reset(SDL_Renderer* renderer);
 
 /* -------------------------- Renderer activation -------------------------- */
 
+/* --------------------------- Frame pacing ------------------------------- */
+
+static void __cdecl D3D_GPUTimestamp(DWORD context)
+{
+    LARGE_INTEGER now;
+
+    QueryPerformanceCounter(&now);
+    *(volatile DWORD*)context = now.LowPart ? now.LowPart : 1;
+}
+
+static void D3D_MarkFrameStart(D3D_RenderData* data)
+{
+    D3D_FrameTimes* times = &data->frametimes[data->gpuFrame % D3D_FRAME_TIMES];
+
+    if (data->gpuFrameStarted) return;
+
+    times->start = 0;
+    times->end = 0;
+    IDirect3DDevice8_InsertCallback(data->device, D3DCALLBACK_READ, D3D_GPUTimestamp, (DWORD)&times->start);
+    data->gpuFrameStarted = SDL_TRUE;
+}
+
+static void D3D_MarkFrameEnd(D3D_RenderData* data)
+{
+    D3D_FrameTimes* times = &data->frametimes[data->gpuFrame % D3D_FRAME_TIMES];
+
+    if (!data->gpuFrameStarted) return;
+
+    IDirect3DDevice8_InsertCallback(data->device, D3DCALLBACK_WRITE, D3D_GPUTimestamp, (DWORD)&times->end);
+    data->gpuFrame++;
+    data->gpuFrameStarted = SDL_FALSE;
+}
+
+/* Picks up the frames the GPU has finished since the last call. A frame that
+   starts before the previous one is done only counts from that point, so the
+   busy time excludes time spent queued behind it. */
+static void D3D_UpdateGPUBusy(D3D_RenderData* data)
+{
+    while (data->gpuFrameDone != data->gpuFrame) {
+        const D3D_FrameTimes* times = &data->frametimes[data->gpuFrameDone % D3D_FRAME_TIMES];
+        const DWORD start = times->start;
+        const DWORD end = times->end;
+        DWORD from = start;
+
+        if (!end) break;
+
+        if (data->gpuFrameDone && (LONG)(data->lastGPUEnd - start) > 0) {
+            from = data->lastGPUEnd;
+        }
+        data->gpuBusy = (Uint32)(end - from);
+        data->lastGPUEnd = end;
+        data->gpuFrameDone++;
+    }
+}
+
+static Uint32 D3D_TicksToMicroseconds(D3D_RenderData* data, Uint32 ticks)
+{
+    if (!data->ticksPerUs) {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        data->ticksPerUs = (Uint32)(frequency.QuadPart / 1000000);
+        if (!data->ticksPerUs) data->ticksPerUs = 1;
+    }
+    return ticks / data->ticksPerUs;
+}
+
+static void D3D_UpdatePresentTiming(D3D_RenderData* data)
+{
+    const Uint32 target = (data->pparams.FullScreen_PresentationInterval == D3DPRESENT_INTERVAL_TWO) ? 2 : 1;
+    D3DFIELD_STATUS status;
+
+    IDirect3DDevice8_GetDisplayFieldStatus(data->device, &status);
+    if (data->framesPresented) {
+        data->lastFrameVBlanks = (Uint32)(status.VBlankCount - data->lastVBlank);
+        if (data->lastFrameVBlanks > target) {
+            data->missedVBlanks += data->lastFrameVBlanks - target;
+        }
+    }
+    data->lastVBlank = status.VBlankCount;
+    data->framesPresented++;
+}
+
+/* Buffer count and present interval requested through hints. */
+static void D3D_ApplyPresentHints(D3DPRESENT_PARAMETERS* p)
+{
+    const char* hint = SDL_GetHint(SDL_HINT_RENDER_XBOX_FRAME_BUFFERS);
+
+    p->BackBufferCount = (hint && SDL_atoi(hint) >= 3) ? 2 : 1;
+    if (SDL_GetHintBoolean(SDL_HINT_RENDER_XBOX_PRESENT_IMMEDIATE, SDL_FALSE)) {
+        p->FullScreen_PresentationInterval = D3DPRESENT_INTERVAL_IMMEDIATE;
+    }
+}
+
 static int D3D_ActivateRenderer(SDL_Renderer* renderer)
 {
     D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
@@ -258,6 +670,7 @@ static int D3D_ActivateRenderer(SDL_Renderer* renderer)
         }
         if (FAILED(result)) return D3D_SetError("BeginScene()", result);
         data->beginScene = SDL_FALSE;
+        D3D_MarkFrameStart(data);
 
         /* ALWAYS clear the full backbuffer at frame start. */
         {
@@ -357,9 +770,65 @@ static SDL_bool D3D_SupportsBlendMode(SDL_Renderer* renderer, SDL_BlendMode blen
 
 /* ------------------------------ Textures --------------------------------- */
 
+static void
+D3D_AddDirtyRect(D3D_TextureRep* texture, int x, int y, int w, int h)
+{
+    const SDL_Rect rect = { x, y, w, h };
+
+    if (texture->dirty) {
+        SDL_UnionRect(&texture->dirtyrect, &rect, &texture->dirtyrect);
+    }
+    else {
+        texture->dirtyrect = rect;
+        texture->dirty = SDL_TRUE;
+    }
+}
+
+/* Swizzled and compressed textures take 0..1 texture coordinates. */
+static SDL_bool D3D_IsNormalizedTextureRep(const D3D_TextureRep* texture)
+{
+    return (texture->swizzled || D3DFMTBlockBytes(texture->d3dfmt) != 0) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Bytes covered by 'rect' in the staging copy of a rep. */
+static Uint32 D3D_GetTextureBytes(D3DFORMAT d3dfmt, Uint32 format, int w, int h)
+{
+    const int blockbytes = D3DFMTBlockBytes(d3dfmt);
+
+    if (blockbytes) {
+        return (Uint32)(((w + 3) / 4) * ((h + 3) / 4) * blockbytes);
+    }
+    return (Uint32)(w * h * SDL_BYTESPERPIXEL(format));
+}
+
+static Uint32 D3D_GetTextureRepRectBytes(const D3D_TextureRep* texture, const SDL_Rect* rect)
+{
+    return D3D_GetTextureBytes(texture->d3dfmt, texture->format, rect->w, rect->h);
+}
+
+/* Bytes a rep holds in D3DPOOL_DEFAULT and D3DPOOL_SYSTEMMEM. */
+static void D3D_GetTextureRepMemory(const D3D_TextureRep* texture, Uint32* gpubytes, Uint32* stagingbytes)
+{
+    const Uint32 bytes = D3D_GetTextureBytes(texture->d3dfmt, texture->format, texture->w, texture->h);
+
+    if (texture->numstreaming > 0) {
+        *gpubytes = bytes * (Uint32)texture->numstreaming;
+    }
+    else {
+        *gpubytes = texture->texture ? bytes : 0;
+    }
+    *stagingbytes = texture->staging ? bytes : 0;
+}
+
+/* Format of the GPU copy of a rep. */
+static D3DFORMAT D3D_GetTextureRepFormat(const D3D_TextureRep* texture)
+{
+    return texture->swizzled ? D3D_GetSwizzledFormat(texture->format, texture->d3dfmt) : texture->d3dfmt;
+}
+
 static int
 D3D_CreateTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture,
-    DWORD usage, Uint32 format, D3DFORMAT d3dfmt, int w, int h)
+    DWORD usage, Uint32 format, D3DFORMAT d3dfmt, int w, int h, SDL_bool swizzle)
 {
     HRESULT result;
 
@@ -372,8 +841,10 @@ D3D_CreateTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture,
     texture->usage = usage;
     texture->format = format;
     texture->d3dfmt = d3dfmt;
+    texture->swizzled = (swizzle && usage == 0 && XBOX_CanSwizzle(w, h) &&
+        D3D_GetSwizzledFormat(format, d3dfmt) != D3DFMT_UNKNOWN) ? SDL_TRUE : SDL_FALSE;
 
-    result = IDirect3DDevice8_CreateTexture(device, w, h, 1, usage, d3dfmt,
+    result = IDirect3DDevice8_CreateTexture(device, w, h, 1, usage, D3D_GetTextureRepFormat(texture),
         D3DPOOL_DEFAULT, &texture->texture);
     if (FAILED(result)) {
         char msg[128];
@@ -384,6 +855,131 @@ D3D_CreateTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture,
     return 0;
 }
 
+static int
+D3D_CreateStreamingTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture,
+    Uint32 format, D3DFORMAT d3dfmt, int w, int h, int numbuffers)
+{
+    HRESULT result;
+    int i;
+
+    if (w <= 0) w = 1;
+    if (h <= 0) h = 1;
+    if (numbuffers < 1) numbuffers = 1;
+    if (numbuffers > D3D_MAX_STREAMING_BUFFERS) numbuffers = D3D_MAX_STREAMING_BUFFERS;
+
+    texture->dirty = SDL_FALSE;
+    texture->w = w;
+    texture->h = h;
+    texture->usage = 0;
+    texture->format = format;
+    texture->d3dfmt = d3dfmt;
+
+    /* Unified memory: DEFAULT pool textures are CPU-lockable, so there is
+       nothing to stage. */
+    for (i = 0; i < numbuffers; ++i) {
+        result = IDirect3DDevice8_CreateTexture(device, w, h, 1, 0, d3dfmt,
+            D3DPOOL_DEFAULT, &texture->streaming[i]);
+        if (FAILED(result)) {
+            char msg[128];
+            _snprintf(msg, sizeof(msg), "CreateTexture %dx%d fmt=0x%08x (STREAMING)", w, h, (unsigned int)d3dfmt);
+            msg[sizeof(msg) - 1] = '\0';
+            while (i--) {
+                IDirect3DTexture8_Release(texture->streaming[i]);
+                texture->streaming[i] = NULL;
+            }
+            return D3D_SetError(msg, result);
+        }
+    }
+
+    texture->numstreaming = numbuffers;
+    texture->curstreaming = 0;
+    SDL_zero(texture->fences);
+    texture->texture = texture->streaming[0];
+    return 0;
+}
+
+/* Carries the texels outside x,y w x h over from 'previous' to the current
+   buffer of a streaming rep, so a partial lock sees the last frame around
+   the part it rewrites. */
+static int
+D3D_CopyStreamingTextureRep(D3D_TextureRep* texture, IDirect3DTexture8* previous,
+    int x, int y, int w, int h)
+{
+    const int bpp = SDL_BYTESPERPIXEL(texture->format);
+    const size_t rowbytes = (size_t)texture->w * bpp;
+    D3DLOCKED_RECT src, dst;
+    int row;
+    HRESULT result;
+
+    result = IDirect3DTexture8_LockRect(previous, 0, &src, NULL, D3DLOCK_READONLY);
+    if (FAILED(result)) {
+        return D3D_SetError("LockRect()", result);
+    }
+    result = IDirect3DTexture8_LockRect(texture->texture, 0, &dst, NULL, 0);
+    if (FAILED(result)) {
+        IDirect3DTexture8_UnlockRect(previous, 0);
+        return D3D_SetError("LockRect()", result);
+    }
+
+    for (row = 0; row < texture->h; ++row) {
+        const Uint8* s = (const Uint8*)src.pBits + row * src.Pitch;
+        Uint8* d = (Uint8*)dst.pBits + row * dst.Pitch;
+
+        if (row < y || row >= y + h) {
+            SDL_memcpy(d, s, rowbytes);
+        }
+        else {
+            SDL_memcpy(d, s, (size_t)x * bpp);
+            SDL_memcpy(d + (x + w) * bpp, s + (x + w) * bpp, (size_t)(texture->w - x - w) * bpp);
+        }
+    }
+
+    IDirect3DTexture8_UnlockRect(texture->texture, 0);
+    IDirect3DTexture8_UnlockRect(previous, 0);
+    return 0;
+}
+
+/* Locks a streaming rep in place. Every lock moves to the next buffer first,
+   so the GPU can keep reading the previous frame; a partial lock copies the
+   rest of the previous buffer forward. The draws using a texture are
+   submitted before it is locked, so a fence inserted when a buffer is left
+   behind passes once the GPU has read it; the buffer is not handed out again
+   before that. */
+static int
+D3D_LockStreamingTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture,
+    int x, int y, int w, int h, D3DLOCKED_RECT* locked)
+{
+    RECT d3drect;
+    HRESULT result;
+
+    if (texture->numstreaming > 1) {
+        IDirect3DTexture8* previous = texture->texture;
+
+        texture->fences[texture->curstreaming] = IDirect3DDevice8_InsertFence(device);
+        texture->curstreaming = (texture->curstreaming + 1) % texture->numstreaming;
+        texture->texture = texture->streaming[texture->curstreaming];
+        if (texture->fences[texture->curstreaming]) {
+            IDirect3DDevice8_BlockOnFence(device, texture->fences[texture->curstreaming]);
+            texture->fences[texture->curstreaming] = 0;
+        }
+        if ((x != 0 || y != 0 || w != texture->w || h != texture->h) &&
+            D3D_CopyStreamingTextureRep(texture, previous, x, y, w, h) < 0) {
+            return -1;
+        }
+    }
+
+    d3drect.left = x;
+    d3drect.top = y;
+    d3drect.right = x + w;
+    d3drect.bottom = y + h;
+
+    result = IDirect3DTexture8_LockRect(texture->texture, 0, locked, &d3drect, 0);
+    if (FAILED(result)) {
+        return D3D_SetError("LockRect()", result);
+    }
+    return 0;
+}
+
 static int
 D3D_CreateStagingTexture(IDirect3DDevice8* device, D3D_TextureRep* texture)
 {
@@ -422,6 +1018,11 @@ D3D_RecreateTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture)
 {
     (void)device;
 
+    /* Streaming buffers have no backing copy; they survive Reset() as is. */
+    if (texture->numstreaming > 0) {
+        return 0;
+    }
+
     if (texture->texture) {
         IDirect3DTexture8_Release(texture->texture);
         texture->texture = NULL;
@@ -437,53 +1038,143 @@ D3D_RecreateTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture)
         }
     }
 
-    texture->dirty = SDL_TRUE;
+    D3D_AddDirtyRect(texture, 0, 0, texture->w, texture->h);
     return 0;
 }
 
+/* Locks the CPU side of a rep for writing: the buffer itself for streaming
+   reps, the staging texture otherwise. */
 static int
-D3D_UpdateTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture,
-    int x, int y, int w, int h, const void* pixels, int pitch)
+D3D_LockTextureRepForWrite(IDirect3DDevice8* device, D3D_TextureRep* texture,
+    int x, int y, int w, int h, D3DLOCKED_RECT* locked)
 {
     RECT d3drect;
-    D3DLOCKED_RECT locked;
-    const Uint8* src;
-    Uint8* dst;
-    int row, need;
     HRESULT result;
-    int texw = texture->w;
-    int texh = texture->h;
-    int bpp = SDL_BYTESPERPIXEL(texture->format);
 
-    if (!pixels || w <= 0 || h <= 0 || bpp <= 0) {
-        return 0;
+    if (texture->numstreaming > 0) {
+        return D3D_LockStreamingTextureRep(device, texture, x, y, w, h, locked);
     }
 
     if (D3D_CreateStagingTexture(device, texture) < 0) {
         return -1;
     }
 
-    if (x < 0) { w += x; x = 0; }
-    if (y < 0) { h += y; y = 0; }
-    if (x + w > texw) w = texw - x;
-    if (y + h > texh) h = texh - y;
-    if (w <= 0 || h <= 0) {
-        return 0;
-    }
-
     d3drect.left = x;
     d3drect.top = y;
     d3drect.right = x + w;
     d3drect.bottom = y + h;
 
-    result = IDirect3DTexture8_LockRect(texture->staging, 0, &locked, &d3drect, 0);
+    result = IDirect3DTexture8_LockRect(texture->staging, 0, locked, &d3drect, 0);
     if (FAILED(result)) {
         return D3D_SetError("LockRect()", result);
     }
+    return 0;
+}
 
-    need = w * bpp;
-    if (pitch < need || (int)locked.Pitch < need) {
-        IDirect3DTexture8_UnlockRect(texture->staging, 0);
+static int
+D3D_UnlockTextureRepForWrite(D3D_TextureRep* texture, int x, int y, int w, int h)
+{
+    HRESULT result;
+
+    if (texture->numstreaming > 0) {
+        result = IDirect3DTexture8_UnlockRect(texture->texture, 0);
+    }
+    else {
+        result = IDirect3DTexture8_UnlockRect(texture->staging, 0);
+        D3D_AddDirtyRect(texture, x, y, w, h);
+    }
+    if (FAILED(result)) {
+        return D3D_SetError("UnlockRect()", result);
+    }
+    return 0;
+}
+
+/* DXT data is written as whole 4x4 blocks; 'pitch' is the size of a block row. */
+static int
+D3D_UpdateCompressedTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture,
+    int x, int y, int w, int h, const void* pixels, int pitch)
+{
+    const int blockbytes = D3DFMTBlockBytes(texture->d3dfmt);
+    D3DLOCKED_RECT locked;
+    const Uint8* src;
+    Uint8* dst;
+    int row, rows, need;
+    HRESULT result;
+
+    if ((x & 3) || (y & 3) ||
+        ((w & 3) && x + w != texture->w) || ((h & 3) && y + h != texture->h)) {
+        return SDL_SetError("UpdateTexture: compressed updates must cover whole 4x4 blocks");
+    }
+
+    need = ((w + 3) / 4) * blockbytes;
+    rows = (h + 3) / 4;
+
+    if (D3D_CreateStagingTexture(device, texture) < 0) {
+        return -1;
+    }
+
+    result = IDirect3DTexture8_LockRect(texture->staging, 0, &locked, NULL, 0);
+    if (FAILED(result)) {
+        return D3D_SetError("LockRect()", result);
+    }
+
+    if (pitch < need || (int)locked.Pitch < need) {
+        IDirect3DTexture8_UnlockRect(texture->staging, 0);
+        return SDL_SetError("UpdateTextureRep: insufficient pitch (need %d, src %d, dst %d)", need, pitch, (int)locked.Pitch);
+    }
+
+    src = (const Uint8*)pixels;
+    dst = (Uint8*)locked.pBits + (y / 4) * locked.Pitch + (x / 4) * blockbytes;
+    for (row = 0; row < rows; ++row) {
+        SDL_memcpy(dst, src, (size_t)need);
+        src += pitch;
+        dst += locked.Pitch;
+    }
+
+    result = IDirect3DTexture8_UnlockRect(texture->staging, 0);
+    if (FAILED(result)) {
+        return D3D_SetError("UnlockRect()", result);
+    }
+
+    D3D_AddDirtyRect(texture, x, y, w, h);
+    return 0;
+}
+
+static int
+D3D_UpdateTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture,
+    int x, int y, int w, int h, const void* pixels, int pitch)
+{
+    D3DLOCKED_RECT locked;
+    const Uint8* src;
+    Uint8* dst;
+    int row, need;
+    int texw = texture->w;
+    int texh = texture->h;
+    int bpp = SDL_BYTESPERPIXEL(texture->format);
+
+    if (!pixels || w <= 0 || h <= 0 || bpp <= 0) {
+        return 0;
+    }
+
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > texw) w = texw - x;
+    if (y + h > texh) h = texh - y;
+    if (w <= 0 || h <= 0) {
+        return 0;
+    }
+
+    if (D3DFMTBlockBytes(texture->d3dfmt)) {
+        return D3D_UpdateCompressedTextureRep(device, texture, x, y, w, h, pixels, pitch);
+    }
+
+    if (D3D_LockTextureRepForWrite(device, texture, x, y, w, h, &locked) < 0) {
+        return -1;
+    }
+
+    need = w * bpp;
+    if (pitch < need || (int)locked.Pitch < need) {
+        D3D_UnlockTextureRepForWrite(texture, x, y, w, h);
         return SDL_SetError("UpdateTextureRep: insufficient pitch (need %d, src %d, dst %d)", need, pitch, (int)locked.Pitch);
     }
 
@@ -501,20 +1192,60 @@ D3D_UpdateTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture,
         }
     }
 
-    result = IDirect3DTexture8_UnlockRect(texture->staging, 0);
-    if (FAILED(result)) {
-        return D3D_SetError("UnlockRect()", result);
+    return D3D_UnlockTextureRepForWrite(texture, x, y, w, h);
+}
+
+/* Packs 4:2:0 planes into a YUY2 rep, each chroma row serving two luma rows.
+   This is only a byte shuffle; the texture unit does the YUV->RGB conversion
+   when it samples. 'uvstep' is 1 for planar chroma and 2 for NV12/NV21. */
+static int
+D3D_UpdateTextureRepFromPlanes(IDirect3DDevice8* device, D3D_TextureRep* texture, const SDL_Rect* rect,
+    const Uint8* Yplane, int Ypitch,
+    const Uint8* Uplane, int Upitch,
+    const Uint8* Vplane, int Vpitch, int uvstep)
+{
+    D3DLOCKED_RECT locked;
+    const int w = (rect->w + 1) & ~1;
+    int row, col;
+
+    if (rect->x & 1) {
+        return SDL_SetError("UpdateTexture: YUV updates must start on an even column");
     }
 
-    texture->dirty = SDL_TRUE;
-    return 0;
-}
+    if (D3D_LockTextureRepForWrite(device, texture, rect->x, rect->y, w, rect->h, &locked) < 0) {
+        return -1;
+    }
 
+    for (row = 0; row < rect->h; ++row) {
+        const int crow = ((rect->y + row) >> 1) - (rect->y >> 1);
+        const Uint8* y = Yplane + row * Ypitch;
+        const Uint8* u = Uplane + crow * Upitch;
+        const Uint8* v = Vplane + crow * Vpitch;
+        Uint32* dst = (Uint32*)((Uint8*)locked.pBits + row * locked.Pitch);
+
+        for (col = 0; col < rect->w; col += 2, u += uvstep, v += uvstep) {
+            const Uint32 y1 = (col + 1 < rect->w) ? y[col + 1] : y[col];
+            *dst++ = (Uint32)y[col] | ((Uint32)*u << 8) | (y1 << 16) | ((Uint32)*v << 24);
+        }
+    }
+
+    return D3D_UnlockTextureRepForWrite(texture, rect->x, rect->y, w, rect->h);
+}
 
 static void D3D_DestroyTextureRep(D3D_TextureRep* texture)
 {
     if (!texture) return;
 
+    if (texture->numstreaming > 0) {
+        int i;
+        for (i = 0; i < texture->numstreaming; ++i) {
+            IDirect3DTexture8_Release(texture->streaming[i]);
+            texture->streaming[i] = NULL;
+        }
+        texture->numstreaming = 0;
+        texture->texture = NULL;
+    }
+
     if (texture->texture) {
         IDirect3DTexture8_Release(texture->texture);
         texture->texture = NULL;
@@ -526,13 +1257,379 @@ static void D3D_DestroyTextureRep(D3D_TextureRep* texture)
     texture->dirty = SDL_FALSE;
 }
 
+/* ------------------------------ Atlas pages ------------------------------ */
+
+/* The rep that holds the texels of a texture, and where the texture starts
+   in it: its own rep at 0,0, or its entry in an atlas page. */
+static D3D_TextureRep* D3D_GetTextureDataRep(D3D_TextureData* texturedata, int* x, int* y)
+{
+    if (texturedata->atlas) {
+        if (x) *x = texturedata->atlasrect.x;
+        if (y) *y = texturedata->atlasrect.y;
+        return &texturedata->atlas->texture;
+    }
+    if (x) *x = 0;
+    if (y) *y = 0;
+    return &texturedata->texture;
+}
+
+static SDL_bool D3D_CanAtlasTexture(const SDL_Texture* texture, D3DFORMAT d3dfmt)
+{
+    if (!SDL_GetHintBoolean(SDL_HINT_RENDER_XBOX_ATLAS, SDL_FALSE)) {
+        return SDL_FALSE;
+    }
+    return (texture->access == SDL_TEXTUREACCESS_STATIC &&
+        !SDL_ISPIXELFORMAT_FOURCC(texture->format) &&
+        texture->w <= D3D_ATLAS_MAX_ENTRY && texture->h <= D3D_ATLAS_MAX_ENTRY &&
+        D3DFMTToSwizzled(d3dfmt) != D3DFMT_UNKNOWN) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Places a texture in the first page of its format with room, starting a
+   new page when none has. Each entry is packed with a one-texel border on
+   every side, which uploads fill with copies of its edge texels, so bilinear
+   filtering at an edge never reads a neighbour. */
+static int
+D3D_AllocAtlasEntry(D3D_RenderData* data, D3D_TextureData* texturedata,
+    Uint32 format, D3DFORMAT d3dfmt, int w, int h)
+{
+    D3D_AtlasPage* page;
+
+    for (page = data->atlases; page; page = page->next) {
+        if (page->texture.format == format &&
+            XBOX_AtlasPack(&page->packer, w + 2, h + 2, &texturedata->atlasrect)) {
+            break;
+        }
+    }
+
+    if (!page) {
+        page = (D3D_AtlasPage*)SDL_calloc(1, sizeof(*page));
+        if (!page) return SDL_OutOfMemory();
+
+        if (D3D_CreateTextureRep(data->device, &page->texture, 0, format, d3dfmt,
+            D3D_ATLAS_PAGE_SIZE, D3D_ATLAS_PAGE_SIZE, SDL_TRUE) < 0) {
+            SDL_free(page);
+            return -1;
+        }
+        XBOX_InitAtlasPacker(&page->packer, D3D_ATLAS_PAGE_SIZE, D3D_ATLAS_PAGE_SIZE, 0);
+        XBOX_AtlasPack(&page->packer, w + 2, h + 2, &texturedata->atlasrect);
+
+        page->next = data->atlases;
+        data->atlases = page;
+    }
+
+    texturedata->atlasrect.x += 1;
+    texturedata->atlasrect.y += 1;
+    texturedata->atlasrect.w = w;
+    texturedata->atlasrect.h = h;
+    page->refcount++;
+    texturedata->atlas = page;
+    return 0;
+}
+
+/* Refreshes the border of an atlas entry after 'rect' (in texture
+   coordinates) was written to it. */
+static int D3D_ExtrudeAtlasEntry(IDirect3DDevice8* device, D3D_TextureData* texturedata, const SDL_Rect* rect)
+{
+    D3D_TextureRep* page = &texturedata->atlas->texture;
+    const SDL_Rect* entry = &texturedata->atlasrect;
+    const int bpp = SDL_BYTESPERPIXEL(page->format);
+    const int x0 = (rect->x == 0) ? -1 : rect->x;
+    const int y0 = (rect->y == 0) ? -1 : rect->y;
+    const int x1 = (rect->x + rect->w == entry->w) ? entry->w + 1 : rect->x + rect->w;
+    const int y1 = (rect->y + rect->h == entry->h) ? entry->h + 1 : rect->y + rect->h;
+    D3DLOCKED_RECT locked;
+
+    if (x1 - x0 == rect->w && y1 - y0 == rect->h) {
+        return 0; /* no edge was touched */
+    }
+    if (D3D_LockTextureRepForWrite(device, page, entry->x + x0, entry->y + y0, x1 - x0, y1 - y0, &locked) < 0) {
+        return -1;
+    }
+    XBOX_ExtrudeAtlasEntry((Uint8*)locked.pBits - y0 * (int)locked.Pitch - x0 * bpp, (int)locked.Pitch,
+        bpp, entry->w, entry->h, rect);
+    return D3D_UnlockTextureRepForWrite(page, entry->x + x0, entry->y + y0, x1 - x0, y1 - y0);
+}
+
+/* Space is only reclaimed once a page is empty; the page is freed then. */
+static void D3D_FreeAtlasEntry(D3D_RenderData* data, D3D_TextureData* texturedata)
+{
+    D3D_AtlasPage* page = texturedata->atlas;
+    D3D_AtlasPage** prev;
+
+    texturedata->atlas = NULL;
+    if (--page->refcount > 0) {
+        return;
+    }
+
+    for (prev = &data->atlases; *prev; prev = &(*prev)->next) {
+        if (*prev == page) {
+            *prev = page->next;
+            break;
+        }
+    }
+    D3D_DestroyTextureRep(&page->texture);
+    SDL_free(page);
+}
+
+/* ------------------------- Render target pool --------------------------- */
+
+/* Frees the least recently released targets until the pool is within 'limit'
+   bytes. */
+static void D3D_TrimTargetPool(D3D_RenderData* data, size_t limit)
+{
+    int i = 0;
+
+    while (i < data->numPooledTargets && data->pooledTargetBytes > limit) {
+        IDirect3DTexture8_Release(data->targetPool[i].texture);
+        data->pooledTargetBytes -= data->targetPool[i].bytes;
+        ++i;
+    }
+    if (i > 0) {
+        data->numPooledTargets -= i;
+        SDL_memmove(data->targetPool, data->targetPool + i, data->numPooledTargets * sizeof(*data->targetPool));
+    }
+}
+
+/* Render targets come from the pool when one of the same size and format is
+   idle, so effect chains that create and destroy intermediate targets, and
+   D3D_Reset(), don't reallocate them. */
+static int
+D3D_CreateTargetTextureRep(D3D_RenderData* data, D3D_TextureRep* texture,
+    Uint32 format, D3DFORMAT d3dfmt, int w, int h)
+{
+    int i;
+
+    for (i = data->numPooledTargets - 1; i >= 0; --i) {
+        D3D_PooledTarget* pooled = &data->targetPool[i];
+        if (pooled->w == w && pooled->h == h && pooled->d3dfmt == d3dfmt) {
+            texture->dirty = SDL_FALSE;
+            texture->w = w;
+            texture->h = h;
+            texture->usage = D3DUSAGE_RENDERTARGET;
+            texture->format = format;
+            texture->d3dfmt = d3dfmt;
+            texture->swizzled = SDL_FALSE;
+            texture->texture = pooled->texture;
+
+            data->pooledTargetBytes -= pooled->bytes;
+            data->numPooledTargets--;
+            SDL_memmove(pooled, pooled + 1, (data->numPooledTargets - i) * sizeof(*pooled));
+            return 0;
+        }
+    }
+
+    return D3D_CreateTextureRep(data->device, texture, D3DUSAGE_RENDERTARGET, format, d3dfmt, w, h, SDL_FALSE);
+}
+
+static void D3D_ReleaseTargetTextureRep(D3D_RenderData* data, D3D_TextureRep* texture)
+{
+    const SDL_Rect rect = { 0, 0, texture->w, texture->h };
+    const Uint32 bytes = D3D_GetTextureRepRectBytes(texture, &rect);
+
+    if (texture->texture && bytes <= data->targetPoolLimit) {
+        if (data->numPooledTargets == data->maxPooledTargets) {
+            const int newmax = data->maxPooledTargets ? data->maxPooledTargets * 2 : 8;
+            D3D_PooledTarget* pool = (D3D_PooledTarget*)SDL_realloc(data->targetPool, newmax * sizeof(*pool));
+            if (pool) {
+                data->targetPool = pool;
+                data->maxPooledTargets = newmax;
+            }
+        }
+        if (data->numPooledTargets < data->maxPooledTargets) {
+            D3D_PooledTarget* pooled = &data->targetPool[data->numPooledTargets++];
+            pooled->texture = texture->texture;
+            pooled->w = texture->w;
+            pooled->h = texture->h;
+            pooled->d3dfmt = texture->d3dfmt;
+            pooled->bytes = bytes;
+            data->pooledTargetBytes += bytes;
+            texture->texture = NULL;
+            D3D_TrimTargetPool(data, data->targetPoolLimit);
+        }
+    }
+    D3D_DestroyTextureRep(texture);
+}
+
+/* ---------------------------- Texture memory ----------------------------- */
+
+static void D3D_GetTextureMemory(SDL_Renderer* renderer, SDL_XboxTextureMemory* memory)
+{
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
+    const SDL_Texture* texture;
+    const D3D_AtlasPage* page;
+    Uint32 gpubytes, stagingbytes;
+
+    SDL_zerop(memory);
+    for (texture = renderer->textures; texture; texture = texture->next) {
+        const D3D_TextureData* texturedata = (const D3D_TextureData*)texture->driverdata;
+        if (!texturedata || texturedata->atlas) continue;
+        D3D_GetTextureRepMemory(&texturedata->texture, &gpubytes, &stagingbytes);
+        memory->default_bytes += gpubytes;
+        memory->systemmem_bytes += stagingbytes;
+        if (!gpubytes && stagingbytes) {
+            memory->evicted_textures++;
+        }
+    }
+    for (page = data->atlases; page; page = page->next) {
+        D3D_GetTextureRepMemory(&page->texture, &gpubytes, &stagingbytes);
+        memory->default_bytes += gpubytes;
+        memory->systemmem_bytes += stagingbytes;
+    }
+    memory->pooled_target_bytes = (Uint32)data->pooledTargetBytes;
+    memory->default_bytes += memory->pooled_target_bytes;
+    memory->budget_bytes = (Uint32)data->textureBudget;
+    memory->evictions = data->evictions;
+}
+
+/* Static textures keep their staging copy, so their GPU copy can be dropped
+   and rebuilt from it the next time they are drawn. Only textures that no
+   frame still on the GPU uses are candidates. */
+static SDL_bool D3D_CanEvictTextureRep(const D3D_RenderData* data, const D3D_TextureRep* texture)
+{
+    return (texture->texture && texture->staging && texture->numstreaming == 0 &&
+        texture->usage == 0 && texture->pins == 0 &&
+        (Sint32)(data->gpuFrameDone - texture->lastused) > 0) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Evicts the least recently drawn textures until D3DPOOL_DEFAULT usage is
+   within 'limit' bytes. Returns how many were evicted. */
+static int D3D_EvictTextures(SDL_Renderer* renderer, size_t limit)
+{
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
+    SDL_XboxTextureMemory memory;
+    size_t used;
+    int evicted = 0;
+
+    D3D_GetTextureMemory(renderer, &memory);
+    used = memory.default_bytes;
+
+    while (used > limit) {
+        SDL_Texture* victim = NULL;
+        D3D_TextureData* victimdata = NULL;
+        SDL_Texture* texture;
+        Uint32 gpubytes, stagingbytes;
+
+        for (texture = renderer->textures; texture; texture = texture->next) {
+            D3D_TextureData* texturedata = (D3D_TextureData*)texture->driverdata;
+            if (!texturedata || texturedata->atlas || !D3D_CanEvictTextureRep(data, &texturedata->texture)) continue;
+            if (!victim || (Sint32)(texturedata->texture.lastused - victimdata->texture.lastused) < 0) {
+                victim = texture;
+                victimdata = texturedata;
+            }
+        }
+        if (!victim) break;
+
+        if (data->drawstate.texture == victim) {
+            D3D_SetTexture(data, 0, NULL);
+            data->drawstate.texture = NULL;
+        }
+        D3D_GetTextureRepMemory(&victimdata->texture, &gpubytes, &stagingbytes);
+        IDirect3DTexture8_Release(victimdata->texture.texture);
+        victimdata->texture.texture = NULL;
+        D3D_AddDirtyRect(&victimdata->texture, 0, 0, victimdata->texture.w, victimdata->texture.h);
+
+        used -= gpubytes;
+        data->evictions++;
+        evicted++;
+    }
+    return evicted;
+}
+
 /* --------------------------- SDL texture hooks --------------------------- */
 
+/* The GPU side of a texture that is not in an atlas page. */
+static int
+D3D_CreateTextureStorage(D3D_RenderData* data, SDL_Texture* texture, D3D_TextureData* texturedata,
+    DWORD usage, Uint32 format, D3DFORMAT d3dfmt, int w, int h)
+{
+    SDL_bool swizzle;
+
+    if (texture->access == SDL_TEXTUREACCESS_STREAMING && !D3DFMTBlockBytes(d3dfmt) &&
+        texture->format != SDL_PIXELFORMAT_INDEX8) {
+        const char* hint = SDL_GetHint(SDL_HINT_RENDER_XBOX_STREAMING_BUFFERS);
+        const int numbuffers = hint ? SDL_atoi(hint) : 2;
+        return D3D_CreateStreamingTextureRep(data->device, &texturedata->texture, format, d3dfmt, w, h, numbuffers);
+    }
+
+    if (texture->access == SDL_TEXTUREACCESS_TARGET) {
+        return D3D_CreateTargetTextureRep(data, &texturedata->texture, format, d3dfmt, w, h);
+    }
+
+    /* Static textures are swizzled: the NV2A samples them much faster than
+       linear ones. Streaming and target textures stay linear, except INDEX8
+       ones, which only exist swizzled. */
+    swizzle = ((texture->access == SDL_TEXTUREACCESS_STATIC && !SDL_ISPIXELFORMAT_FOURCC(texture->format)) ||
+        texture->format == SDL_PIXELFORMAT_INDEX8) ? SDL_TRUE : SDL_FALSE;
+
+    return D3D_CreateTextureRep(data->device, &texturedata->texture, usage, format, d3dfmt, w, h, swizzle);
+}
+
+static int D3D_RoundUpToPowerOfTwo(int value)
+{
+    int result = 1;
+
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/* Copies the CPU copy of an INDEX8 texture's palette into 'palette'. */
+static int D3D_FillTexturePalette(D3D_TextureData* texturedata, IDirect3DPalette8* palette)
+{
+    D3DCOLOR* colors;
+    HRESULT result;
+
+    result = IDirect3DPalette8_Lock(palette, &colors, 0);
+    if (FAILED(result)) {
+        return D3D_SetError("Palette Lock()", result);
+    }
+    SDL_memcpy(colors, texturedata->colors, sizeof(texturedata->colors));
+    IDirect3DPalette8_Unlock(palette);
+    return 0;
+}
+
+/* Palettes of a new INDEX8 texture start out as an opaque grey ramp. */
+static int D3D_CreateTexturePalettes(D3D_RenderData* data, D3D_TextureData* texturedata)
+{
+    HRESULT result;
+    int i;
+
+    for (i = 0; i < 256; ++i) {
+        texturedata->colors[i] = D3DCOLOR_ARGB(0xFF, i, i, i);
+    }
+
+    for (i = 0; i < D3D_MAX_PALETTES; ++i) {
+        result = IDirect3DDevice8_CreatePalette(data->device, D3DPALETTE_256, &texturedata->palettes[i]);
+        if (FAILED(result)) {
+            return D3D_SetError("CreatePalette()", result);
+        }
+        if (D3D_FillTexturePalette(texturedata, texturedata->palettes[i]) < 0) {
+            return -1;
+        }
+    }
+    texturedata->curpalette = 0;
+    return 0;
+}
+
+static void D3D_DestroyTexturePalettes(D3D_TextureData* texturedata)
+{
+    int i;
+
+    for (i = 0; i < D3D_MAX_PALETTES; ++i) {
+        if (texturedata->palettes[i]) {
+            IDirect3DPalette8_Release(texturedata->palettes[i]);
+            texturedata->palettes[i] = NULL;
+        }
+    }
+}
+
 static int D3D_CreateTexture(SDL_Renderer* renderer, SDL_Texture* texture)
 {
     D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
     D3D_TextureData* texturedata;
     DWORD usage;
+    Uint32 format = texture->format;
     D3DFORMAT d3dfmt;
     int w = texture->w;
     int h = texture->h;
@@ -555,32 +1652,59 @@ static int D3D_CreateTexture(SDL_Renderer* renderer, SDL_Texture* texture)
 
     usage = (texture->access == SDL_TEXTUREACCESS_TARGET) ? D3DUSAGE_RENDERTARGET : 0;
 
-    if (D3D_CreateTextureRep(data->device, &texturedata->texture, usage, texture->format, d3dfmt, w, h) < 0) {
+    if (D3DFMTBlockBytes(d3dfmt) && (texture->access != SDL_TEXTUREACCESS_STATIC || !XBOX_CanSwizzle(w, h))) {
         SDL_free(texturedata);
         texture->driverdata = NULL;
-        return -1;
+        return SDL_SetError("Compressed textures must be static with power-of-two dimensions");
     }
 
-    if (texture->format == SDL_PIXELFORMAT_YV12 || texture->format == SDL_PIXELFORMAT_IYUV) {
-        int hw = (w + 1) / 2;
-        int hh = (h + 1) / 2;
-        texturedata->yuv = SDL_TRUE;
-
-        if (D3D_CreateTextureRep(data->device, &texturedata->utexture, usage, texture->format, d3dfmt, hw, hh) < 0) {
-            D3D_DestroyTextureRep(&texturedata->texture);
+    /* P8 textures must be swizzled, so an INDEX8 texture is padded to
+       power-of-two dimensions; draws only address its top left corner. */
+    if (texture->format == SDL_PIXELFORMAT_INDEX8) {
+        if (texture->access == SDL_TEXTUREACCESS_TARGET) {
             SDL_free(texturedata);
             texture->driverdata = NULL;
-            return -1;
+            return SDL_SetError("Palettized textures can't be render targets");
         }
-        if (D3D_CreateTextureRep(data->device, &texturedata->vtexture, usage, texture->format, d3dfmt, hw, hh) < 0) {
-            D3D_DestroyTextureRep(&texturedata->utexture);
-            D3D_DestroyTextureRep(&texturedata->texture);
+        if (D3D_CreateTexturePalettes(data, texturedata) < 0) {
+            D3D_DestroyTexturePalettes(texturedata);
             SDL_free(texturedata);
             texture->driverdata = NULL;
             return -1;
         }
+        w = D3D_RoundUpToPowerOfTwo(w);
+        h = D3D_RoundUpToPowerOfTwo(h);
+    }
+
+    if (D3D_CanAtlasTexture(texture, d3dfmt) &&
+        D3D_AllocAtlasEntry(data, texturedata, format, d3dfmt, w, h) == 0) {
+        return 0;
+    }
+
+    /* The GPU copy of a YUV texture is YUY2/UYVY, two texels per 32 bits. */
+    if (d3dfmt == D3DFMT_YUY2 || d3dfmt == D3DFMT_UYVY) {
+        texturedata->yuv = (texture->format != SDL_PIXELFORMAT_YUY2 && texture->format != SDL_PIXELFORMAT_UYVY) ? SDL_TRUE : SDL_FALSE;
+        format = texturedata->yuv ? SDL_PIXELFORMAT_YUY2 : texture->format;
+        w = (w + 1) & ~1;
+    }
+
+    if (data->textureBudget) {
+        const size_t bytes = D3D_GetTextureBytes(d3dfmt, format, w, h);
+        D3D_EvictTextures(renderer, (data->textureBudget > bytes) ? data->textureBudget - bytes : 0);
     }
 
+    /* When memory runs out, make room by evicting whatever can be and try
+       once more. */
+    if (D3D_CreateTextureStorage(data, texture, texturedata, usage, format, d3dfmt, w, h) < 0 &&
+        (D3D_EvictTextures(renderer, 0) == 0 ||
+         D3D_CreateTextureStorage(data, texture, texturedata, usage, format, d3dfmt, w, h) < 0)) {
+        D3D_DestroyTexturePalettes(texturedata);
+        SDL_free(texturedata);
+        texture->driverdata = NULL;
+        return -1;
+    }
+    texturedata->texture.lastused = data->gpuFrame;
+
     return 0;
 }
 
@@ -588,38 +1712,33 @@ static int D3D_RecreateTexture(SDL_Renderer* renderer, SDL_Texture* texture)
 {
     D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
     D3D_TextureData* texturedata = (D3D_TextureData*)texture->driverdata;
+    SDL_bool evicted;
 
     if (!texturedata) return 0;
+    if (texturedata->texture.numstreaming > 0) return 0;
+    if (texturedata->atlas) return 0; /* pages are recreated by D3D_Reset */
+
+    /* An evicted texture stays evicted, within the budget; it comes back from
+       its staging copy when it is next drawn. */
+    evicted = (!texturedata->texture.texture && texturedata->texture.staging) ? SDL_TRUE : SDL_FALSE;
 
     if (D3D_RecreateTextureRep(data->device, &texturedata->texture) < 0) return -1;
+    if (evicted && texturedata->texture.staging) return 0;
     if (D3D_CreateTextureRep(data->device, &texturedata->texture,
         texturedata->texture.usage, texturedata->texture.format,
         texturedata->texture.d3dfmt,
-        texturedata->texture.w, texturedata->texture.h) < 0) return -1;
-    texturedata->texture.dirty = SDL_TRUE;
-
-    if (texturedata->yuv) {
-        if (D3D_RecreateTextureRep(data->device, &texturedata->utexture) < 0) return -1;
-        if (D3D_CreateTextureRep(data->device, &texturedata->utexture,
-            texturedata->utexture.usage, texturedata->utexture.format,
-            texturedata->utexture.d3dfmt,
-            texturedata->utexture.w, texturedata->utexture.h) < 0) return -1;
-        texturedata->utexture.dirty = SDL_TRUE;
-
-        if (D3D_RecreateTextureRep(data->device, &texturedata->vtexture) < 0) return -1;
-        if (D3D_CreateTextureRep(data->device, &texturedata->vtexture,
-            texturedata->vtexture.usage, texturedata->vtexture.format,
-            texturedata->vtexture.d3dfmt,
-            texturedata->vtexture.w, texturedata->vtexture.h) < 0) return -1;
-        texturedata->vtexture.dirty = SDL_TRUE;
-    }
+        texturedata->texture.w, texturedata->texture.h, texturedata->texture.swizzled) < 0) return -1;
+    D3D_AddDirtyRect(&texturedata->texture, 0, 0, texturedata->texture.w, texturedata->texture.h);
 
     return 0;
 }
 
 static int
-D3D_UpdateTexture(SDL_Renderer* renderer, SDL_Texture* texture,
-    const SDL_Rect* rect, const void* pixels, int pitch)
+D3D_UpdateTextureYUV(SDL_Renderer* renderer, SDL_Texture* texture,
+    const SDL_Rect* rect,
+    const Uint8* Yplane, int Ypitch,
+    const Uint8* Uplane, int Upitch,
+    const Uint8* Vplane, int Vpitch)
 {
     D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
     D3D_TextureData* texturedata = (D3D_TextureData*)texture->driverdata;
@@ -628,10 +1747,9 @@ D3D_UpdateTexture(SDL_Renderer* renderer, SDL_Texture* texture,
     int texw, texh;
 
     if (!texturedata) { SDL_SetError("Texture is not currently available"); return -1; }
-    if (!pixels) return 0;
+    if (!Yplane || !Uplane || !Vplane) return 0;
 
-    texw = texture->w;
-    texh = texture->h;
+    texw = texture->w; texh = texture->h;
 
     if (rect == NULL) { r.x = 0; r.y = 0; r.w = texw; r.h = texh; }
     else { r = *rect; }
@@ -642,50 +1760,42 @@ D3D_UpdateTexture(SDL_Renderer* renderer, SDL_Texture* texture,
     if (r.y + r.h > texh) r.h = texh - r.y;
     if (r.w <= 0 || r.h <= 0) return 0;
 
-    if (!texturedata->yuv) {
-        if (D3D_UpdateTextureRep(data->device, &texturedata->texture, r.x, r.y, r.w, r.h, pixels, pitch) < 0) return -1;
-        return 0;
+    if (D3D_UpdateTextureRepFromPlanes(data->device, &texturedata->texture, &r, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch, 1) < 0) return -1;
+    if (texturedata->texture.numstreaming > 0 && data->drawstate.texture == texture) {
+        data->drawstate.texture = NULL;
     }
 
-    /* Planar YUV case (I420/YV12-like): Y followed by U and V planes in src */
-    {
-        const Uint8* base = (const Uint8*)pixels;
-
-        const Uint8* src_after_Y = base + (size_t)r.h * (size_t)pitch;
-
-        const int chroma_w = (r.w + 1) / 2;
-        const int chroma_h = (r.h + 1) / 2;
-        const int chroma_pitch = (pitch + 1) / 2;
-
-        D3D_TextureRep* first_chroma = (texture->format == SDL_PIXELFORMAT_YV12) ? &texturedata->vtexture : &texturedata->utexture;
-        D3D_TextureRep* second_chroma = (texture->format == SDL_PIXELFORMAT_YV12) ? &texturedata->utexture : &texturedata->vtexture;
+    return 0;
+}
 
-        if (D3D_UpdateTextureRep(data->device, &texturedata->texture, r.x, r.y, r.w, r.h, base, pitch) < 0) return -1;
+static int
+D3D_UpdateTextureNV(SDL_Renderer* renderer, SDL_Texture* texture,
+    const SDL_Rect* rect,
+    const Uint8* Yplane, int Ypitch,
+    const Uint8* UVplane, int UVpitch)
+{
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
+    D3D_TextureData* texturedata = (D3D_TextureData*)texture->driverdata;
+    const Uint8* Uplane;
+    const Uint8* Vplane;
 
-        if (chroma_w > 0 && chroma_h > 0) {
-            const int cx = r.x / 2, cy = r.y / 2;
+    if (!texturedata) { SDL_SetError("Texture is not currently available"); return -1; }
+    if (!Yplane || !UVplane || !rect || rect->w <= 0 || rect->h <= 0) return 0;
 
-            /* U (or V) */
-            if (D3D_UpdateTextureRep(data->device, first_chroma, cx, cy, chroma_w, chroma_h, src_after_Y, chroma_pitch) < 0) return -1;
+    Uplane = (texture->format == SDL_PIXELFORMAT_NV21) ? UVplane + 1 : UVplane;
+    Vplane = (texture->format == SDL_PIXELFORMAT_NV21) ? UVplane : UVplane + 1;
 
-            /* V (or U), lives after the first chroma plane */
-            {
-                const Uint8* src_second = src_after_Y + (size_t)chroma_h * (size_t)chroma_pitch;
-                if (D3D_UpdateTextureRep(data->device, second_chroma, cx, cy, chroma_w, chroma_h, src_second, chroma_pitch) < 0) return -1;
-            }
-        }
+    if (D3D_UpdateTextureRepFromPlanes(data->device, &texturedata->texture, rect, Yplane, Ypitch, Uplane, UVpitch, Vplane, UVpitch, 2) < 0) return -1;
+    if (texturedata->texture.numstreaming > 0 && data->drawstate.texture == texture) {
+        data->drawstate.texture = NULL;
     }
 
     return 0;
 }
 
-
 static int
-D3D_UpdateTextureYUV(SDL_Renderer* renderer, SDL_Texture* texture,
-    const SDL_Rect* rect,
-    const Uint8* Yplane, int Ypitch,
-    const Uint8* Uplane, int Upitch,
-    const Uint8* Vplane, int Vpitch)
+D3D_UpdateTexture(SDL_Renderer* renderer, SDL_Texture* texture,
+    const SDL_Rect* rect, const void* pixels, int pitch)
 {
     D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
     D3D_TextureData* texturedata = (D3D_TextureData*)texture->driverdata;
@@ -694,9 +1804,10 @@ D3D_UpdateTextureYUV(SDL_Renderer* renderer, SDL_Texture* texture,
     int texw, texh;
 
     if (!texturedata) { SDL_SetError("Texture is not currently available"); return -1; }
-    if (!Yplane || !Uplane || !Vplane) return 0;
+    if (!pixels) return 0;
 
-    texw = texture->w; texh = texture->h;
+    texw = texture->w;
+    texh = texture->h;
 
     if (rect == NULL) { r.x = 0; r.y = 0; r.w = texw; r.h = texh; }
     else { r = *rect; }
@@ -707,19 +1818,41 @@ D3D_UpdateTextureYUV(SDL_Renderer* renderer, SDL_Texture* texture,
     if (r.y + r.h > texh) r.h = texh - r.y;
     if (r.w <= 0 || r.h <= 0) return 0;
 
-    if (D3D_UpdateTextureRep(data->device, &texturedata->texture, r.x, r.y, r.w, r.h, Yplane, Ypitch) < 0) return -1;
+    if (!texturedata->yuv) {
+        int x, y;
+        D3D_TextureRep* rep = D3D_GetTextureDataRep(texturedata, &x, &y);
+
+        if (D3D_UpdateTextureRep(data->device, rep, x + r.x, y + r.y, r.w, r.h, pixels, pitch) < 0) return -1;
+        if (texturedata->atlas && D3D_ExtrudeAtlasEntry(data->device, texturedata, &r) < 0) return -1;
+        if (texturedata->texture.numstreaming > 0 && data->drawstate.texture == texture) {
+            data->drawstate.texture = NULL;
+        }
+        return 0;
+    }
 
+    /* Planar YUV: Y followed by the chroma plane(s), as laid out by SDL */
     {
-        const int cx = r.x / 2, cy = r.y / 2;
-        const int cw = (r.w + 1) / 2, ch = (r.h + 1) / 2;
+        const Uint8* Yplane = (const Uint8*)pixels;
+        const Uint8* Uplane = Yplane + (size_t)r.h * (size_t)pitch;
+        int result;
 
-        if (cw > 0 && ch > 0) {
-            if (D3D_UpdateTextureRep(data->device, &texturedata->utexture, cx, cy, cw, ch, Uplane, Upitch) < 0) return -1;
-            if (D3D_UpdateTextureRep(data->device, &texturedata->vtexture, cx, cy, cw, ch, Vplane, Vpitch) < 0) return -1;
+        if (texture->format == SDL_PIXELFORMAT_NV12 || texture->format == SDL_PIXELFORMAT_NV21) {
+            const int UVpitch = 2 * ((pitch + 1) / 2);
+            result = D3D_UpdateTextureNV(renderer, texture, &r, Yplane, pitch, Uplane, UVpitch);
         }
-    }
+        else {
+            const int Upitch = (pitch + 1) / 2;
+            const Uint8* Vplane = Uplane + (size_t)((r.h + 1) / 2) * (size_t)Upitch;
 
-    return 0;
+            if (texture->format == SDL_PIXELFORMAT_YV12) {
+                result = D3D_UpdateTextureYUV(renderer, texture, &r, Yplane, pitch, Vplane, Upitch, Uplane, Upitch);
+            }
+            else {
+                result = D3D_UpdateTextureYUV(renderer, texture, &r, Yplane, pitch, Uplane, Upitch, Vplane, Upitch);
+            }
+        }
+        return result;
+    }
 }
 
 static int
@@ -751,22 +1884,26 @@ D3D_LockTexture(SDL_Renderer* renderer, SDL_Texture* texture,
 
     texturedata->locked_rect = r;
 
-    /* Disallow locking planar YUV; callers must use UpdateTextureYUV */
+    /* Planar YUV is written to a shadow copy in SDL's layout and packed into
+       the YUY2 texture on unlock. */
     if (texturedata->yuv) {
-        return SDL_SetError("Planar YUV textures must be updated with SDL_UpdateYUVTexture / UpdateTextureYUV");
+        if (!texturedata->pixels) {
+            const int cpitch = (texw + 1) / 2;
+            texturedata->pitch = texw;
+            texturedata->pixels = (Uint8*)SDL_malloc((size_t)texh * texw + (size_t)2 * ((texh + 1) / 2) * cpitch);
+            if (!texturedata->pixels) return SDL_OutOfMemory();
+        }
+        *pixels = texturedata->pixels + (size_t)r.y * (size_t)texturedata->pitch + (size_t)r.x;
+        *pitch = texturedata->pitch;
+        return 0;
     }
 
     {
-        RECT d3drect;
         D3DLOCKED_RECT locked;
-        HRESULT hr;
-
-        if (D3D_CreateStagingTexture(device, &texturedata->texture) < 0) return -1;
+        int x, y;
+        D3D_TextureRep* rep = D3D_GetTextureDataRep(texturedata, &x, &y);
 
-        d3drect.left = r.x; d3drect.top = r.y; d3drect.right = r.x + r.w; d3drect.bottom = r.y + r.h;
-
-        hr = IDirect3DTexture8_LockRect(texturedata->texture.staging, 0, &locked, &d3drect, 0);
-        if (FAILED(hr)) return D3D_SetError("LockRect()", hr);
+        if (D3D_LockTextureRepForWrite(device, rep, x + r.x, y + r.y, r.w, r.h, &locked) < 0) return -1;
 
         *pixels = locked.pBits;
         *pitch = (int)locked.Pitch;
@@ -798,35 +1935,52 @@ D3D_UnlockTexture(SDL_Renderer* renderer, SDL_Texture* texture)
 
     if (texturedata->yuv) {
         const SDL_Rect* rect = &texturedata->locked_rect;
-        void* pixels = NULL;
-        int pitch = 0;
+        const int pitch = texturedata->pitch;
+        const int cpitch = (pitch + 1) / 2;
+        const Uint8* Yplane = texturedata->pixels;
+        const Uint8* Uplane = Yplane + (size_t)texture->h * (size_t)pitch;
 
-        if (!texturedata->pixels || texturedata->pitch <= 0) return;
+        if (!texturedata->pixels || pitch <= 0) return;
 
-        pixels = (void*)((Uint8*)texturedata->pixels +
-            (size_t)rect->y * (size_t)texturedata->pitch +
-            (size_t)rect->x);
-        pitch = texturedata->pitch;
+        Yplane += (size_t)rect->y * (size_t)pitch + (size_t)rect->x;
+        if (texture->format == SDL_PIXELFORMAT_NV12 || texture->format == SDL_PIXELFORMAT_NV21) {
+            Uplane += (size_t)(rect->y / 2) * (size_t)(2 * cpitch) + (size_t)(rect->x & ~1);
+            D3D_UpdateTextureNV(renderer, texture, rect, Yplane, pitch, Uplane, 2 * cpitch);
+        }
+        else {
+            const Uint8* Vplane = Uplane + (size_t)((texture->h + 1) / 2) * (size_t)cpitch;
+            const size_t offset = (size_t)(rect->y / 2) * (size_t)cpitch + (size_t)(rect->x / 2);
 
-        D3D_UpdateTexture(renderer, texture, rect, pixels, pitch);
-        return;
-    }
-    else {
-        if (texturedata->texture.staging) {
-            IDirect3DTexture8_UnlockRect(texturedata->texture.staging, 0);
-            texturedata->texture.dirty = SDL_TRUE;
-            if (data->drawstate.texture == texture) {
-                data->drawstate.texture = NULL;
+            if (texture->format == SDL_PIXELFORMAT_YV12) {
+                D3D_UpdateTextureYUV(renderer, texture, rect, Yplane, pitch, Vplane + offset, cpitch, Uplane + offset, cpitch);
+            }
+            else {
+                D3D_UpdateTextureYUV(renderer, texture, rect, Yplane, pitch, Uplane + offset, cpitch, Vplane + offset, cpitch);
             }
         }
         return;
     }
+
+    {
+        const SDL_Rect* rect = &texturedata->locked_rect;
+        int x, y;
+        D3D_TextureRep* rep = D3D_GetTextureDataRep(texturedata, &x, &y);
+
+        D3D_UnlockTextureRepForWrite(rep, x + rect->x, y + rect->y, rect->w, rect->h);
+        /* the bound buffer may have rotated, or the staging copy is dirty */
+        if (data->drawstate.texture == texture) {
+            data->drawstate.texture = NULL;
+        }
+    }
 }
 
 /* ------------------------- GPU upload & binding -------------------------- */
 
-static HRESULT D3D8_UpdateTexture(IDirect3DTexture8* srcTexture, IDirect3DTexture8* dstTexture)
+/* Copies 'rect' of the staging texture into the same place in the GPU texture. */
+static HRESULT D3D8_UpdateTexture(IDirect3DTexture8* srcTexture, IDirect3DTexture8* dstTexture, const SDL_Rect* rect)
 {
+    RECT srcrect;
+    POINT dstpoint;
     LPDIRECT3DSURFACE8 srcSurface = NULL;
     LPDIRECT3DSURFACE8 dstSurface = NULL;
     IDirect3DDevice8* device = NULL;
@@ -848,7 +2002,14 @@ static HRESULT D3D8_UpdateTexture(IDirect3DTexture8* srcTexture, IDirect3DTextur
         return hr;
     }
 
-    hr = IDirect3DDevice8_CopyRects(device, srcSurface, NULL, 0, dstSurface, NULL);
+    srcrect.left = rect->x;
+    srcrect.top = rect->y;
+    srcrect.right = rect->x + rect->w;
+    srcrect.bottom = rect->y + rect->h;
+    dstpoint.x = rect->x;
+    dstpoint.y = rect->y;
+
+    hr = IDirect3DDevice8_CopyRects(device, srcSurface, &srcrect, 1, dstSurface, &dstpoint);
 
     IDirect3DDevice8_Release(device);
     IDirect3DSurface8_Release(dstSurface);
@@ -857,8 +2018,71 @@ static HRESULT D3D8_UpdateTexture(IDirect3DTexture8* srcTexture, IDirect3DTextur
     return hr;
 }
 
-static int UpdateDirtyTexture(IDirect3DDevice8* device, D3D_TextureRep* texture)
+/* Copies the block rows covering 'rect' of a compressed staging texture.
+   Both levels have the same layout, so this is a plain memcpy per row. */
+static HRESULT D3D8_CopyTextureBlocks(IDirect3DTexture8* srcTexture, IDirect3DTexture8* dstTexture, const SDL_Rect* rect, int blockbytes)
+{
+    D3DLOCKED_RECT src, dst;
+    const int offset = (rect->x / 4) * blockbytes;
+    const int len = ((rect->w + 3) / 4) * blockbytes;
+    int row;
+    HRESULT hr;
+
+    hr = IDirect3DTexture8_LockRect(srcTexture, 0, &src, NULL, D3DLOCK_READONLY);
+    if (FAILED(hr)) return hr;
+
+    hr = IDirect3DTexture8_LockRect(dstTexture, 0, &dst, NULL, 0);
+    if (FAILED(hr)) {
+        IDirect3DTexture8_UnlockRect(srcTexture, 0);
+        return hr;
+    }
+
+    for (row = rect->y / 4; row < (rect->y + rect->h + 3) / 4; ++row) {
+        SDL_memcpy((Uint8*)dst.pBits + row * dst.Pitch + offset,
+                   (const Uint8*)src.pBits + row * src.Pitch + offset, (size_t)len);
+    }
+
+    IDirect3DTexture8_UnlockRect(dstTexture, 0);
+    IDirect3DTexture8_UnlockRect(srcTexture, 0);
+    return D3D_OK;
+}
+
+/* Swizzles 'rect' of the linear staging texture into the GPU texture. */
+static HRESULT D3D8_SwizzleTexture(IDirect3DTexture8* srcTexture, IDirect3DTexture8* dstTexture, const SDL_Rect* rect, int bpp)
+{
+    D3DSURFACE_DESC desc;
+    D3DLOCKED_RECT src, dst;
+    RECT srcrect;
+    HRESULT hr;
+
+    hr = IDirect3DTexture8_GetLevelDesc(dstTexture, 0, &desc);
+    if (FAILED(hr)) return hr;
+
+    srcrect.left = rect->x;
+    srcrect.top = rect->y;
+    srcrect.right = rect->x + rect->w;
+    srcrect.bottom = rect->y + rect->h;
+
+    hr = IDirect3DTexture8_LockRect(srcTexture, 0, &src, &srcrect, D3DLOCK_READONLY);
+    if (FAILED(hr)) return hr;
+
+    /* Swizzled surfaces can only be locked as a whole. */
+    hr = IDirect3DTexture8_LockRect(dstTexture, 0, &dst, NULL, 0);
+    if (FAILED(hr)) {
+        IDirect3DTexture8_UnlockRect(srcTexture, 0);
+        return hr;
+    }
+
+    XBOX_SwizzleRect(src.pBits, src.Pitch, dst.pBits, (int)desc.Width, (int)desc.Height, rect, bpp);
+
+    IDirect3DTexture8_UnlockRect(dstTexture, 0);
+    IDirect3DTexture8_UnlockRect(srcTexture, 0);
+    return D3D_OK;
+}
+
+static int UpdateDirtyTexture(D3D_RenderData* data, D3D_TextureRep* texture)
 {
+    IDirect3DDevice8* device = data->device;
     HRESULT hr;
 
     if (!texture || !texture->staging || !texture->dirty) {
@@ -867,49 +2091,61 @@ static int UpdateDirtyTexture(IDirect3DDevice8* device, D3D_TextureRep* texture)
 
     if (!texture->texture) {
         hr = IDirect3DDevice8_CreateTexture(device, texture->w, texture->h, 1,
-            texture->usage, texture->d3dfmt,
+            texture->usage, D3D_GetTextureRepFormat(texture),
             D3DPOOL_DEFAULT, &texture->texture);
         if (FAILED(hr)) {
             return D3D_SetError("CreateTexture(D3DPOOL_DEFAULT)", hr);
         }
+        D3D_AddDirtyRect(texture, 0, 0, texture->w, texture->h);
     }
     else {
         D3DSURFACE_DESC sdesc, ddesc;
         if (SUCCEEDED(IDirect3DTexture8_GetLevelDesc(texture->staging, 0, &sdesc)) &&
             SUCCEEDED(IDirect3DTexture8_GetLevelDesc(texture->texture, 0, &ddesc))) {
-            if ((sdesc.Width != ddesc.Width) || (sdesc.Height != ddesc.Height) || (sdesc.Format != ddesc.Format)) {
+            if ((sdesc.Width != ddesc.Width) || (sdesc.Height != ddesc.Height) || (ddesc.Format != D3D_GetTextureRepFormat(texture))) {
                 IDirect3DTexture8_Release(texture->texture);
                 texture->texture = NULL;
                 hr = IDirect3DDevice8_CreateTexture(device, texture->w, texture->h, 1,
-                    texture->usage, texture->d3dfmt,
+                    texture->usage, D3D_GetTextureRepFormat(texture),
                     D3DPOOL_DEFAULT, &texture->texture);
                 if (FAILED(hr)) {
                     return D3D_SetError("CreateTexture(D3DPOOL_DEFAULT)", hr);
                 }
+                D3D_AddDirtyRect(texture, 0, 0, texture->w, texture->h);
             }
         }
     }
 
-    hr = D3D8_UpdateTexture(texture->staging, texture->texture);
+    if (D3DFMTBlockBytes(texture->d3dfmt)) {
+        hr = D3D8_CopyTextureBlocks(texture->staging, texture->texture, &texture->dirtyrect, D3DFMTBlockBytes(texture->d3dfmt));
+    }
+    else if (texture->swizzled) {
+        hr = D3D8_SwizzleTexture(texture->staging, texture->texture, &texture->dirtyrect, SDL_BYTESPERPIXEL(texture->format));
+    }
+    else {
+        hr = D3D8_UpdateTexture(texture->staging, texture->texture, &texture->dirtyrect);
+    }
     if (FAILED(hr)) {
         return D3D_SetError("UpdateTexture()", hr);
     }
 
+    data->stats.upload_bytes += D3D_GetTextureRepRectBytes(texture, &texture->dirtyrect);
+    data->stats.texture_uploads++;
     texture->dirty = SDL_FALSE;
     return 0;
 }
 
-static int BindTextureRep(IDirect3DDevice8* device, D3D_TextureRep* texture, DWORD sampler)
+static int BindTextureRep(D3D_RenderData* data, D3D_TextureRep* texture, DWORD sampler)
 {
     HRESULT hr;
 
-    if (!device || !texture) return D3D_SetError("BindTextureRep(): invalid args", D3DERR_INVALIDCALL);
+    if (!data || !texture) return D3D_SetError("BindTextureRep(): invalid args", D3DERR_INVALIDCALL);
 
-    if (UpdateDirtyTexture(device, texture) < 0) return -1;
+    if (UpdateDirtyTexture(data, texture) < 0) return -1;
 
     if (!texture->texture) return D3D_SetError("BindTextureRep(): no GPU texture", D3DERR_INVALIDCALL);
 
-    hr = IDirect3DDevice8_SetTexture(device, sampler, (IDirect3DBaseTexture8*)texture->texture);
+    hr = D3D_SetTexture(data, sampler, (IDirect3DBaseTexture8*)texture->texture);
     if (FAILED(hr)) return D3D_SetError("SetTexture()", hr);
 
     return 0;
@@ -919,15 +2155,11 @@ static void UpdateTextureScaleMode(D3D_RenderData* data, D3D_TextureData* textur
 {
     if (!data || !texturedata) return;
 
-    if (texturedata->scaleMode != data->scaleMode[index]) {
-        IDirect3DDevice8_SetTextureStageState(data->device, index, D3DTSS_MINFILTER, texturedata->scaleMode);
-        IDirect3DDevice8_SetTextureStageState(data->device, index, D3DTSS_MAGFILTER, texturedata->scaleMode);
-        data->scaleMode[index] = texturedata->scaleMode;
-    }
-
-    IDirect3DDevice8_SetTextureStageState(data->device, index, D3DTSS_MIPFILTER, D3DTEXF_NONE);
-    IDirect3DDevice8_SetTextureStageState(data->device, index, D3DTSS_ADDRESSU, D3DTADDRESS_CLAMP);
-    IDirect3DDevice8_SetTextureStageState(data->device, index, D3DTSS_ADDRESSV, D3DTADDRESS_CLAMP);
+    D3D_SetTextureStageState(data, index, D3DTSS_MINFILTER, texturedata->scaleMode);
+    D3D_SetTextureStageState(data, index, D3DTSS_MAGFILTER, texturedata->scaleMode);
+    D3D_SetTextureStageState(data, index, D3DTSS_MIPFILTER, D3DTEXF_NONE);
+    D3D_SetTextureStageState(data, index, D3DTSS_ADDRESSU, D3DTADDRESS_CLAMP);
+    D3D_SetTextureStageState(data, index, D3DTSS_ADDRESSV, D3DTADDRESS_CLAMP);
 }
 
 static int SetupTextureState(D3D_RenderData* data, SDL_Texture* texture)
@@ -936,61 +2168,47 @@ static int SetupTextureState(D3D_RenderData* data, SDL_Texture* texture)
 
     if (!texturedata) { SDL_SetError("Texture is not currently available"); return -1; }
 
+    /* YUV textures need no extra stages: the texture unit converts YUY2 and
+       UYVY to RGB as it samples them. */
     UpdateTextureScaleMode(data, texturedata, 0);
-    if (BindTextureRep(data->device, &texturedata->texture, 0) < 0) return -1;
+    if (BindTextureRep(data, D3D_GetTextureDataRep(texturedata, NULL, NULL), 0) < 0) return -1;
+    if (texturedata->palettes[0]) {
+        IDirect3DDevice8_SetPalette(data->device, 0, texturedata->palettes[texturedata->curpalette]);
+    }
 
-    if (texturedata->yuv) {
-        UpdateTextureScaleMode(data, texturedata, 1);
-        UpdateTextureScaleMode(data, texturedata, 2);
+    return 0;
+}
 
-        if (BindTextureRep(data->device, &texturedata->utexture, 1) < 0) return -1;
-        if (BindTextureRep(data->device, &texturedata->vtexture, 2) < 0) return -1;
+/* -------------------------- State management ----------------------------- */
 
-        IDirect3DDevice8_SetTextureStageState(data->device, 1, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
-        IDirect3DDevice8_SetTextureStageState(data->device, 1, D3DTSS_COLORARG1, D3DTA_TEXTURE);
-        IDirect3DDevice8_SetTextureStageState(data->device, 1, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
-        IDirect3DDevice8_SetTextureStageState(data->device, 1, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
+/* Vertex layout of a draw. Compact quads take their colour from the texture
+   factor instead of the vertices. */
+static void SetVertexFormat(D3D_RenderData* data, const SDL_RenderCommand* cmd)
+{
+    const SDL_bool compact = (cmd->data.draw.first & D3D_VERTICES_COMPACT) ? SDL_TRUE : SDL_FALSE;
+    const DWORD shader = compact ? data->compactShader : D3D_FVF_VERTEX;
+    const DWORD arg = compact ? D3DTA_TFACTOR : D3DTA_DIFFUSE;
 
-        IDirect3DDevice8_SetTextureStageState(data->device, 2, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
-        IDirect3DDevice8_SetTextureStageState(data->device, 2, D3DTSS_COLORARG1, D3DTA_TEXTURE);
-        IDirect3DDevice8_SetTextureStageState(data->device, 2, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
-        IDirect3DDevice8_SetTextureStageState(data->device, 2, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
+    if (shader != data->vertexShader) {
+        IDirect3DDevice8_SetVertexShader(data->device, shader);
+        data->vertexShader = shader;
     }
-    else {
-        IDirect3DDevice8_SetTexture(data->device, 1, NULL);
-        IDirect3DDevice8_SetTexture(data->device, 2, NULL);
-        IDirect3DDevice8_SetTextureStageState(data->device, 1, D3DTSS_COLOROP, D3DTOP_DISABLE);
-        IDirect3DDevice8_SetTextureStageState(data->device, 1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
-        IDirect3DDevice8_SetTextureStageState(data->device, 2, D3DTSS_COLOROP, D3DTOP_DISABLE);
-        IDirect3DDevice8_SetTextureStageState(data->device, 2, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+    if (compact) {
+        D3D_SetRenderState(data, D3DRS_TEXTUREFACTOR,
+            D3DCOLOR_ARGB(cmd->data.draw.a, cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b));
     }
-
-    return 0;
+    D3D_SetTextureStageState(data, 0, D3DTSS_COLORARG2, arg);
+    D3D_SetTextureStageState(data, 0, D3DTSS_ALPHAARG2, arg);
 }
 
-/* -------------------------- State management ----------------------------- */
-
 static int SetDrawState(D3D_RenderData* data, const SDL_RenderCommand* cmd)
 {
-    const SDL_bool was_copy_ex = data->drawstate.is_copy_ex;
-    const SDL_bool is_copy_ex = (cmd->command == SDL_RENDERCMD_COPY_EX);
     SDL_Texture* texture = cmd->data.draw.texture;
     const SDL_BlendMode blend = cmd->data.draw.blend;
 
     if (texture != data->drawstate.texture) {
-        D3D_TextureData* oldtex = data->drawstate.texture ? (D3D_TextureData*)data->drawstate.texture->driverdata : NULL;
-        D3D_TextureData* newtex = texture ? (D3D_TextureData*)texture->driverdata : NULL;
-
         if (texture == NULL) {
-            IDirect3DDevice8_SetTexture(data->device, 0, NULL);
-        }
-        if ((!newtex || !newtex->yuv) && (oldtex && oldtex->yuv)) {
-            IDirect3DDevice8_SetTexture(data->device, 1, NULL);
-            IDirect3DDevice8_SetTexture(data->device, 2, NULL);
-            IDirect3DDevice8_SetTextureStageState(data->device, 1, D3DTSS_COLOROP, D3DTOP_DISABLE);
-            IDirect3DDevice8_SetTextureStageState(data->device, 1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
-            IDirect3DDevice8_SetTextureStageState(data->device, 2, D3DTSS_COLOROP, D3DTOP_DISABLE);
-            IDirect3DDevice8_SetTextureStageState(data->device, 2, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+            D3D_SetTexture(data, 0, NULL);
         }
 
         if (texture) {
@@ -1001,35 +2219,28 @@ static int SetDrawState(D3D_RenderData* data, const SDL_RenderCommand* cmd)
     }
     else if (texture) {
         D3D_TextureData* texdata = (D3D_TextureData*)texture->driverdata;
-        UpdateDirtyTexture(data->device, &texdata->texture);
-        if (texdata->yuv) {
-            UpdateDirtyTexture(data->device, &texdata->utexture);
-            UpdateDirtyTexture(data->device, &texdata->vtexture);
-        }
+        UpdateDirtyTexture(data, D3D_GetTextureDataRep(texdata, NULL, NULL));
+    }
+
+    if (texture) {
+        D3D_TextureRep* rep = D3D_GetTextureDataRep((D3D_TextureData*)texture->driverdata, NULL, NULL);
+        rep->lastused = data->gpuFrame;
     }
 
     if (blend != data->drawstate.blend) {
         if (blend == SDL_BLENDMODE_NONE) {
-            IDirect3DDevice8_SetRenderState(data->device, D3DRS_ALPHABLENDENABLE, FALSE);
+            D3D_SetRenderState(data, D3DRS_ALPHABLENDENABLE, FALSE);
         }
         else {
-            IDirect3DDevice8_SetRenderState(data->device, D3DRS_ALPHABLENDENABLE, TRUE);
-            IDirect3DDevice8_SetRenderState(data->device, D3DRS_SRCBLEND,
+            D3D_SetRenderState(data, D3DRS_ALPHABLENDENABLE, TRUE);
+            D3D_SetRenderState(data, D3DRS_SRCBLEND,
                 GetBlendFunc(SDL_GetBlendModeSrcColorFactor(blend)));
-            IDirect3DDevice8_SetRenderState(data->device, D3DRS_DESTBLEND,
+            D3D_SetRenderState(data, D3DRS_DESTBLEND,
                 GetBlendFunc(SDL_GetBlendModeDstColorFactor(blend)));
         }
         data->drawstate.blend = blend;
     }
 
-    if (is_copy_ex != was_copy_ex) {
-        if (!is_copy_ex) {
-            const Float4X4 m = MatrixIdentity();
-            IDirect3DDevice8_SetTransform(data->device, D3DTS_VIEW, (const D3DMATRIX*)&m);
-        }
-        data->drawstate.is_copy_ex = is_copy_ex;
-    }
-
     if (data->drawstate.viewport_dirty) {
         const SDL_Rect* vp = &data->drawstate.viewport;
         const D3DVIEWPORT8 d3dvp = (D3DVIEWPORT8){ (DWORD)vp->x, (DWORD)vp->y, (DWORD)vp->w, (DWORD)vp->h, 0.0f, 1.0f };
@@ -1062,56 +2273,309 @@ static int SetDrawState(D3D_RenderData* data, const SDL_RenderCommand* cmd)
         data->drawstate.cliprect_dirty = SDL_FALSE;
     }
 
+    SetVertexFormat(data, cmd);
+
     return 0;
 }
 
 
+/* ------------------------------ Vertex rings ----------------------------- */
+
+static void D3D_InitRing(D3D_Ring* ring, void* base, size_t size)
+{
+    SDL_zerop(ring);
+    ring->base = (Uint8*)base;
+    ring->size = size;
+}
+
+/* Xbox vertex and index buffers live in unified memory and unlocking them
+   does nothing, so each ring is locked once and written through that pointer
+   for its whole life. */
+static void D3D_CreateRings(D3D_RenderData* data)
+{
+    BYTE* ptr;
+
+    if (SUCCEEDED(IDirect3DDevice8_CreateVertexBuffer(data->device, D3D_VERTEX_RING_SIZE, D3DUSAGE_WRITEONLY,
+            D3D_FVF_VERTEX, D3DPOOL_DEFAULT, &data->vertexRingBuffer))) {
+        if (SUCCEEDED(IDirect3DVertexBuffer8_Lock(data->vertexRingBuffer, 0, 0, &ptr, D3DLOCK_NOOVERWRITE))) {
+            D3D_InitRing(&data->vertexRing, ptr, D3D_VERTEX_RING_SIZE);
+        }
+    }
+    if (SUCCEEDED(IDirect3DDevice8_CreateIndexBuffer(data->device, D3D_INDEX_RING_SIZE, D3DUSAGE_WRITEONLY,
+            D3DFMT_INDEX16, D3DPOOL_DEFAULT, &data->indexRingBuffer))) {
+        if (SUCCEEDED(IDirect3DIndexBuffer8_Lock(data->indexRingBuffer, 0, 0, &ptr, D3DLOCK_NOOVERWRITE))) {
+            D3D_InitRing(&data->indexRing, ptr, D3D_INDEX_RING_SIZE);
+        }
+    }
+
+    if (!data->vertexRing.base) {
+        SDL_LogError(SDL_LOG_CATEGORY_RENDER, "SDL failed to get a vertex buffer for Direct3D 8 rendering!");
+        SDL_LogError(SDL_LOG_CATEGORY_RENDER, "Dropping back to a slower method.");
+    }
+}
+
+static void D3D_ReleaseRings(D3D_RenderData* data)
+{
+    if (data->vertexRingBuffer) {
+        IDirect3DVertexBuffer8_Unlock(data->vertexRingBuffer);
+        IDirect3DVertexBuffer8_Release(data->vertexRingBuffer);
+        data->vertexRingBuffer = NULL;
+    }
+    if (data->indexRingBuffer) {
+        IDirect3DIndexBuffer8_Unlock(data->indexRingBuffer);
+        IDirect3DIndexBuffer8_Release(data->indexRingBuffer);
+        data->indexRingBuffer = NULL;
+    }
+    D3D_InitRing(&data->vertexRing, NULL, 0);
+    D3D_InitRing(&data->indexRing, NULL, 0);
+}
+
+/* Takes 'len' contiguous bytes from the ring, starting at a multiple of
+   'align' so that draws can address them by vertex index. Returns NULL when
+   the ring is missing or the batch being queued already fills it; the caller
+   then falls back to SDL's vertex array. */
+static void* D3D_RingAlloc(D3D_RenderData* data, D3D_Ring* ring, size_t len, size_t align, size_t* offset)
+{
+    const size_t chunksize = ring->size / D3D_RING_CHUNKS;
+    size_t start = ((ring->cursor + align - 1) / align) * align;
+    int c, first, last;
+
+    if (!ring->base || len == 0 || len > ring->size / 2) {
+        return NULL;
+    }
+
+    if (start + len > ring->size) {
+        start = 0;
+    }
+    first = (int)(start / chunksize);
+    last = (int)((start + len - 1) / chunksize);
+
+    for (c = first; c <= last; ++c) {
+        if (c != ring->chunk && (ring->queued & (1u << c))) {
+            return NULL;
+        }
+    }
+
+    /* Entering a chunk: what the GPU read from it last lap must be done. */
+    for (c = first; c <= last; ++c) {
+        const Uint32 bit = 1u << c;
+        if (c != ring->chunk && (ring->pending & bit)) {
+            IDirect3DDevice8_BlockOnFence(data->device, ring->fence[c]);
+            ring->pending &= ~bit;
+        }
+        ring->queued |= bit;
+    }
+
+    ring->chunk = last;
+    ring->cursor = start + len;
+    *offset = start;
+    return ring->base + start;
+}
+
+/* Called once the batch using the queued chunks has been submitted. */
+static void D3D_RingFence(D3D_Ring* ring, DWORD fence)
+{
+    int c;
+
+    for (c = 0; c < D3D_RING_CHUNKS; ++c) {
+        if (ring->queued & (1u << c)) {
+            ring->fence[c] = fence;
+        }
+    }
+    ring->pending |= ring->queued;
+    ring->queued = 0;
+}
+
+static SDL_INLINE size_t D3D_VertexStride(size_t first)
+{
+    return (first & D3D_VERTICES_COMPACT) ? sizeof(QuadVertex) : sizeof(Vertex);
+}
+
+/* Space for 'count' vertices of a command, in the vertex ring when possible.
+   While a display list is recorded they stay in SDL's vertex array, so the
+   list can keep a copy. */
+static void* D3D_AllocVertices(SDL_Renderer* renderer, SDL_RenderCommand* cmd, size_t count, SDL_bool compact)
+{
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
+    const size_t flags = compact ? D3D_VERTICES_COMPACT : 0;
+    const size_t stride = D3D_VertexStride(flags);
+    size_t offset;
+    void* ptr;
+
+    data->stats.vertex_bytes += (Uint32)(count * stride);
+
+    if (!data->recording) {
+        ptr = D3D_RingAlloc(data, &data->vertexRing, count * stride, stride, &offset);
+        if (ptr) {
+            cmd->data.draw.first = offset | flags;
+            return ptr;
+        }
+    }
+
+    ptr = SDL_AllocateRenderVertices(renderer, count * stride, 0, &offset);
+    if (!ptr) return NULL;
+    cmd->data.draw.first = offset | flags | D3D_VERTICES_IN_QUEUE;
+    return ptr;
+}
+
+static const Vertex* D3D_GetVertices(const D3D_RenderData* data, const void* vertices, size_t first)
+{
+    if (first & D3D_VERTICES_IN_QUEUE) {
+        return (const Vertex*)((const Uint8*)vertices + (first & ~D3D_VERTEX_FLAGS));
+    }
+    return (const Vertex*)(data->vertexRing.base + (first & ~D3D_VERTEX_FLAGS));
+}
+
+static void D3D_BindVertexRing(D3D_RenderData* data, UINT stride)
+{
+    if (data->vertexRingStride != stride) {
+        IDirect3DDevice8_SetStreamSource(data->device, 0, data->vertexRingBuffer, stride);
+        data->vertexRingStride = stride;
+    }
+}
+
+static SDL_bool D3D_IsSameTextureState(SDL_Texture* a, SDL_Texture* b);
+
+/* Quads use QuadVertex when they have the colour of the quad queued before
+   them. A command that can join the previous quad command keeps its vertex
+   layout on the same colour and falls back to full vertices on a different
+   one, so runs of equally or differently tinted sprites both stay in one
+   draw. */
+static SDL_bool D3D_UseCompactQuad(D3D_RenderData* data, const SDL_RenderCommand* cmd, DWORD color)
+{
+    SDL_bool compact;
+
+    if (color != data->quadColor) {
+        compact = SDL_FALSE;
+    } else if (data->quadBlend == cmd->data.draw.blend &&
+               D3D_IsSameTextureState(data->quadTexture, cmd->data.draw.texture)) {
+        compact = data->quadCompact;
+    } else {
+        compact = SDL_TRUE;
+    }
+    compact = (data->compactShader && compact) ? SDL_TRUE : SDL_FALSE;
+
+    data->quadTexture = cmd->data.draw.texture;
+    data->quadBlend = cmd->data.draw.blend;
+    data->quadColor = color;
+    data->quadCompact = compact;
+    return compact;
+}
+
+static SDL_INLINE void* D3D_PutQuadVertex(void* dst, SDL_bool compact, float x, float y, DWORD color, float u, float v)
+{
+    if (compact) {
+        QuadVertex* vert = (QuadVertex*)dst;
+        vert->x = x; vert->y = y; vert->u = u; vert->v = v;
+        return vert + 1;
+    }
+    else {
+        Vertex* vert = (Vertex*)dst;
+        vert->x = x; vert->y = y; vert->z = 0.0f; vert->color = color; vert->u = u; vert->v = v;
+        return vert + 1;
+    }
+}
+
 /* -------------------------- Render command queue ------------------------- */
 
 static int D3D_QueueSetViewport(SDL_Renderer* renderer, SDL_RenderCommand* cmd) { (void)renderer; (void)cmd; return 0; }
 static int D3D_QueueSetDrawColor(SDL_Renderer* r, SDL_RenderCommand* c) { (void)r; (void)c; return 0; }
 
+/* Points and lines are queued as quads, lineWidth across, so they batch with
+   fill rects and copies and look the same at any width. A point covers the
+   lineWidth x lineWidth square around the pixel centre. */
 static int
 D3D_QueueDrawPoints(SDL_Renderer* renderer, SDL_RenderCommand* cmd, const SDL_FPoint* points, int count)
 {
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
     const DWORD color = D3DCOLOR_ARGB(cmd->data.draw.a, cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b);
-    const size_t vertslen = (size_t)count * sizeof(Vertex);
-    Vertex* verts;
+    const float half = data->lineWidth * 0.5f;
+    SDL_bool compact;
+    void* verts;
 
     if (count <= 0) { cmd->data.draw.count = 0; return 0; }
 
-    verts = (Vertex*)SDL_AllocateRenderVertices(renderer, vertslen, 0, &cmd->data.draw.first);
+    compact = D3D_UseCompactQuad(data, cmd, color);
+    verts = D3D_AllocVertices(renderer, cmd, (size_t)count * 4, compact);
     if (!verts) return -1;
 
     cmd->data.draw.count = count;
 
-    for (int i = 0; i < count; i++, verts++, points++) {
-        verts->x = points->x - 0.5f;
-        verts->y = points->y - 0.5f;
-        verts->z = 0.0f;
-        verts->color = color;
-        verts->u = 0.0f; verts->v = 0.0f;
+    for (int i = 0; i < count; i++, points++) {
+        const float minx = points->x - half;
+        const float miny = points->y - half;
+        const float maxx = points->x + half;
+        const float maxy = points->y + half;
+
+        verts = D3D_PutQuadVertex(verts, compact, minx, miny, color, 0.0f, 0.0f);
+        verts = D3D_PutQuadVertex(verts, compact, maxx, miny, color, 0.0f, 0.0f);
+        verts = D3D_PutQuadVertex(verts, compact, maxx, maxy, color, 0.0f, 0.0f);
+        verts = D3D_PutQuadVertex(verts, compact, minx, maxy, color, 0.0f, 0.0f);
     }
 
     return 0;
 }
 
+/* One quad per segment, running from half a width before its first point to
+   its second point, so consecutive segments don't overlap on a straight run.
+   The last segment also covers its end point, unless the polyline is closed
+   and the first segment already did. */
+static int
+D3D_QueueDrawLines(SDL_Renderer* renderer, SDL_RenderCommand* cmd, const SDL_FPoint* points, int count)
+{
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
+    const DWORD color = D3DCOLOR_ARGB(cmd->data.draw.a, cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b);
+    const float half = data->lineWidth * 0.5f;
+    SDL_bool close_endpoint;
+    SDL_bool compact;
+    void* verts;
+
+    if (count < 2) { cmd->data.draw.count = 0; return 0; }
 
-static int D3D_QueueDrawLines(SDL_Renderer* r, SDL_RenderCommand* c,
-    const SDL_FPoint* p, int n) {
-    return D3D_QueueDrawPoints(r, c, p, n);
-}
+    close_endpoint = ((count == 2) ||
+        (points[0].x != points[count - 1].x) || (points[0].y != points[count - 1].y)) ? SDL_TRUE : SDL_FALSE;
 
+    compact = D3D_UseCompactQuad(data, cmd, color);
+    verts = D3D_AllocVertices(renderer, cmd, (size_t)(count - 1) * 4, compact);
+    if (!verts) return -1;
+
+    cmd->data.draw.count = count - 1;
+
+    for (int i = 0; i < count - 1; i++) {
+        const SDL_FPoint* p0 = &points[i];
+        const SDL_FPoint* p1 = &points[i + 1];
+        const float dx = p1->x - p0->x;
+        const float dy = p1->y - p0->y;
+        const float len = SDL_sqrtf(dx * dx + dy * dy);
+        /* along and across the segment, half a width long */
+        const float ax = (len > 0.0f) ? dx * half / len : half;
+        const float ay = (len > 0.0f) ? dy * half / len : 0.0f;
+        const float nx = -ay;
+        const float ny = ax;
+        const SDL_bool endcap = (i == count - 2 && close_endpoint) ? SDL_TRUE : SDL_FALSE;
+        const float x0 = p0->x - ax;
+        const float y0 = p0->y - ay;
+        const float x1 = endcap ? p1->x + ax : p1->x;
+        const float y1 = endcap ? p1->y + ay : p1->y;
+
+        verts = D3D_PutQuadVertex(verts, compact, x0 + nx, y0 + ny, color, 0.0f, 0.0f);
+        verts = D3D_PutQuadVertex(verts, compact, x1 + nx, y1 + ny, color, 0.0f, 0.0f);
+        verts = D3D_PutQuadVertex(verts, compact, x1 - nx, y1 - ny, color, 0.0f, 0.0f);
+        verts = D3D_PutQuadVertex(verts, compact, x0 - nx, y0 - ny, color, 0.0f, 0.0f);
+    }
 
+    return 0;
+}
 
 static int
 D3D_QueueFillRects(SDL_Renderer* renderer, SDL_RenderCommand* cmd, const SDL_FRect* rects, int count)
 {
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
     const DWORD color = D3DCOLOR_ARGB(cmd->data.draw.a, cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b);
     if (count <= 0) { cmd->data.draw.count = 0; return 0; }
 
-    const size_t vertslen = (size_t)count * sizeof(Vertex) * 4;
-    Vertex* verts = (Vertex*)SDL_AllocateRenderVertices(renderer, vertslen, 0, &cmd->data.draw.first);
+    const SDL_bool compact = D3D_UseCompactQuad(data, cmd, color);
+    void* verts = D3D_AllocVertices(renderer, cmd, (size_t)count * 4, compact);
     if (!verts) return -1;
 
     cmd->data.draw.count = count;
@@ -1123,28 +2587,53 @@ D3D_QueueFillRects(SDL_Renderer* renderer, SDL_RenderCommand* cmd, const SDL_FRe
         const float maxx = rect->x + rect->w - 0.5f;
         const float maxy = rect->y + rect->h - 0.5f;
 
-        verts->x = minx; verts->y = miny; verts->z = 0.0f; verts->color = color; verts->u = 0.0f; verts->v = 0.0f; verts++;
-        verts->x = maxx; verts->y = miny; verts->z = 0.0f; verts->color = color; verts->u = 0.0f; verts->v = 0.0f; verts++;
-        verts->x = maxx; verts->y = maxy; verts->z = 0.0f; verts->color = color; verts->u = 0.0f; verts->v = 0.0f; verts++;
-        verts->x = minx; verts->y = maxy; verts->z = 0.0f; verts->color = color; verts->u = 0.0f; verts->v = 0.0f; verts++;
+        verts = D3D_PutQuadVertex(verts, compact, minx, miny, color, 0.0f, 0.0f);
+        verts = D3D_PutQuadVertex(verts, compact, maxx, miny, color, 0.0f, 0.0f);
+        verts = D3D_PutQuadVertex(verts, compact, maxx, maxy, color, 0.0f, 0.0f);
+        verts = D3D_PutQuadVertex(verts, compact, minx, maxy, color, 0.0f, 0.0f);
     }
 
     return 0;
 }
 
+/* Maps texel coordinates of a texture to sampler coordinates, u * su + ou.
+   Linear textures are addressed in texels, swizzled and compressed ones in
+   0..1; atlas entries are also offset to their place in the page. */
+static void D3D_GetTextureUVTransform(SDL_Texture* texture, float* su, float* sv, float* ou, float* ov)
+{
+    const D3D_TextureData* texturedata = (const D3D_TextureData*)texture->driverdata;
+
+    *ou = 0.0f;
+    *ov = 0.0f;
+    if (texturedata && texturedata->atlas) {
+        const D3D_TextureRep* page = &texturedata->atlas->texture;
+        XBOX_GetAtlasUVTransform(&texturedata->atlasrect, page->w, page->h, su, sv, ou, ov);
+    }
+    else if (texturedata && D3D_IsNormalizedTextureRep(&texturedata->texture)) {
+        *su = 1.0f / (float)texturedata->texture.w;
+        *sv = 1.0f / (float)texturedata->texture.h;
+    }
+    else {
+        *su = 1.0f;
+        *sv = 1.0f;
+    }
+}
+
 static int
 D3D_QueueCopy(SDL_Renderer* renderer, SDL_RenderCommand* cmd, SDL_Texture* texture,
     const SDL_Rect* srcrect, const SDL_FRect* dstrect)
 {
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
     const DWORD color = D3DCOLOR_ARGB(cmd->data.draw.a, cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b);
 
     if (!texture || !dstrect || dstrect->w <= 0.0f || dstrect->h <= 0.0f) { cmd->data.draw.count = 0; return 0; }
 
     float minx, miny, maxx, maxy;
     float minu, maxu, minv, maxv;
+    float su, sv, ou, ov;
 
-    const size_t vertslen = sizeof(Vertex) * 4;
-    Vertex* verts = (Vertex*)SDL_AllocateRenderVertices(renderer, vertslen, 0, &cmd->data.draw.first);
+    const SDL_bool compact = D3D_UseCompactQuad(data, cmd, color);
+    void* verts = D3D_AllocVertices(renderer, cmd, 4, compact);
     if (!verts) return -1;
 
     cmd->data.draw.count = 1;
@@ -1169,123 +2658,314 @@ D3D_QueueCopy(SDL_Renderer* renderer, SDL_RenderCommand* cmd, SDL_Texture* textu
         maxv = (float)texture->h - 0.5f;
     }
 
-    verts->x = minx; verts->y = miny; verts->z = 0.0f; verts->color = color; verts->u = minu; verts->v = minv; verts++;
-    verts->x = maxx; verts->y = miny; verts->z = 0.0f; verts->color = color; verts->u = maxu; verts->v = minv; verts++;
-    verts->x = maxx; verts->y = maxy; verts->z = 0.0f; verts->color = color; verts->u = maxu; verts->v = maxv; verts++;
-    verts->x = minx; verts->y = maxy; verts->z = 0.0f; verts->color = color; verts->u = minu; verts->v = maxv; verts++;
+    D3D_GetTextureUVTransform(texture, &su, &sv, &ou, &ov);
+    minu = minu * su + ou; maxu = maxu * su + ou;
+    minv = minv * sv + ov; maxv = maxv * sv + ov;
+
+    verts = D3D_PutQuadVertex(verts, compact, minx, miny, color, minu, minv);
+    verts = D3D_PutQuadVertex(verts, compact, maxx, miny, color, maxu, minv);
+    verts = D3D_PutQuadVertex(verts, compact, maxx, maxy, color, maxu, maxv);
+    verts = D3D_PutQuadVertex(verts, compact, minx, maxy, color, minu, maxv);
 
     return 0;
 }
 
+/* Sine and cosine of an angle in degrees, without the libm calls. The angle
+   is split into quarter turns and a remainder of at most 45 degrees, which
+   short Taylor series cover to float precision; multiples of 90 degrees
+   come out exact. */
+static void D3D_SinCosDegrees(double angle, float* s, float* c)
+{
+    const double turns = angle / 90.0;
+    int quadrant;
+    float x, x2, sn, cs;
+
+    if (turns <= -1.0e9 || turns >= 1.0e9) {
+        const double radians = angle * (3.14159265358979323846 / 180.0);
+        *s = (float)SDL_sin(radians);
+        *c = (float)SDL_cos(radians);
+        return;
+    }
+
+    quadrant = (int)((turns < 0.0) ? turns - 0.5 : turns + 0.5);
+    x = (float)((turns - quadrant) * (3.14159265358979323846 / 2.0));
+    x2 = x * x;
+    sn = x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f))));
+    cs = 1.0f + x2 * (-0.5f + x2 * (1.0f / 24.0f + x2 * (-1.0f / 720.0f + x2 * (1.0f / 40320.0f))));
+
+    switch (quadrant & 3) {
+    case 0: *s = sn;  *c = cs;  break;
+    case 1: *s = cs;  *c = -sn; break;
+    case 2: *s = -sn; *c = -cs; break;
+    default: *s = -cs; *c = sn; break;
+    }
+}
+
 static int
 D3D_QueueCopyEx(SDL_Renderer* renderer, SDL_RenderCommand* cmd, SDL_Texture* texture,
     const SDL_Rect* srcquad, const SDL_FRect* dstrect,
     const double angle, const SDL_FPoint* center, const SDL_RendererFlip flip,
     float scale_x, float scale_y)
 {
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
     const DWORD color = D3DCOLOR_ARGB(cmd->data.draw.a, cmd->data.draw.r, cmd->data.draw.g, cmd->data.draw.b);
     float minx, miny, maxx, maxy;
     float minu, maxu, minv, maxv;
+    float su, sv, ou, ov;
+    float s = 0.0f, c = 1.0f;
+    float tx, ty;
     SDL_FPoint ctr = { 0.0f, 0.0f };
+    SDL_FPoint corners[4];
+
+    if (!texture || !srcquad || !dstrect || dstrect->w <= 0.0f || dstrect->h <= 0.0f) {
+        cmd->data.draw.count = 0;
+        return 0;
+    }
+    if (center) ctr = *center;
+    if (scale_x == 0.0f) scale_x = 1.0f;
+    if (scale_y == 0.0f) scale_y = 1.0f;
+
+    const SDL_bool compact = D3D_UseCompactQuad(data, cmd, color);
+    void* verts = D3D_AllocVertices(renderer, cmd, 4, compact);
+    if (!verts) return -1;
+    cmd->data.draw.count = 1;
+
+    minx = -ctr.x; maxx = dstrect->w - ctr.x;
+    miny = -ctr.y; maxy = dstrect->h - ctr.y;
+
+    if (angle != 0.0) {
+        D3D_SinCosDegrees(angle, &s, &c);
+    }
+
+    corners[0].x = minx; corners[0].y = miny;
+    corners[1].x = maxx; corners[1].y = miny;
+    corners[2].x = maxx; corners[2].y = maxy;
+    corners[3].x = minx; corners[3].y = maxy;
+
+    tx = dstrect->x + ctr.x;
+    ty = dstrect->y + ctr.y;
+
+    minu = (float)srcquad->x + 0.5f;
+    maxu = (float)(srcquad->x + srcquad->w) - 0.5f;
+    minv = (float)srcquad->y + 0.5f;
+    maxv = (float)(srcquad->y + srcquad->h) - 0.5f;
+
+    D3D_GetTextureUVTransform(texture, &su, &sv, &ou, &ov);
+    minu = minu * su + ou; maxu = maxu * su + ou;
+    minv = minv * sv + ov; maxv = maxv * sv + ov;
+
+    if (flip & SDL_FLIP_HORIZONTAL) { float t = minu; minu = maxu; maxu = t; }
+    if (flip & SDL_FLIP_VERTICAL) { float t = minv; minv = maxv; maxv = t; }
+
+    /* Rotate the corners on the CPU so the sprite is a plain quad in the
+       batch; no per-sprite view matrix upload. */
+    for (int i = 0; i < 4; i++) {
+        const float x = corners[i].x;
+        const float y = corners[i].y;
+        verts = D3D_PutQuadVertex(verts, compact,
+            (x * c - y * s + tx) * scale_x - 0.5f,
+            (x * s + y * c + ty) * scale_y - 0.5f,
+            color,
+            (i == 0 || i == 3) ? minu : maxu,
+            (i < 2) ? minv : maxv);
+    }
+
+    return 0;
+}
+
+
+static SDL_INLINE int GetGeometryIndex(const void* indices, int size_indices, int i)
+{
+    switch (size_indices) {
+    case 4: return (int)((const Uint32*)indices)[i];
+    case 2: return (int)((const Uint16*)indices)[i];
+    case 1: return (int)((const Uint8*)indices)[i];
+    default: return i;
+    }
+}
+
+static int
+D3D_QueueGeometry(SDL_Renderer* renderer, SDL_RenderCommand* cmd, SDL_Texture* texture,
+    const float* xy, int xy_stride, const SDL_Color* color, int color_stride, const float* uv, int uv_stride,
+    int num_vertices, const void* indices, int num_indices, int size_indices,
+    float scale_x, float scale_y)
+{
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
+    const SDL_bool indexed = (indices && num_indices > 0 && num_vertices <= 0x10000) ? SDL_TRUE : SDL_FALSE;
+    const int count = indexed ? num_vertices : (indices ? num_indices : num_vertices);
+    const size_t vertexlen = sizeof(Vertex) * (1 + (size_t)count);
+    const size_t indexlen = indexed ?
+        ((((size_t)num_indices * sizeof(Uint16)) + sizeof(Vertex) - 1) / sizeof(Vertex)) * sizeof(Vertex) : 0;
+    D3D_GeometryHeader* header;
+    Vertex* verts;
+    Uint8* ptr = NULL;
+    Uint16* dst = NULL;
+    size_t offset, indexoffset = 0;
+    float su = 1.0f, sv = 1.0f, ou = 0.0f, ov = 0.0f;
+    int i;
+
+    if (count <= 0) { cmd->data.draw.count = 0; return 0; }
+
+    /* SDL hands over 0..1 coordinates; scale them to texels first. */
+    if (texture) {
+        D3D_GetTextureUVTransform(texture, &su, &sv, &ou, &ov);
+        su *= (float)texture->w;
+        sv *= (float)texture->h;
+    }
+
+    /* Vertices and indices both go to the rings, or both to SDL's vertex
+       array; ring space taken before a failure simply goes unused. */
+    if (!data->recording) {
+        ptr = (Uint8*)D3D_RingAlloc(data, &data->vertexRing, vertexlen, sizeof(Vertex), &offset);
+        if (ptr && indexed) {
+            dst = (Uint16*)D3D_RingAlloc(data, &data->indexRing, (size_t)num_indices * sizeof(Uint16), sizeof(Uint16), &indexoffset);
+            if (!dst) ptr = NULL;
+        }
+    }
+    if (ptr) {
+        cmd->data.draw.first = offset;
+    }
+    else {
+        ptr = (Uint8*)SDL_AllocateRenderVertices(renderer, vertexlen + indexlen, 0, &offset);
+        if (!ptr) return -1;
+        cmd->data.draw.first = offset | D3D_VERTICES_IN_QUEUE;
+        dst = (Uint16*)(ptr + vertexlen);
+        indexoffset = 0;
+    }
+
+    data->stats.vertex_bytes += (Uint32)(vertexlen + (indexed ? (size_t)num_indices * sizeof(Uint16) : 0));
+
+    header = (D3D_GeometryHeader*)ptr;
+    header->num_vertices = (Uint32)count;
+    header->num_indices = indexed ? (Uint32)num_indices : 0;
+    header->startindex = (Uint32)(indexoffset / sizeof(Uint16));
+    cmd->data.draw.count = indexed ? (size_t)num_indices : (size_t)count;
+
+    verts = (Vertex*)(ptr + sizeof(Vertex));
+    for (i = 0; i < count; i++, verts++) {
+        /* Without a 16-bit index buffer the triangles are expanded here. */
+        const int j = indexed ? i : GetGeometryIndex(indices, indices ? size_indices : 0, i);
+        const float* xy_ = (const float*)((const char*)xy + j * xy_stride);
+        const SDL_Color col_ = *(const SDL_Color*)((const char*)color + j * color_stride);
+
+        verts->x = xy_[0] * scale_x - 0.5f;
+        verts->y = xy_[1] * scale_y - 0.5f;
+        verts->z = 0.0f;
+        verts->color = D3DCOLOR_ARGB(col_.a, col_.r, col_.g, col_.b);
+
+        if (texture) {
+            const float* uv_ = (const float*)((const char*)uv + j * uv_stride);
+            verts->u = uv_[0] * su + ou;
+            verts->v = uv_[1] * sv + ov;
+        }
+        else {
+            verts->u = 0.0f;
+            verts->v = 0.0f;
+        }
+    }
 
-    if (!texture || !srcquad || !dstrect || dstrect->w <= 0.0f || dstrect->h <= 0.0f) {
-        cmd->data.draw.count = 0;
-        return 0;
+    if (indexed) {
+        for (i = 0; i < num_indices; i++) {
+            *dst++ = (Uint16)GetGeometryIndex(indices, size_indices, i);
+        }
     }
-    if (center) ctr = *center;
 
-    const size_t vertslen = sizeof(Vertex) * 5;
-    Vertex* verts = (Vertex*)SDL_AllocateRenderVertices(renderer, vertslen, 0, &cmd->data.draw.first);
-    if (!verts) return -1;
-    cmd->data.draw.count = 1;
+    return 0;
+}
 
-    const float w = dstrect->w * (scale_x != 0.0f ? scale_x : 1.0f);
-    const float h = dstrect->h * (scale_y != 0.0f ? scale_y : 1.0f);
 
-    minx = -ctr.x; maxx = w - ctr.x;
-    miny = -ctr.y; maxy = h - ctr.y;
+static void
+D3D_DrawRange(D3D_RenderData* data, const void* vertices, D3DPRIMITIVETYPE type, size_t first, size_t primcount)
+{
+    const UINT stride = (UINT)D3D_VertexStride(first);
 
-    minu = (float)srcquad->x + 0.5f;
-    maxu = (float)(srcquad->x + srcquad->w) - 0.5f;
-    minv = (float)srcquad->y + 0.5f;
-    maxv = (float)(srcquad->y + srcquad->h) - 0.5f;
+    if (first & D3D_VERTICES_IN_QUEUE) {
+        IDirect3DDevice8_DrawPrimitiveUP(data->device, type, (UINT)primcount, D3D_GetVertices(data, vertices, first), stride);
+        /* the UP call unbinds stream 0 */
+        data->vertexRingStride = 0;
+    }
+    else {
+        D3D_BindVertexRing(data, stride);
+        IDirect3DDevice8_DrawPrimitive(data->device, type, (UINT)((first & ~D3D_VERTEX_FLAGS) / stride), (UINT)primcount);
+    }
+    data->stats.draws++;
+}
 
-    if (flip & SDL_FLIP_HORIZONTAL) { float t = minu; minu = maxu; maxu = t; }
-    if (flip & SDL_FLIP_VERTICAL) { float t = minv; minv = maxv; maxv = t; }
+static void
+D3D_DrawIndexedRange(D3D_RenderData* data, const void* vertices, size_t first, const D3D_GeometryHeader* header)
+{
+    if (first & D3D_VERTICES_IN_QUEUE) {
+        const Vertex* verts = D3D_GetVertices(data, vertices, first);
+        const Uint16* indices = (const Uint16*)(verts + header->num_vertices);
+        IDirect3DDevice8_DrawIndexedPrimitiveUP(data->device, D3DPT_TRIANGLELIST, 0,
+            (UINT)header->num_vertices, (UINT)(header->num_indices / 3),
+            indices, D3DFMT_INDEX16, verts, sizeof(Vertex));
+        data->vertexRingStride = 0;
+    }
+    else {
+        D3D_BindVertexRing(data, sizeof(Vertex));
+        IDirect3DDevice8_SetIndices(data->device, data->indexRingBuffer, (UINT)(first / sizeof(Vertex)));
+        IDirect3DDevice8_DrawIndexedPrimitive(data->device, D3DPT_TRIANGLELIST, 0,
+            (UINT)header->num_vertices, (UINT)header->startindex, (UINT)(header->num_indices / 3));
+    }
+    data->stats.draws++;
+}
 
-    verts->x = minx; verts->y = miny; verts->z = 0.0f; verts->color = color; verts->u = minu; verts->v = minv; verts++;
-    verts->x = maxx; verts->y = miny; verts->z = 0.0f; verts->color = color; verts->u = maxu; verts->v = minv; verts++;
-    verts->x = maxx; verts->y = maxy; verts->z = 0.0f; verts->color = color; verts->u = maxu; verts->v = maxv; verts++;
-    verts->x = minx; verts->y = maxy; verts->z = 0.0f; verts->color = color; verts->u = minu; verts->v = maxv; verts++;
+/* Textures that bind the same GPU texture with the same filter: the same
+   texture, or entries of one atlas page. */
+static SDL_bool D3D_IsSameTextureState(SDL_Texture* a, SDL_Texture* b)
+{
+    const D3D_TextureData* adata;
+    const D3D_TextureData* bdata;
 
-    /* pack translation + rotation (radians) in the sentinel vertex like before */
-    verts->x = dstrect->x + ctr.x - 0.5f;
-    verts->y = dstrect->y + ctr.y - 0.5f;
-    verts->z = (float)(angle * (3.14159265358979323846 / 180.0)); /* avoid M_PI dependency */
-    verts->color = 0; verts->u = 0.0f; verts->v = 0.0f;
+    if (a == b) return SDL_TRUE;
+    if (!a || !b) return SDL_FALSE;
 
-    return 0;
+    adata = (const D3D_TextureData*)a->driverdata;
+    bdata = (const D3D_TextureData*)b->driverdata;
+    return (adata && bdata && adata->atlas && adata->atlas == bdata->atlas &&
+        adata->scaleMode == bdata->scaleMode) ? SDL_TRUE : SDL_FALSE;
 }
 
+static SDL_bool D3D_IsSameDrawColor(const SDL_RenderCommand* a, const SDL_RenderCommand* b)
+{
+    return (a->data.draw.r == b->data.draw.r && a->data.draw.g == b->data.draw.g &&
+        a->data.draw.b == b->data.draw.b && a->data.draw.a == b->data.draw.a) ? SDL_TRUE : SDL_FALSE;
+}
 
-static int
-D3D_RunCommandQueue(SDL_Renderer* renderer, SDL_RenderCommand* cmd, void* vertices, size_t vertsize)
+/* SETVIEWPORT/SETCLIPRECT commands that would not change the current state. */
+static SDL_bool D3D_IsRedundantStateCmd(const D3D_RenderData* data, const SDL_RenderCommand* cmd)
 {
-    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
-    const int vboidx = data->currentVertexBuffer;
-    LPDIRECT3DVERTEXBUFFER8 vbo = NULL;
-    const SDL_bool istarget = (renderer->target != NULL);
-    size_t i;
+    switch (cmd->command) {
+    case SDL_RENDERCMD_SETDRAWCOLOR:
+    case SDL_RENDERCMD_NO_OP:
+        return SDL_TRUE;
 
-    if (D3D_ActivateRenderer(renderer) < 0) return -1;
+    case SDL_RENDERCMD_SETVIEWPORT:
+        return (SDL_memcmp(&data->drawstate.viewport, &cmd->data.viewport.rect, sizeof(SDL_Rect)) == 0) ? SDL_TRUE : SDL_FALSE;
 
-    vbo = data->vertexBuffers[vboidx];
-    if (!vbo || (data->vertexBufferSize[vboidx] < vertsize)) {
-        const DWORD usage = D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY;
-        const DWORD fvf = D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1;
-        if (vbo) { IDirect3DVertexBuffer8_Release(vbo); vbo = NULL; }
-        if (vertsize > 0 && SUCCEEDED(IDirect3DDevice8_CreateVertexBuffer(data->device, (UINT)vertsize, usage, fvf, D3DPOOL_DEFAULT, &vbo))) {
-            data->vertexBuffers[vboidx] = vbo;
-            data->vertexBufferSize[vboidx] = vertsize;
-        }
-        else {
-            data->vertexBuffers[vboidx] = NULL;
-            data->vertexBufferSize[vboidx] = 0;
+    case SDL_RENDERCMD_SETCLIPRECT:
+        if (data->drawstate.cliprect_enabled != cmd->data.cliprect.enabled) {
+            return SDL_FALSE;
         }
-    }
+        return (SDL_memcmp(&data->drawstate.cliprect, &cmd->data.cliprect.rect, sizeof(SDL_Rect)) == 0) ? SDL_TRUE : SDL_FALSE;
 
-    if (vbo) {
-        void* ptr = NULL;
-        const DWORD lockFlags =
-#ifdef D3DLOCK_DISCARD
-            D3DLOCK_DISCARD
-#else
-            0
-#endif
-            ;
-        if (SUCCEEDED(IDirect3DVertexBuffer8_Lock(vbo, 0, (UINT)vertsize, (BYTE**)&ptr, lockFlags))) {
-            SDL_memcpy(ptr, vertices, vertsize);
-            if (FAILED(IDirect3DVertexBuffer8_Unlock(vbo))) vbo = NULL;
-        }
-        else {
-            vbo = NULL;
-        }
+    default:
+        return SDL_FALSE;
     }
+}
 
-    if (vbo) {
-        data->currentVertexBuffer++;
-        if (data->currentVertexBuffer >= SDL_arraysize(data->vertexBuffers)) data->currentVertexBuffer = 0;
-    }
-    else if (!data->reportedVboProblem) {
-        SDL_LogError(SDL_LOG_CATEGORY_RENDER, "SDL failed to get a vertex buffer for this Direct3D 8 rendering batch!");
-        SDL_LogError(SDL_LOG_CATEGORY_RENDER, "Dropping back to a slower method.");
-        SDL_LogError(SDL_LOG_CATEGORY_RENDER, "This might be a brief hiccup, but if performance is bad, this is probably why.");
-        SDL_LogError(SDL_LOG_CATEGORY_RENDER, "This error will not be logged again for this renderer.");
-        data->reportedVboProblem = SDL_TRUE;
-    }
+/* Issues the commands. 'vertices' is SDL's vertex array, for commands whose
+   vertices are not in the ring. */
+static int
+D3D_ExecuteCommands(SDL_Renderer* renderer, SDL_RenderCommand* cmd, void* vertices)
+{
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
+    const SDL_bool istarget = (renderer->target != NULL);
 
-    IDirect3DDevice8_SetVertexShader(data->device, D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1);
-    IDirect3DDevice8_SetStreamSource(data->device, 0, vbo, sizeof(Vertex));
+    IDirect3DDevice8_SetVertexShader(data->device, D3D_FVF_VERTEX);
+    data->vertexShader = D3D_FVF_VERTEX;
+    data->vertexRingStride = 0;
 
     while (cmd) {
         switch (cmd->command) {
@@ -1346,94 +3026,66 @@ D3D_RunCommandQueue(SDL_Renderer* renderer, SDL_RenderCommand* cmd, void* vertic
             break;
         }
 
-        case SDL_RENDERCMD_DRAW_POINTS: {
-            const size_t count = cmd->data.draw.count;
-            const size_t first = cmd->data.draw.first;
-            SetDrawState(data, cmd);
-            if (vbo) {
-                IDirect3DDevice8_DrawPrimitive(data->device, D3DPT_POINTLIST, (UINT)(first / sizeof(Vertex)), (UINT)count);
-            }
-            else {
-                const Vertex* verts = (const Vertex*)(((const Uint8*)vertices) + first);
-                IDirect3DDevice8_DrawPrimitiveUP(data->device, D3DPT_POINTLIST, (UINT)count, verts, sizeof(Vertex));
-            }
-            break;
-        }
-
-        case SDL_RENDERCMD_DRAW_LINES: {
-            const size_t count = cmd->data.draw.count;
+        case SDL_RENDERCMD_DRAW_POINTS:
+        case SDL_RENDERCMD_DRAW_LINES:
+        case SDL_RENDERCMD_FILL_RECTS:
+        case SDL_RENDERCMD_COPY:
+        case SDL_RENDERCMD_COPY_EX: {
+            /* Quads are queued as 4 vertices each (points and lines are expanded and CopyEx
+               rotated at queue time), so a whole run goes out as one QUADLIST. Fold in
+               following quad commands that use the same texture (or atlas page) and blend
+               mode; their vertices sit directly after ours in the vertex buffer, in the same
+               layout. Compact quads also need the same colour. Viewport and clip rect
+               commands in between are only skipped if they change nothing. */
             const size_t first = cmd->data.draw.first;
-            const Vertex* verts = (const Vertex*)(((const Uint8*)vertices) + first);
-            const SDL_bool close_endpoint = ((count == 2) || (verts[0].x != verts[count - 1].x) || (verts[0].y != verts[count - 1].y));
-            SetDrawState(data, cmd);
-            if (vbo) {
-                IDirect3DDevice8_DrawPrimitive(data->device, D3DPT_LINESTRIP, (UINT)(first / sizeof(Vertex)), (UINT)(count - 1));
-                if (close_endpoint) {
-                    IDirect3DDevice8_DrawPrimitive(data->device, D3DPT_POINTLIST, (UINT)((first / sizeof(Vertex)) + (count - 1)), 1);
+            size_t count = cmd->data.draw.count;
+            SDL_RenderCommand* finalcmd = cmd;
+            SDL_RenderCommand* nextcmd = cmd->next;
+
+            data->stats.commands++;
+            while (nextcmd) {
+                if (D3D_IsRedundantStateCmd(data, nextcmd)) {
+                    nextcmd = nextcmd->next;
+                    continue;
                 }
-            }
-            else {
-                IDirect3DDevice8_DrawPrimitiveUP(data->device, D3DPT_LINESTRIP, (UINT)(count - 1), verts, sizeof(Vertex));
-                if (close_endpoint) {
-                    IDirect3DDevice8_DrawPrimitiveUP(data->device, D3DPT_POINTLIST, 1, &verts[count - 1], sizeof(Vertex));
+                if ((nextcmd->command != SDL_RENDERCMD_DRAW_POINTS &&
+                     nextcmd->command != SDL_RENDERCMD_DRAW_LINES &&
+                     nextcmd->command != SDL_RENDERCMD_FILL_RECTS &&
+                     nextcmd->command != SDL_RENDERCMD_COPY &&
+                     nextcmd->command != SDL_RENDERCMD_COPY_EX) ||
+                    !D3D_IsSameTextureState(nextcmd->data.draw.texture, cmd->data.draw.texture) ||
+                    nextcmd->data.draw.blend != cmd->data.draw.blend ||
+                    nextcmd->data.draw.first != first + count * 4 * D3D_VertexStride(first) ||
+                    ((first & D3D_VERTICES_COMPACT) && !D3D_IsSameDrawColor(nextcmd, cmd))) {
+                    break;
                 }
+                count += nextcmd->data.draw.count;
+                data->stats.commands++;
+                finalcmd = nextcmd;
+                nextcmd = nextcmd->next;
             }
-            break;
-        }
 
-        case SDL_RENDERCMD_FILL_RECTS: {
-            const size_t count = cmd->data.draw.count;
-            const size_t first = cmd->data.draw.first;
             SetDrawState(data, cmd);
-            if (vbo) {
-                size_t offset = 0;
-                for (i = 0; i < count; ++i, offset += 4) {
-                    IDirect3DDevice8_DrawPrimitive(data->device, D3DPT_TRIANGLEFAN, (UINT)((first / sizeof(Vertex)) + offset), 2);
-                }
-            }
-            else {
-                const Vertex* verts = (const Vertex*)(((const Uint8*)vertices) + first);
-                for (i = 0; i < count; ++i, verts += 4) {
-                    IDirect3DDevice8_DrawPrimitiveUP(data->device, D3DPT_TRIANGLEFAN, 2, verts, sizeof(Vertex));
-                }
+            if (count > 0) {
+                D3D_DrawRange(data, vertices, D3DPT_QUADLIST, first, count);
             }
+            cmd = finalcmd;
             break;
         }
 
-        case SDL_RENDERCMD_COPY: {
-            const size_t count = cmd->data.draw.count;
+        case SDL_RENDERCMD_GEOMETRY: {
             const size_t first = cmd->data.draw.first;
-            SetDrawState(data, cmd);
-            if (vbo) {
-                size_t offset = 0;
-                for (i = 0; i < count; ++i, offset += 4) {
-                    IDirect3DDevice8_DrawPrimitive(data->device, D3DPT_TRIANGLEFAN, (UINT)((first / sizeof(Vertex)) + offset), 2);
-                }
-            }
-            else {
-                const Vertex* verts = (const Vertex*)(((const Uint8*)vertices) + first);
-                for (i = 0; i < count; ++i, verts += 4) {
-                    IDirect3DDevice8_DrawPrimitiveUP(data->device, D3DPT_TRIANGLEFAN, 2, verts, sizeof(Vertex));
-                }
+            const D3D_GeometryHeader* header = (const D3D_GeometryHeader*)D3D_GetVertices(data, vertices, first);
+            if (cmd->data.draw.count == 0) {
+                break;
             }
-            break;
-        }
-
-        case SDL_RENDERCMD_COPY_EX: {
-            const size_t first = cmd->data.draw.first;
-            const Vertex* verts = (const Vertex*)(((const Uint8*)vertices) + first);
-            const Vertex* transvert = verts + 4;
-            const float translatex = transvert->x;
-            const float translatey = transvert->y;
-            const float rotation = transvert->z;
-            const Float4X4 d3dmatrix = MatrixMultiply(MatrixRotationZ(rotation), MatrixTranslation(translatex, translatey, 0.0f));
+            data->stats.commands++;
             SetDrawState(data, cmd);
-            IDirect3DDevice8_SetTransform(data->device, D3DTS_VIEW, (const D3DMATRIX*)&d3dmatrix);
-            if (vbo) {
-                IDirect3DDevice8_DrawPrimitive(data->device, D3DPT_TRIANGLEFAN, (UINT)(first / sizeof(Vertex)), 2);
+            if (header->num_indices == 0) {
+                D3D_DrawRange(data, vertices, D3DPT_TRIANGLELIST, first + sizeof(Vertex), header->num_vertices / 3);
             }
             else {
-                IDirect3DDevice8_DrawPrimitiveUP(data->device, D3DPT_TRIANGLEFAN, 2, verts, sizeof(Vertex));
+                D3D_DrawIndexedRange(data, vertices, first + sizeof(Vertex), header);
             }
             break;
         }
@@ -1448,52 +3100,361 @@ D3D_RunCommandQueue(SDL_Renderer* renderer, SDL_RenderCommand* cmd, void* vertic
     return 0;
 }
 
-/* ----------------------------- ReadPixels -------------------------------- */
+/* Collects the textures the draws of a queue use into 'segment' and pins
+   them: a push buffer refers to their GPU copies, which must not be evicted
+   while the segment lives. Sets *streaming if one of them is a streaming
+   texture. */
+static int D3D_CollectSegmentTextures(D3D_DisplayListSegment* segment, const SDL_RenderCommand* cmd, SDL_bool* streaming)
+{
+    for (; cmd; cmd = cmd->next) {
+        D3D_TextureRep** reps;
+        D3D_TextureRep* rep;
+        int i;
+
+        switch (cmd->command) {
+        case SDL_RENDERCMD_DRAW_POINTS:
+        case SDL_RENDERCMD_DRAW_LINES:
+        case SDL_RENDERCMD_FILL_RECTS:
+        case SDL_RENDERCMD_COPY:
+        case SDL_RENDERCMD_COPY_EX:
+        case SDL_RENDERCMD_GEOMETRY:
+            break;
+        default:
+            continue;
+        }
+        if (!cmd->data.draw.texture || !cmd->data.draw.texture->driverdata) {
+            continue;
+        }
+
+        rep = D3D_GetTextureDataRep((D3D_TextureData*)cmd->data.draw.texture->driverdata, NULL, NULL);
+        if (rep->numstreaming > 0) {
+            *streaming = SDL_TRUE;
+        }
+        for (i = 0; i < segment->numreps; ++i) {
+            if (segment->reps[i] == rep) break;
+        }
+        if (i < segment->numreps) {
+            continue;
+        }
+
+        reps = (D3D_TextureRep**)SDL_realloc(segment->reps, (segment->numreps + 1) * sizeof(*reps));
+        if (!reps) return SDL_OutOfMemory();
+        reps[segment->numreps++] = rep;
+        segment->reps = reps;
+        rep->pins++;
+    }
+    return 0;
+}
+
+static void D3D_FreeSegmentTextures(D3D_DisplayListSegment* segment)
+{
+    int i;
+
+    for (i = 0; i < segment->numreps; ++i) {
+        segment->reps[i]->pins--;
+    }
+    SDL_free(segment->reps);
+    segment->reps = NULL;
+    segment->numreps = 0;
+}
+
+/* Uploads what the CPU changed in the textures of a segment. Uploads can't be
+   recorded into a push buffer, and a replay draws the textures as they are
+   when it runs. */
+static int D3D_UpdateSegmentTextures(D3D_RenderData* data, const D3D_DisplayListSegment* segment)
+{
+    int i;
 
+    for (i = 0; i < segment->numreps; ++i) {
+        if (UpdateDirtyTexture(data, segment->reps[i]) < 0) return -1;
+    }
+    return 0;
+}
+
+/* Records one flush into the open display list. The draws go into a push
+   buffer with their vertices inline, preceded by all the state they need, so
+   the segment replays the same way whatever was bound before. */
 static int
-D3D_RenderReadPixels(SDL_Renderer* renderer, const SDL_Rect* rect,
-    Uint32 format, void* pixels, int pitch)
+D3D_RecordCommandQueue(SDL_Renderer* renderer, SDL_RenderCommand* cmd, void* vertices, size_t vertsize)
 {
     D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
-    IDirect3DSurface8* srcRT = NULL;
-    IDirect3DSurface8* sysmemSurf = NULL;
-    D3DSURFACE_DESC desc;
-    RECT d3drect;
-    D3DLOCKED_RECT locked;
+    SDL_XboxDisplayList* list = data->recording;
+    D3D_DisplayListSegment* segment;
+    const SDL_XboxRenderStats stats = data->stats;
+    const SDL_RenderCommand* c;
+    size_t size = 4096 + 2 * vertsize;
+    int numcmds = 0;
+    SDL_bool streaming = SDL_FALSE;
+
+    if (!cmd) return 0;
+
+    segment = (D3D_DisplayListSegment*)SDL_realloc(list->segments, (list->numsegments + 1) * sizeof(*segment));
+    if (!segment) return SDL_OutOfMemory();
+    list->segments = segment;
+    segment += list->numsegments;
+    SDL_zerop(segment);
+
+    for (c = cmd; c; c = c->next) {
+        size += 256; /* state changes and draw headers */
+        ++numcmds;
+    }
+
+    if (D3D_CollectSegmentTextures(segment, cmd, &streaming) < 0 ||
+        D3D_UpdateSegmentTextures(data, segment) < 0) {
+        D3D_FreeSegmentTextures(segment);
+        return -1;
+    }
+
+    /* A push buffer would keep drawing the streaming buffer current now,
+       which a later lock can hand to the CPU while a replay reads it. */
+    if (!streaming && SUCCEEDED(IDirect3DDevice8_CreatePushBuffer(data->device, (UINT)size, FALSE, &segment->pushbuffer))) {
+        int result;
+        HRESULT hr;
+
+        IDirect3DDevice8_BeginPushBuffer(data->device, segment->pushbuffer);
+        D3D_InvalidateDrawState(data);
+        result = D3D_ExecuteCommands(renderer, cmd, vertices);
+        hr = IDirect3DDevice8_EndPushBuffer(data->device);
+
+        /* none of the recorded state reached the device */
+        D3D_InvalidateDrawState(data);
+
+        segment->commands = data->stats.commands - stats.commands;
+        segment->draws = data->stats.draws - stats.draws;
+        data->stats.commands = stats.commands;
+        data->stats.draws = stats.draws;
+
+        if (result < 0 || FAILED(hr)) {
+            IDirect3DPushBuffer8_Release(segment->pushbuffer);
+            segment->pushbuffer = NULL;
+        }
+    }
+
+    if (!segment->pushbuffer) {
+        int i;
+
+        segment->cmds = (SDL_RenderCommand*)SDL_malloc(numcmds * sizeof(SDL_RenderCommand));
+        segment->vertices = SDL_malloc(vertsize ? vertsize : 1);
+        if (!segment->cmds || !segment->vertices) {
+            SDL_free(segment->cmds);
+            SDL_free(segment->vertices);
+            D3D_FreeSegmentTextures(segment);
+            return SDL_OutOfMemory();
+        }
+        for (c = cmd, i = 0; c; c = c->next, ++i) {
+            segment->cmds[i] = *c;
+            segment->cmds[i].next = (i + 1 < numcmds) ? &segment->cmds[i + 1] : NULL;
+        }
+        SDL_memcpy(segment->vertices, vertices, vertsize);
+        segment->vertsize = vertsize;
+    }
+
+    list->numsegments++;
+    return 0;
+}
+
+static int
+D3D_RunCommandQueue(SDL_Renderer* renderer, SDL_RenderCommand* cmd, void* vertices, size_t vertsize)
+{
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
+    DWORD fence;
+    int result;
+
+    /* The queue is empty afterwards, so the next quad has nothing to join. */
+    data->quadTexture = NULL;
+    data->quadBlend = SDL_BLENDMODE_INVALID;
+
+    if (D3D_ActivateRenderer(renderer) < 0) return -1;
+
+    if (data->recording) {
+        return D3D_RecordCommandQueue(renderer, cmd, vertices, vertsize);
+    }
+
+    result = D3D_ExecuteCommands(renderer, cmd, vertices);
+
+    /* The GPU reads the ring chunks of this batch until the fence passes. */
+    if (data->vertexRing.queued || data->indexRing.queued) {
+        fence = IDirect3DDevice8_InsertFence(data->device);
+        D3D_RingFence(&data->vertexRing, fence);
+        D3D_RingFence(&data->indexRing, fence);
+    }
+    return result;
+}
+
+static int D3D_RunDisplayList(SDL_Renderer* renderer, SDL_XboxDisplayList* list)
+{
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
+    int i;
+
+    /* A reset recreated the textures its push buffers point at. */
+    if (list->resets != data->resets) {
+        return SDL_SetError("The display list was recorded before the device was reset");
+    }
+
+    for (i = 0; i < list->numsegments; ++i) {
+        D3D_DisplayListSegment* segment = &list->segments[i];
+
+        if (segment->pushbuffer) {
+            if (D3D_ActivateRenderer(renderer) < 0) return -1;
+            if (D3D_UpdateSegmentTextures(data, segment) < 0) return -1;
+            IDirect3DDevice8_RunPushBuffer(data->device, segment->pushbuffer, NULL);
+            /* the push buffer left its own state behind */
+            D3D_InvalidateDrawState(data);
+            data->stats.commands += segment->commands;
+            data->stats.draws += segment->draws;
+        }
+        else if (D3D_RunCommandQueue(renderer, segment->cmds, segment->vertices, segment->vertsize) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void D3D_DestroyDisplayList(SDL_XboxDisplayList* list)
+{
+    const D3D_RenderData* data = (const D3D_RenderData*)list->renderer->driverdata;
+    int i;
+
+    for (i = 0; i < list->numsegments; ++i) {
+        D3D_DisplayListSegment* segment = &list->segments[i];
+        if (segment->pushbuffer) {
+            IDirect3DPushBuffer8_Release(segment->pushbuffer);
+        }
+        SDL_free(segment->cmds);
+        SDL_free(segment->vertices);
+        /* D3D_Reset() dropped the pins of a stale list, and may have freed
+           the textures they were on */
+        if (data && list->resets == data->resets) {
+            D3D_FreeSegmentTextures(segment);
+        }
+        else {
+            SDL_free(segment->reps);
+        }
+    }
+    SDL_free(list->segments);
+    SDL_free(list);
+}
+
+/* ----------------------------- ReadPixels -------------------------------- */
+
+/* Returns an image surface of at least w x h in 'format', reusing *surface
+   when it is large enough. */
+static int D3D_GetReadbackSurface(D3D_RenderData* data, IDirect3DSurface8** surface, int w, int h, D3DFORMAT format)
+{
     HRESULT hr;
 
-    if (!renderer || !rect || !pixels) return SDL_SetError("D3D_RenderReadPixels: invalid args");
+    if (*surface) {
+        D3DSURFACE_DESC desc;
+        if (SUCCEEDED(IDirect3DSurface8_GetDesc(*surface, &desc)) &&
+            (int)desc.Width >= w && (int)desc.Height >= h && desc.Format == format) {
+            return 0;
+        }
+        IDirect3DSurface8_Release(*surface);
+        *surface = NULL;
+    }
+
+    hr = IDirect3DDevice8_CreateImageSurface(data->device, w, h, format, surface);
+    if (FAILED(hr)) return D3D_SetError("CreateImageSurface()", hr);
+    return 0;
+}
+
+/* Queues a GPU copy of 'rect' of the current render target into the top-left
+   corner of 'surface'. 'rect' is clipped to the target. */
+static int D3D_CopyRenderTarget(D3D_RenderData* data, SDL_Rect* rect, IDirect3DSurface8** surface, D3DFORMAT* format)
+{
+    IDirect3DSurface8* srcRT;
+    D3DSURFACE_DESC desc;
+    RECT srcrect;
+    POINT origin = { 0, 0 };
+    SDL_Rect bounds;
+    HRESULT hr;
 
     srcRT = data->currentRenderTarget ? data->currentRenderTarget : data->defaultRenderTarget;
     if (!srcRT) return SDL_SetError("D3D_RenderReadPixels: no render target");
 
-    IDirect3DSurface8_AddRef(srcRT);
-
     hr = IDirect3DSurface8_GetDesc(srcRT, &desc);
-    if (FAILED(hr)) { IDirect3DSurface8_Release(srcRT); return D3D_SetError("GetDesc()", hr); }
+    if (FAILED(hr)) return D3D_SetError("GetDesc()", hr);
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = (int)desc.Width;
+    bounds.h = (int)desc.Height;
+    if (!SDL_IntersectRect(rect, &bounds, rect)) {
+        return SDL_SetError("D3D_RenderReadPixels: rect is outside the render target");
+    }
 
-    hr = IDirect3DDevice8_CreateImageSurface(data->device, desc.Width, desc.Height, desc.Format, &sysmemSurf);
-    if (FAILED(hr)) { IDirect3DSurface8_Release(srcRT); return D3D_SetError("CreateImageSurface()", hr); }
+    if (D3D_GetReadbackSurface(data, surface, rect->w, rect->h, desc.Format) < 0) return -1;
+
+    srcrect.left = rect->x;
+    srcrect.top = rect->y;
+    srcrect.right = rect->x + rect->w;
+    srcrect.bottom = rect->y + rect->h;
+
+    hr = IDirect3DDevice8_CopyRects(data->device, srcRT, &srcrect, 1, *surface, &origin);
+    if (FAILED(hr)) return D3D_SetError("CopyRects()", hr);
+
+    *format = desc.Format;
+    return 0;
+}
 
-    hr = IDirect3DDevice8_CopyRects(data->device, srcRT, NULL, 0, sysmemSurf, NULL);
-    IDirect3DSurface8_Release(srcRT);
-    if (FAILED(hr)) { IDirect3DSurface8_Release(sysmemSurf); return D3D_SetError("CopyRects()", hr); }
+/* Converts the top-left w x h of a readback surface into 'pixels'. */
+static int D3D_ConvertReadback(IDirect3DSurface8* surface, D3DFORMAT d3dfmt, int w, int h,
+    Uint32 format, void* pixels, int pitch)
+{
+    RECT d3drect;
+    D3DLOCKED_RECT locked;
+    HRESULT hr;
+    int status;
 
-    d3drect.left = rect->x;
-    d3drect.top = rect->y;
-    d3drect.right = rect->x + rect->w;
-    d3drect.bottom = rect->y + rect->h;
+    d3drect.left = 0;
+    d3drect.top = 0;
+    d3drect.right = w;
+    d3drect.bottom = h;
 
-    hr = IDirect3DSurface8_LockRect(sysmemSurf, &locked, &d3drect, D3DLOCK_READONLY);
-    if (FAILED(hr)) { IDirect3DSurface8_Release(sysmemSurf); return D3D_SetError("LockRect()", hr); }
+    hr = IDirect3DSurface8_LockRect(surface, &locked, &d3drect, D3DLOCK_READONLY);
+    if (FAILED(hr)) return D3D_SetError("LockRect()", hr);
 
-    SDL_ConvertPixels(rect->w, rect->h,
-        D3DFMTToPixelFormat(desc.Format), locked.pBits, locked.Pitch,
+    status = SDL_ConvertPixels(w, h,
+        D3DFMTToPixelFormat(d3dfmt), locked.pBits, locked.Pitch,
         format, pixels, pitch);
 
-    IDirect3DSurface8_UnlockRect(sysmemSurf);
-    IDirect3DSurface8_Release(sysmemSurf);
-    return 0;
+    IDirect3DSurface8_UnlockRect(surface);
+    return status;
+}
+
+static int
+D3D_RenderReadPixels(SDL_Renderer* renderer, const SDL_Rect* rect,
+    Uint32 format, void* pixels, int pitch)
+{
+    D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
+    SDL_Rect r;
+    D3DFORMAT d3dfmt;
+
+    if (!renderer || !rect || !pixels) return SDL_SetError("D3D_RenderReadPixels: invalid args");
+
+    /* Only the requested rect is copied, into a surface kept across calls. */
+    r = *rect;
+    if (D3D_CopyRenderTarget(data, &r, &data->readbackSurface, &d3dfmt) < 0) return -1;
+
+    return D3D_ConvertReadback(data->readbackSurface, d3dfmt, r.w, r.h, format, pixels, pitch);
+}
+
+static void D3D_ReleaseReadbacks(D3D_RenderData* data)
+{
+    int i;
+
+    if (data->readbackSurface) {
+        IDirect3DSurface8_Release(data->readbackSurface);
+        data->readbackSurface = NULL;
+    }
+    for (i = 0; i < D3D_MAX_READBACKS; ++i) {
+        if (data->readbacks[i].surface) {
+            IDirect3DSurface8_Release(data->readbacks[i].surface);
+            data->readbacks[i].surface = NULL;
+        }
+    }
+    data->firstReadback = 0;
+    data->numReadbacks = 0;
 }
 
 /* ------------------------------- Present --------------------------------- */
@@ -1527,20 +3488,8 @@ static int D3D_SetRenderTargetInternal(SDL_Renderer* renderer, SDL_Texture* text
         }
 
         texturerep = &texturedata->texture;
-        if (texturerep->dirty && texturerep->staging) {
-            if (!texturerep->texture) {
-                hr = IDirect3DDevice8_CreateTexture(device, texturerep->w, texturerep->h, 1,
-                    texturerep->usage, texturerep->d3dfmt,
-                    D3DPOOL_DEFAULT, &texturerep->texture);
-                if (FAILED(hr)) {
-                    return D3D_SetError("CreateTexture(D3DPOOL_DEFAULT)", hr);
-                }
-            }
-            hr = D3D8_UpdateTexture(texturerep->staging, texturerep->texture);
-            if (FAILED(hr)) {
-                return D3D_SetError("UpdateTexture()", hr);
-            }
-            texturerep->dirty = SDL_FALSE;
+        if (UpdateDirtyTexture(data, texturerep) < 0) {
+            return -1;
         }
 
         hr = IDirect3DTexture8_GetSurfaceLevel(texturedata->texture.texture, 0, &data->currentRenderTarget);
@@ -1556,14 +3505,102 @@ static int D3D_SetRenderTargetInternal(SDL_Renderer* renderer, SDL_Texture* text
         }
     }
 
-    return 0;
-}
+    return 0;
+}
+
+
+static int D3D_SetRenderTarget(SDL_Renderer* renderer, SDL_Texture* texture)
+{
+    if (D3D_ActivateRenderer(renderer) < 0) return -1;
+    return D3D_SetRenderTargetInternal(renderer, texture);
+}
+
+#define D3D_OVERLAY_BARS 6
+
+static Vertex* D3D_AddOverlayQuad(Vertex* verts, float x, float y, float w, float h, DWORD color)
+{
+    verts = (Vertex*)D3D_PutQuadVertex(verts, SDL_FALSE, x, y, color, 0.0f, 0.0f);
+    verts = (Vertex*)D3D_PutQuadVertex(verts, SDL_FALSE, x + w, y, color, 0.0f, 0.0f);
+    verts = (Vertex*)D3D_PutQuadVertex(verts, SDL_FALSE, x + w, y + h, color, 0.0f, 0.0f);
+    return (Vertex*)D3D_PutQuadVertex(verts, SDL_FALSE, x, y + h, color, 0.0f, 0.0f);
+}
+
+/* Bar graph of the frame's counters, drawn straight to the device at the end
+   of the frame. From the top: GPU time (256 pixels per refresh period, red
+   when over), draws, commands, states issued, KB of texture uploads and KB
+   of vertices, one pixel per unit. */
+static void D3D_DrawStatsOverlay(D3D_RenderData* data)
+{
+    const SDL_XboxRenderStats* stats = &data->stats;
+    const UINT backw = data->pparams.BackBufferWidth;
+    const UINT backh = data->pparams.BackBufferHeight;
+    const float x = (float)(backw / 16);
+    const float y = (float)(backh / 16);
+    const float maxw = 512.0f;
+    const Uint32 hz = data->pparams.FullScreen_RefreshRateInHz ? data->pparams.FullScreen_RefreshRateInHz : 60;
+    const Uint32 period = 1000000 / hz;
+    const Uint32 gpu = D3D_TicksToMicroseconds(data, data->gpuBusy);
+    const float values[D3D_OVERLAY_BARS] = {
+        (float)gpu * 256.0f / (float)period,
+        (float)stats->draws,
+        (float)stats->commands,
+        (float)stats->states_issued,
+        (float)(stats->upload_bytes / 1024),
+        (float)(stats->vertex_bytes / 1024)
+    };
+    const DWORD colors[D3D_OVERLAY_BARS] = {
+        (gpu > period) ? D3DCOLOR_ARGB(255, 255, 64, 64) : D3DCOLOR_ARGB(255, 64, 255, 64),
+        D3DCOLOR_ARGB(255, 64, 128, 255),
+        D3DCOLOR_ARGB(255, 192, 192, 192),
+        D3DCOLOR_ARGB(255, 255, 255, 64),
+        D3DCOLOR_ARGB(255, 255, 64, 255),
+        D3DCOLOR_ARGB(255, 64, 255, 255)
+    };
+    Vertex verts[4 * (D3D_OVERLAY_BARS + 2)];
+    Vertex* v = verts;
+    D3DMATRIX proj;
+    int i;
+
+    v = D3D_AddOverlayQuad(v, x - 4.0f, y - 4.0f, maxw + 8.0f, D3D_OVERLAY_BARS * 8.0f + 6.0f, D3DCOLOR_ARGB(160, 0, 0, 0));
+    for (i = 0; i < D3D_OVERLAY_BARS; ++i) {
+        v = D3D_AddOverlayQuad(v, x, y + i * 8.0f, SDL_min(values[i], maxw), 6.0f, colors[i]);
+    }
+    /* one refresh period on the GPU bar */
+    v = D3D_AddOverlayQuad(v, x + 256.0f, y - 2.0f, 1.0f, 10.0f, D3DCOLOR_ARGB(255, 255, 255, 255));
+
+    {
+        const D3DVIEWPORT8 whole = (D3DVIEWPORT8){ 0, 0, (DWORD)backw, (DWORD)backh, 0.0f, 1.0f };
+        IDirect3DDevice8_SetViewport(data->device, &whole);
+    }
+    SDL_zero(proj);
+    proj.m[0][0] = 2.0f / (float)backw;
+    proj.m[1][1] = -2.0f / (float)backh;
+    proj.m[2][2] = 1.0f;
+    proj.m[3][0] = -1.0f;
+    proj.m[3][1] = 1.0f;
+    proj.m[3][3] = 1.0f;
+    IDirect3DDevice8_SetTransform(data->device, D3DTS_PROJECTION, &proj);
+    IDirect3DDevice8_SetScissors(data->device, 0, FALSE, NULL);
+
+    D3D_SetTexture(data, 0, NULL);
+    D3D_SetRenderState(data, D3DRS_ALPHABLENDENABLE, TRUE);
+    D3D_SetRenderState(data, D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
+    D3D_SetRenderState(data, D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
+    D3D_SetTextureStageState(data, 0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
+    D3D_SetTextureStageState(data, 0, D3DTSS_ALPHAARG2, D3DTA_DIFFUSE);
+    if (data->vertexShader != D3D_FVF_VERTEX) {
+        IDirect3DDevice8_SetVertexShader(data->device, D3D_FVF_VERTEX);
+        data->vertexShader = D3D_FVF_VERTEX;
+    }
 
+    IDirect3DDevice8_DrawPrimitiveUP(data->device, D3DPT_QUADLIST, (UINT)((v - verts) / 4), verts, sizeof(Vertex));
+    data->vertexRingStride = 0;
 
-static int D3D_SetRenderTarget(SDL_Renderer* renderer, SDL_Texture* texture)
-{
-    if (D3D_ActivateRenderer(renderer) < 0) return -1;
-    return D3D_SetRenderTargetInternal(renderer, texture);
+    data->drawstate.texture = NULL;
+    data->drawstate.blend = SDL_BLENDMODE_INVALID;
+    data->drawstate.viewport_dirty = SDL_TRUE;
+    data->drawstate.cliprect_enabled_dirty = SDL_TRUE;
+    data->drawstate.cliprect_dirty = SDL_TRUE;
 }
 
 static int D3D_RenderPresent(SDL_Renderer* renderer)
@@ -1571,6 +3608,13 @@ static int D3D_RenderPresent(SDL_Renderer* renderer)
     D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
     HRESULT hr;
 
+    /* The overlay shows the frame's counters without adding its own. */
+    if (data->statsOverlay && !data->beginScene && !data->recording && renderer->target == NULL) {
+        const SDL_XboxRenderStats stats = data->stats;
+        D3D_DrawStatsOverlay(data);
+        data->stats = stats;
+    }
+
     if (!data->beginScene) {
         hr = IDirect3DDevice8_EndScene(data->device);
         if (FAILED(hr)) {
@@ -1583,9 +3627,29 @@ static int D3D_RenderPresent(SDL_Renderer* renderer)
 
     if (renderer->target != NULL) return 0;
 
-    hr = IDirect3DDevice8_Present(data->device, NULL, NULL, NULL, NULL);
+    data->laststats = data->stats;
+    SDL_zero(data->stats);
+
+    D3D_MarkFrameEnd(data);
+
+    {
+        LARGE_INTEGER before, after;
+        QueryPerformanceCounter(&before);
+        hr = IDirect3DDevice8_Present(data->device, NULL, NULL, NULL, NULL);
+        QueryPerformanceCounter(&after);
+        data->presentWait = (Uint32)(after.LowPart - before.LowPart);
+    }
     if (FAILED(hr)) { D3D_SetError("Present()", hr); return -1; }
 
+    D3D_UpdatePresentTiming(data);
+    D3D_UpdateGPUBusy(data);
+    data->laststats.gpu_time_us = D3D_TicksToMicroseconds(data, data->gpuBusy);
+
+    /* Textures restored during the frame may have pushed usage over. */
+    if (data->textureBudget) {
+        D3D_EvictTextures(renderer, data->textureBudget);
+    }
+
     data->drawstate.cliprect_enabled_dirty = SDL_TRUE;
     data->drawstate.cliprect_dirty = SDL_TRUE;
 
@@ -1607,25 +3671,27 @@ static void D3D_DestroyTexture(SDL_Renderer* renderer, SDL_Texture* texture)
     }
 
     if (renderdata) {
-        if (renderdata->drawstate.texture == texture) {
-            IDirect3DDevice8_SetTexture(renderdata->device, 0, NULL);
-            renderdata->drawstate.texture = NULL;
-        }
-        if (data && data->yuv) {
-            IDirect3DDevice8_SetTexture(renderdata->device, 1, NULL);
-            IDirect3DDevice8_SetTexture(renderdata->device, 2, NULL);
-            IDirect3DDevice8_SetTextureStageState(renderdata->device, 1, D3DTSS_COLOROP, D3DTOP_DISABLE);
-            IDirect3DDevice8_SetTextureStageState(renderdata->device, 1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
-            IDirect3DDevice8_SetTextureStageState(renderdata->device, 2, D3DTSS_COLOROP, D3DTOP_DISABLE);
-            IDirect3DDevice8_SetTextureStageState(renderdata->device, 2, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+        /* Stage 0 may still hold one of this texture's streaming buffers even
+           when drawstate moved on, and a later texture can reuse the address,
+           so always unbind rather than leave a stale pointer in the shadow. */
+        if (renderdata->device) {
+            D3D_SetTexture(renderdata, 0, NULL);
         }
+        renderdata->drawstate.texture = NULL;
     }
 
     if (!data) { texture->driverdata = NULL; return; }
 
-    D3D_DestroyTextureRep(&data->texture);
-    D3D_DestroyTextureRep(&data->utexture);
-    D3D_DestroyTextureRep(&data->vtexture);
+    if (data->atlas) {
+        D3D_FreeAtlasEntry(renderdata, data);
+    }
+    else if (renderdata && data->texture.usage == D3DUSAGE_RENDERTARGET) {
+        D3D_ReleaseTargetTextureRep(renderdata, &data->texture);
+    }
+    else {
+        D3D_DestroyTextureRep(&data->texture);
+    }
+    D3D_DestroyTexturePalettes(data);
     SDL_free(data->pixels);
     SDL_free(data);
     texture->driverdata = NULL;
@@ -1638,34 +3704,44 @@ static void D3D_DestroyRenderer(SDL_Renderer* renderer)
     D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
 
     if (data) {
-        int i;
-
         if (!data->beginScene && data->device) {
             IDirect3DDevice8_EndScene(data->device);
             data->beginScene = SDL_TRUE;
         }
 
         if (data->device) {
-            IDirect3DDevice8_SetTexture(data->device, 0, NULL);
-            IDirect3DDevice8_SetTexture(data->device, 1, NULL);
-            IDirect3DDevice8_SetTexture(data->device, 2, NULL);
-            IDirect3DDevice8_SetTextureStageState(data->device, 1, D3DTSS_COLOROP, D3DTOP_DISABLE);
-            IDirect3DDevice8_SetTextureStageState(data->device, 1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
-            IDirect3DDevice8_SetTextureStageState(data->device, 2, D3DTSS_COLOROP, D3DTOP_DISABLE);
-            IDirect3DDevice8_SetTextureStageState(data->device, 2, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+            D3D_SetTexture(data, 0, NULL);
+            D3D_SetTexture(data, 1, NULL);
+            D3D_SetTexture(data, 2, NULL);
+            D3D_SetTextureStageState(data, 1, D3DTSS_COLOROP, D3DTOP_DISABLE);
+            D3D_SetTextureStageState(data, 1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+            D3D_SetTextureStageState(data, 2, D3DTSS_COLOROP, D3DTOP_DISABLE);
+            D3D_SetTextureStageState(data, 2, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
         }
 
         if (data->currentRenderTarget) { IDirect3DSurface8_Release(data->currentRenderTarget); data->currentRenderTarget = NULL; }
         if (data->defaultRenderTarget) { IDirect3DSurface8_Release(data->defaultRenderTarget); data->defaultRenderTarget = NULL; }
+        D3D_ReleaseReadbacks(data);
 
-        for (i = 0; i < (int)SDL_arraysize(data->vertexBuffers); ++i) {
-            if (data->vertexBuffers[i]) {
-                IDirect3DVertexBuffer8_Release(data->vertexBuffers[i]);
-                data->vertexBuffers[i] = NULL;
-            }
-            data->vertexBufferSize[i] = 0;
+        if (data->recording) {
+            D3D_DestroyDisplayList(data->recording);
+            data->recording = NULL;
+        }
+
+        while (data->atlases) {
+            D3D_AtlasPage* page = data->atlases;
+            data->atlases = page->next;
+            D3D_DestroyTextureRep(&page->texture);
+            SDL_free(page);
+        }
+
+        D3D_ReleaseRings(data);
+        D3D_TrimTargetPool(data, 0);
+        SDL_free(data->targetPool);
+        if (data->compactShader) {
+            IDirect3DDevice8_DeleteVertexShader(data->device, data->compactShader);
+            data->compactShader = 0;
         }
-        data->currentVertexBuffer = 0;
 
         if (data->device) { IDirect3DDevice8_Release(data->device); data->device = NULL; }
         if (data->d3d) { IDirect3D8_Release(data->d3d);         data->d3d = NULL; }
@@ -1683,13 +3759,31 @@ static int D3D_Reset(SDL_Renderer* renderer)
 {
     D3D_RenderData* data = (D3D_RenderData*)renderer->driverdata;
     const Float4X4 viewIdent = MatrixIdentity();
+    const size_t poollimit = data->targetPoolLimit;
     HRESULT result;
     SDL_Texture* texture;
-    int i;
+    D3D_AtlasPage* page;
 
     if (data->currentRenderTarget) { IDirect3DSurface8_Release(data->currentRenderTarget); data->currentRenderTarget = NULL; }
     if (data->defaultRenderTarget) { IDirect3DSurface8_Release(data->defaultRenderTarget); data->defaultRenderTarget = NULL; }
+    D3D_ReleaseReadbacks(data);
+
+    /* Every display list recorded so far is stale from here on, so nothing
+       pins the textures any more. */
+    data->resets++;
+    for (texture = renderer->textures; texture; texture = texture->next) {
+        D3D_TextureData* texturedata = (D3D_TextureData*)texture->driverdata;
+        if (texturedata) {
+            texturedata->texture.pins = 0;
+        }
+    }
+    for (page = data->atlases; page; page = page->next) {
+        page->texture.pins = 0;
+    }
 
+    /* Target textures are parked in the pool, whatever its limit, and taken
+       back out when they are recreated below. */
+    data->targetPoolLimit = (size_t)-1;
     for (texture = renderer->textures; texture; texture = texture->next) {
         if (texture->access == SDL_TEXTUREACCESS_TARGET) {
             D3D_DestroyTexture(renderer, texture);
@@ -1699,15 +3793,20 @@ static int D3D_Reset(SDL_Renderer* renderer)
         }
     }
 
-    for (i = 0; i < (int)SDL_arraysize(data->vertexBuffers); ++i) {
-        if (data->vertexBuffers[i]) { IDirect3DVertexBuffer8_Release(data->vertexBuffers[i]); data->vertexBuffers[i] = NULL; }
-        data->vertexBufferSize[i] = 0;
+    for (page = data->atlases; page; page = page->next) {
+        D3D_TextureRep* rep = &page->texture;
+        if (D3D_RecreateTextureRep(data->device, rep) == 0 &&
+            D3D_CreateTextureRep(data->device, rep, rep->usage, rep->format, rep->d3dfmt, rep->w, rep->h, rep->swizzled) == 0) {
+            D3D_AddDirtyRect(rep, 0, 0, rep->w, rep->h);
+        }
     }
-    data->currentVertexBuffer = 0;
-    data->reportedVboProblem = SDL_FALSE;
+
+    /* The vertex rings survive Reset(): Xbox resources are never lost, and
+       queued commands may still point into them. */
 
     result = IDirect3DDevice8_Reset(data->device, &data->pparams);
     if (FAILED(result)) {
+        data->targetPoolLimit = poollimit;
         if (result == D3DERR_DEVICELOST) return 0;
         return D3D_SetError("Reset()", result);
     }
@@ -1720,6 +3819,8 @@ static int D3D_Reset(SDL_Renderer* renderer)
             if (D3D_CreateTexture(renderer, texture) < 0) { /* keep going */ }
         }
     }
+    data->targetPoolLimit = poollimit;
+    D3D_TrimTargetPool(data, poollimit);
 
     result = IDirect3DDevice8_GetRenderTarget(data->device, &data->defaultRenderTarget);
     if (FAILED(result)) return D3D_SetError("GetRenderTarget()", result);
@@ -1756,7 +3857,6 @@ static int D3D_Reset(SDL_Renderer* renderer)
     data->drawstate.cliprect_enabled_dirty = SDL_TRUE;
     data->drawstate.texture = NULL;
     data->drawstate.blend = SDL_BLENDMODE_INVALID;
-    data->drawstate.is_copy_ex = SDL_FALSE;
 
     IDirect3DDevice8_SetTransform(data->device, D3DTS_VIEW, (const D3DMATRIX*)&viewIdent);
 
@@ -1887,7 +3987,6 @@ int D3D_CreateRenderer(SDL_Renderer* renderer, SDL_Window* window, Uint32 flags)
     D3DCAPS8 caps;
     DWORD device_flags;
     DWORD vidflags;
-    int i;
 
     data = (D3D_RenderData*)SDL_calloc(1, sizeof(*data));
     if (!data) { SDL_free(renderer); SDL_OutOfMemory(); return -1; }
@@ -1905,6 +4004,7 @@ int D3D_CreateRenderer(SDL_Renderer* renderer, SDL_Window* window, Uint32 flags)
     renderer->CreateTexture = D3D_CreateTexture;
     renderer->UpdateTexture = D3D_UpdateTexture;
     renderer->UpdateTextureYUV = D3D_UpdateTextureYUV;
+    renderer->UpdateTextureNV = D3D_UpdateTextureNV;
     renderer->LockTexture = D3D_LockTexture;
     renderer->UnlockTexture = D3D_UnlockTexture;
     renderer->SetRenderTarget = D3D_SetRenderTarget;
@@ -1915,6 +4015,7 @@ int D3D_CreateRenderer(SDL_Renderer* renderer, SDL_Window* window, Uint32 flags)
     renderer->QueueFillRects = D3D_QueueFillRects;
     renderer->QueueCopy = D3D_QueueCopy;
     renderer->QueueCopyEx = D3D_QueueCopyEx;
+    renderer->QueueGeometry = D3D_QueueGeometry;
     renderer->RunCommandQueue = D3D_RunCommandQueue;
     renderer->RenderReadPixels = D3D_RenderReadPixels;
     renderer->RenderPresent = D3D_RenderPresent;
@@ -1998,6 +4099,7 @@ int D3D_CreateRenderer(SDL_Renderer* renderer, SDL_Window* window, Uint32 flags)
     }
 
     FinalizeXboxMode(&pparams);
+    D3D_ApplyPresentHints(&pparams);
 
     result = IDirect3D8_CreateDevice(data->d3d, 0, D3DDEVTYPE_HAL, NULL, device_flags, &pparams, &data->device);
     if (FAILED(result)) {
@@ -2023,12 +4125,21 @@ int D3D_CreateRenderer(SDL_Renderer* renderer, SDL_Window* window, Uint32 flags)
     renderer->info.max_texture_width = caps.MaxTextureWidth;
     renderer->info.max_texture_height = caps.MaxTextureHeight;
 
-    for (i = 0; i < (int)SDL_arraysize(data->vertexBuffers); ++i) {
-        data->vertexBuffers[i] = NULL;
-        data->vertexBufferSize[i] = 0;
+    D3D_CreateRings(data);
+    if (FAILED(IDirect3DDevice8_CreateVertexShader(data->device, D3D_QuadVertexDecl, NULL, &data->compactShader, 0))) {
+        data->compactShader = 0;
+    }
+    data->quadColor = D3DCOLOR_ARGB(255, 255, 255, 255);
+    data->quadBlend = SDL_BLENDMODE_INVALID;
+    data->lineWidth = 1.0f;
+    {
+        const char* hint = SDL_GetHint(SDL_HINT_RENDER_XBOX_TARGET_POOL);
+        data->targetPoolLimit = (size_t)(hint ? SDL_atoi(hint) : 8192) * 1024;
+    }
+    {
+        const char* hint = SDL_GetHint(SDL_HINT_RENDER_XBOX_TEXTURE_BUDGET);
+        data->textureBudget = (size_t)(hint ? SDL_atoi(hint) : 0) * 1024;
     }
-    data->currentVertexBuffer = 0;
-    data->reportedVboProblem = SDL_FALSE;
 
     IDirect3DDevice8_GetRenderTarget(data->device, &data->defaultRenderTarget);
     data->currentRenderTarget = NULL;
@@ -2060,7 +4171,6 @@ int D3D_CreateRenderer(SDL_Renderer* renderer, SDL_Window* window, Uint32 flags)
     data->drawstate.cliprect_enabled_dirty = SDL_TRUE;
     data->drawstate.texture = NULL;
     data->drawstate.blend = SDL_BLENDMODE_INVALID;
-    data->drawstate.is_copy_ex = SDL_FALSE;
 
     return 0;
 }
@@ -2072,8 +4182,10 @@ SDL_RenderDriver D3D_RenderDriver = {
     {
         "direct3d",
         (SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE),
-        1,
-        {SDL_PIXELFORMAT_ARGB8888},
+        11,
+        {SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_DXT1, SDL_PIXELFORMAT_DXT3, SDL_PIXELFORMAT_DXT5,
+         SDL_PIXELFORMAT_YV12, SDL_PIXELFORMAT_IYUV, SDL_PIXELFORMAT_NV12, SDL_PIXELFORMAT_NV21,
+         SDL_PIXELFORMAT_YUY2, SDL_PIXELFORMAT_UYVY, SDL_PIXELFORMAT_INDEX8},
         0,
         0
     }
@@ -2100,4 +4212,423 @@ IDirect3DDevice8* SDL_RenderGetD3D8Device(SDL_Renderer* renderer)
     return device;
 }
 
+int SDL_RenderRequestXboxReadback(SDL_Renderer* renderer, const SDL_Rect* rect)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    D3D_RenderData* data;
+    D3D_Readback* readback;
+    SDL_Rect r;
+
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Renderer is not a D3D renderer");
+    }
+
+    data = (D3D_RenderData*)renderer->driverdata;
+    if (data->numReadbacks == D3D_MAX_READBACKS) {
+        return SDL_SetError("Too many readbacks in flight");
+    }
+
+    if (rect) {
+        r = *rect;
+    }
+    else {
+        r.x = 0;
+        r.y = 0;
+        r.w = 0x7FFFFFFF;
+        r.h = 0x7FFFFFFF;
+    }
+
+    /* The copy has to land after everything drawn so far. */
+    if (SDL_RenderFlush(renderer) < 0) {
+        return -1;
+    }
+
+    readback = &data->readbacks[(data->firstReadback + data->numReadbacks) % D3D_MAX_READBACKS];
+    if (D3D_CopyRenderTarget(data, &r, &readback->surface, &readback->format) < 0) {
+        return -1;
+    }
+    readback->rect = r;
+    readback->fence = IDirect3DDevice8_InsertFence(data->device);
+    data->numReadbacks++;
+    return 0;
+#else
+    (void)renderer;
+    (void)rect;
+    return SDL_Unsupported();
+#endif
+}
+
+int SDL_RenderGetXboxReadback(SDL_Renderer* renderer, SDL_Rect* rect, Uint32 format, void* pixels, int pitch)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    D3D_RenderData* data;
+    D3D_Readback* readback;
+
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Renderer is not a D3D renderer");
+    }
+    if (!pixels) {
+        return SDL_InvalidParamError("pixels");
+    }
+
+    data = (D3D_RenderData*)renderer->driverdata;
+    if (data->numReadbacks == 0) {
+        return 0;
+    }
+
+    readback = &data->readbacks[data->firstReadback];
+    if (IDirect3DDevice8_IsFencePending(data->device, readback->fence)) {
+        return 0;
+    }
+
+    data->firstReadback = (data->firstReadback + 1) % D3D_MAX_READBACKS;
+    data->numReadbacks--;
+
+    if (rect) {
+        *rect = readback->rect;
+    }
+    if (D3D_ConvertReadback(readback->surface, readback->format, readback->rect.w, readback->rect.h, format, pixels, pitch) < 0) {
+        return -1;
+    }
+    return 1;
+#else
+    (void)renderer;
+    (void)rect;
+    (void)format;
+    (void)pixels;
+    (void)pitch;
+    return SDL_Unsupported();
+#endif
+}
+
+int SDL_RenderBeginXboxDisplayList(SDL_Renderer* renderer)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    D3D_RenderData* data;
+    SDL_XboxDisplayList* list;
+
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Renderer is not a D3D renderer");
+    }
+
+    data = (D3D_RenderData*)renderer->driverdata;
+    if (data->recording) {
+        return SDL_SetError("A display list is already being recorded");
+    }
+
+    /* What is queued so far belongs to the frame, not to the list. */
+    if (SDL_RenderFlush(renderer) < 0) {
+        return -1;
+    }
+
+    list = (SDL_XboxDisplayList*)SDL_calloc(1, sizeof(*list));
+    if (!list) {
+        return SDL_OutOfMemory();
+    }
+    list->renderer = renderer;
+    list->resets = data->resets;
+    data->recording = list;
+    return 0;
+#else
+    (void)renderer;
+    return SDL_Unsupported();
+#endif
+}
+
+SDL_XboxDisplayList* SDL_RenderEndXboxDisplayList(SDL_Renderer* renderer)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    D3D_RenderData* data;
+    SDL_XboxDisplayList* list;
+    int result;
+
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        SDL_SetError("Renderer is not a D3D renderer");
+        return NULL;
+    }
+
+    data = (D3D_RenderData*)renderer->driverdata;
+    if (!data->recording) {
+        SDL_SetError("No display list is being recorded");
+        return NULL;
+    }
+
+    result = SDL_RenderFlush(renderer);
+    list = data->recording;
+    data->recording = NULL;
+    if (result < 0) {
+        D3D_DestroyDisplayList(list);
+        return NULL;
+    }
+    return list;
+#else
+    (void)renderer;
+    SDL_Unsupported();
+    return NULL;
+#endif
+}
+
+int SDL_RenderRunXboxDisplayList(SDL_Renderer* renderer, SDL_XboxDisplayList* list)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    D3D_RenderData* data;
+
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Renderer is not a D3D renderer");
+    }
+    if (!list || list->renderer != renderer) {
+        return SDL_InvalidParamError("list");
+    }
+
+    data = (D3D_RenderData*)renderer->driverdata;
+    if (data->recording) {
+        return SDL_SetError("Display lists cannot be replayed while recording");
+    }
+
+    /* The list draws on top of everything queued so far. */
+    if (SDL_RenderFlush(renderer) < 0) {
+        return -1;
+    }
+    return D3D_RunDisplayList(renderer, list);
+#else
+    (void)renderer;
+    (void)list;
+    return SDL_Unsupported();
+#endif
+}
+
+void SDL_RenderDestroyXboxDisplayList(SDL_XboxDisplayList* list)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    if (list) {
+        D3D_DestroyDisplayList(list);
+    }
+#else
+    (void)list;
+#endif
+}
+
+int SDL_RenderGetXboxFrameTiming(SDL_Renderer* renderer, SDL_XboxFrameTiming* timing)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    D3D_RenderData* data;
+    D3DFIELD_STATUS status;
+
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Renderer is not a D3D renderer");
+    }
+    if (!timing) {
+        return SDL_InvalidParamError("timing");
+    }
+
+    data = (D3D_RenderData*)renderer->driverdata;
+    D3D_UpdateGPUBusy(data);
+    IDirect3DDevice8_GetDisplayFieldStatus(data->device, &status);
+
+    SDL_zerop(timing);
+    timing->vblank_count = status.VBlankCount;
+    timing->field = (status.Field == D3DFIELD_ODD) ? 1 : (status.Field == D3DFIELD_EVEN) ? 2 : 0;
+    timing->frames_presented = data->framesPresented;
+    timing->missed_vblanks = data->missedVBlanks;
+    timing->last_frame_vblanks = data->lastFrameVBlanks;
+    timing->gpu_busy_us = D3D_TicksToMicroseconds(data, data->gpuBusy);
+    timing->present_wait_us = D3D_TicksToMicroseconds(data, data->presentWait);
+    timing->buffer_count = (int)data->pparams.BackBufferCount + 1;
+    timing->immediate = (data->pparams.FullScreen_PresentationInterval == D3DPRESENT_INTERVAL_IMMEDIATE) ? SDL_TRUE : SDL_FALSE;
+    return 0;
+#else
+    (void)renderer;
+    (void)timing;
+    return SDL_Unsupported();
+#endif
+}
+
+int SDL_RenderWaitXboxVBlank(SDL_Renderer* renderer)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    D3D_RenderData* data;
+
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Renderer is not a D3D renderer");
+    }
+
+    /* Hand the GPU everything queued so far before sleeping. */
+    if (SDL_RenderFlush(renderer) < 0) {
+        return -1;
+    }
+    data = (D3D_RenderData*)renderer->driverdata;
+    IDirect3DDevice8_KickPushBuffer(data->device);
+    IDirect3DDevice8_BlockUntilVerticalBlank(data->device);
+    return 0;
+#else
+    (void)renderer;
+    return SDL_Unsupported();
+#endif
+}
+
+int SDL_RenderGetXboxTextureMemory(SDL_Renderer* renderer, SDL_XboxTextureMemory* memory)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Renderer is not a D3D renderer");
+    }
+    if (!memory) {
+        return SDL_InvalidParamError("memory");
+    }
+
+    D3D_GetTextureMemory(renderer, memory);
+    return 0;
+#else
+    (void)renderer;
+    (void)memory;
+    return SDL_Unsupported();
+#endif
+}
+
+int SDL_GetXboxTextureMemory(SDL_Texture* texture, Uint32* default_bytes, Uint32* systemmem_bytes)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    const D3D_TextureData* texturedata;
+    Uint32 gpubytes = 0, stagingbytes = 0;
+
+    if (!texture || !texture->renderer || texture->renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Texture does not belong to a D3D renderer");
+    }
+
+    texturedata = (const D3D_TextureData*)texture->driverdata;
+    if (texturedata && texturedata->atlas) {
+        /* its share of the atlas page */
+        const Uint32 bytes = D3D_GetTextureBytes(texturedata->atlas->texture.d3dfmt, texturedata->atlas->texture.format,
+            texturedata->atlasrect.w, texturedata->atlasrect.h);
+        gpubytes = texturedata->atlas->texture.texture ? bytes : 0;
+        stagingbytes = texturedata->atlas->texture.staging ? bytes : 0;
+    }
+    else if (texturedata) {
+        D3D_GetTextureRepMemory(&texturedata->texture, &gpubytes, &stagingbytes);
+    }
+
+    if (default_bytes) *default_bytes = gpubytes;
+    if (systemmem_bytes) *systemmem_bytes = stagingbytes;
+    return 0;
+#else
+    (void)texture;
+    if (default_bytes) *default_bytes = 0;
+    if (systemmem_bytes) *systemmem_bytes = 0;
+    return SDL_Unsupported();
+#endif
+}
+
+int SDL_UpdateXboxTexturePalette(SDL_Texture* texture, const SDL_Color* colors, int firstcolor, int ncolors)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    SDL_Renderer* renderer;
+    D3D_RenderData* data;
+    D3D_TextureData* texturedata;
+    int next, i;
+
+    if (!texture || !texture->renderer || texture->renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Texture does not belong to a D3D renderer");
+    }
+    renderer = texture->renderer;
+    data = (D3D_RenderData*)renderer->driverdata;
+    texturedata = (D3D_TextureData*)texture->driverdata;
+    if (!texturedata || !texturedata->palettes[0]) {
+        return SDL_SetError("Texture is not palettized");
+    }
+    if (!colors || firstcolor < 0 || ncolors < 0 || firstcolor + ncolors > 256) {
+        return SDL_InvalidParamError("colors");
+    }
+    if (ncolors == 0) {
+        return 0;
+    }
+
+    /* Queued draws must bind the palette as it was when they were made. */
+    if (SDL_RenderFlush(renderer) < 0) {
+        return -1;
+    }
+
+    for (i = 0; i < ncolors; ++i) {
+        const SDL_Color* color = &colors[i];
+        texturedata->colors[firstcolor + i] = D3DCOLOR_ARGB(color->a, color->r, color->g, color->b);
+    }
+
+    next = (texturedata->curpalette + 1) % D3D_MAX_PALETTES;
+    if (D3D_FillTexturePalette(texturedata, texturedata->palettes[next]) < 0) {
+        return -1;
+    }
+    texturedata->curpalette = next;
+
+    if (data->drawstate.texture == texture) {
+        data->drawstate.texture = NULL;
+    }
+    return 0;
+#else
+    (void)texture; (void)colors; (void)firstcolor; (void)ncolors;
+    return SDL_Unsupported();
+#endif
+}
+
+int SDL_RenderSetXboxLineWidth(SDL_Renderer* renderer, float width)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    D3D_RenderData* data;
+
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Renderer is not a D3D renderer");
+    }
+    if (!(width > 0.0f)) {
+        return SDL_InvalidParamError("width");
+    }
+
+    data = (D3D_RenderData*)renderer->driverdata;
+    data->lineWidth = width;
+    return 0;
+#else
+    (void)renderer;
+    (void)width;
+    return SDL_Unsupported();
+#endif
+}
+
+int SDL_RenderSetXboxStatsOverlay(SDL_Renderer* renderer, SDL_bool enabled)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    D3D_RenderData* data;
+
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Renderer is not a D3D renderer");
+    }
+
+    data = (D3D_RenderData*)renderer->driverdata;
+    data->statsOverlay = enabled ? SDL_TRUE : SDL_FALSE;
+    return 0;
+#else
+    (void)renderer;
+    (void)enabled;
+    return SDL_Unsupported();
+#endif
+}
+
+int SDL_RenderGetXboxStats(SDL_Renderer* renderer, SDL_XboxRenderStats* stats)
+{
+#if SDL_VIDEO_RENDER_D3D && !SDL_RENDER_DISABLED
+    D3D_RenderData* data;
+
+    if (!renderer || renderer->DestroyRenderer != D3D_DestroyRenderer) {
+        return SDL_SetError("Renderer is not a D3D renderer");
+    }
+    if (!stats) {
+        return SDL_InvalidParamError("stats");
+    }
+
+    data = (D3D_RenderData*)renderer->driverdata;
+    *stats = data->laststats;
+    return 0;
+#else
+    (void)renderer;
+    (void)stats;
+    return SDL_Unsupported();
+#endif
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
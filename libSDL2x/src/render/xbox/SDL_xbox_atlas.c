@@ -0,0 +1,187 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../../SDL_internal.h"
+
+#include "SDL_xbox_atlas.h"
+
+void
+XBOX_InitAtlasPacker(XBOX_AtlasPacker *packer, int w, int h, int padding)
+{
+    packer->w = w;
+    packer->h = h;
+    packer->padding = padding;
+    packer->numnodes = 1;
+    packer->nodes[0].x = 0;
+    packer->nodes[0].y = 0;
+    packer->nodes[0].w = w;
+}
+
+/* Lowest y at which a w x h entry fits when its left edge is on node 'index',
+   or -1 if it runs off the page. */
+static int
+XBOX_AtlasFit(const XBOX_AtlasPacker *packer, int index, int w, int h)
+{
+    const XBOX_AtlasNode *node = &packer->nodes[index];
+    int left = w;
+    int y = 0;
+
+    if (node->x + w > packer->w) {
+        return -1;
+    }
+
+    while (left > 0) {
+        if (index >= packer->numnodes) {
+            return -1;
+        }
+        node = &packer->nodes[index++];
+        if (node->y > y) {
+            y = node->y;
+        }
+        if (y + h > packer->h) {
+            return -1;
+        }
+        left -= node->w;
+    }
+    return y;
+}
+
+SDL_bool
+XBOX_AtlasPack(XBOX_AtlasPacker *packer, int w, int h, SDL_Rect *rect)
+{
+    int best = -1, besty = 0, bestw = 0, bestpw = 0;
+    int i, y, x, pw, ph, shrink;
+    XBOX_AtlasNode *node;
+
+    if (w <= 0 || h <= 0 || w > packer->w || h > packer->h) {
+        return SDL_FALSE;
+    }
+
+    for (i = 0; i < packer->numnodes; ++i) {
+        /* Padding is cut off at the right and bottom edges of the page, where
+           there is no neighbour to keep apart from. */
+        pw = SDL_min(w + packer->padding, packer->w - packer->nodes[i].x);
+        if (pw < w) {
+            continue;
+        }
+        y = XBOX_AtlasFit(packer, i, pw, h);
+        if (y < 0) {
+            continue;
+        }
+        /* lowest top edge first, then the tightest segment */
+        if (best < 0 || y < besty || (y == besty && packer->nodes[i].w < bestw)) {
+            best = i;
+            besty = y;
+            bestw = packer->nodes[i].w;
+            bestpw = pw;
+        }
+    }
+
+    if (best < 0 || packer->numnodes >= XBOX_ATLAS_MAX_NODES) {
+        return SDL_FALSE;
+    }
+
+    x = packer->nodes[best].x;
+    pw = bestpw;
+    ph = SDL_min(h + packer->padding, packer->h - besty);
+
+    /* Insert the new segment and trim the ones it now covers. */
+    SDL_memmove(&packer->nodes[best + 1], &packer->nodes[best],
+                (packer->numnodes - best) * sizeof(XBOX_AtlasNode));
+    packer->numnodes++;
+    node = &packer->nodes[best];
+    node->x = x;
+    node->y = besty + ph;
+    node->w = pw;
+
+    i = best + 1;
+    while (i < packer->numnodes) {
+        node = &packer->nodes[i];
+        shrink = (x + pw) - node->x;
+        if (shrink <= 0) {
+            break;
+        }
+        if (shrink < node->w) {
+            node->x += shrink;
+            node->w -= shrink;
+            break;
+        }
+        SDL_memmove(&packer->nodes[i], &packer->nodes[i + 1],
+                    (packer->numnodes - i - 1) * sizeof(XBOX_AtlasNode));
+        packer->numnodes--;
+    }
+
+    /* Merge neighbours at the same height. */
+    for (i = 0; i + 1 < packer->numnodes; ) {
+        if (packer->nodes[i].y == packer->nodes[i + 1].y) {
+            packer->nodes[i].w += packer->nodes[i + 1].w;
+            SDL_memmove(&packer->nodes[i + 1], &packer->nodes[i + 2],
+                        (packer->numnodes - i - 2) * sizeof(XBOX_AtlasNode));
+            packer->numnodes--;
+        } else {
+            ++i;
+        }
+    }
+
+    rect->x = x;
+    rect->y = besty;
+    rect->w = w;
+    rect->h = h;
+    return SDL_TRUE;
+}
+
+void
+XBOX_GetAtlasUVTransform(const SDL_Rect *entry, int pagew, int pageh,
+                         float *su, float *sv, float *ou, float *ov)
+{
+    *su = 1.0f / (float)pagew;
+    *sv = 1.0f / (float)pageh;
+    *ou = (float)entry->x / (float)pagew;
+    *ov = (float)entry->y / (float)pageh;
+}
+
+void
+XBOX_ExtrudeAtlasEntry(Uint8 *pixels, int pitch, int bpp, int w, int h,
+                       const SDL_Rect *updated)
+{
+    const int x0 = (updated->x == 0) ? -1 : updated->x;
+    const int x1 = (updated->x + updated->w == w) ? w + 1 : updated->x + updated->w;
+    int y;
+
+    /* columns first, so the rows below carry the corners along */
+    for (y = updated->y; y < updated->y + updated->h; ++y) {
+        Uint8 *row = pixels + y * pitch;
+        if (x0 < updated->x) {
+            SDL_memcpy(row - bpp, row, bpp);
+        }
+        if (x1 > updated->x + updated->w) {
+            SDL_memcpy(row + w * bpp, row + (w - 1) * bpp, bpp);
+        }
+    }
+    if (updated->y == 0) {
+        SDL_memcpy(pixels - pitch + x0 * bpp, pixels + x0 * bpp, (x1 - x0) * bpp);
+    }
+    if (updated->y + updated->h == h) {
+        SDL_memcpy(pixels + h * pitch + x0 * bpp, pixels + (h - 1) * pitch + x0 * bpp, (x1 - x0) * bpp);
+    }
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,74 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDL_xbox_atlas_h_
+#define SDL_xbox_atlas_h_
+
+#include "../../SDL_internal.h"
+
+#include "SDL_rect.h"
+
+/* Skyline packer for texture atlas pages.
+
+   The skyline is the top edge of everything placed so far, kept as a list of
+   horizontal segments sorted by x. A new rectangle goes where its top edge
+   ends up lowest (bottom-left rule). Space is not reclaimed when entries go
+   away; a page is reset once it is empty. These routines have no D3D
+   dependency so they can be built on the host. */
+
+#define XBOX_ATLAS_MAX_NODES 256
+
+typedef struct
+{
+    int x, y, w;
+} XBOX_AtlasNode;
+
+typedef struct
+{
+    int w, h;
+    int padding;
+    int numnodes;
+    XBOX_AtlasNode nodes[XBOX_ATLAS_MAX_NODES];
+} XBOX_AtlasPacker;
+
+/* Starts an empty w x h page. Every entry is followed by 'padding' unused
+   texels to the right and below, so filtering never reads a neighbour; an
+   entry may end on the page edge itself. */
+extern void XBOX_InitAtlasPacker(XBOX_AtlasPacker *packer, int w, int h, int padding);
+
+/* Finds room for a w x h entry; returns SDL_FALSE if the page is full. */
+extern SDL_bool XBOX_AtlasPack(XBOX_AtlasPacker *packer, int w, int h, SDL_Rect *rect);
+
+/* Maps texel coordinates inside 'entry' to normalized page coordinates:
+   u' = u * su + ou, v' = v * sv + ov. */
+extern void XBOX_GetAtlasUVTransform(const SDL_Rect *entry, int pagew, int pageh,
+                                     float *su, float *sv, float *ou, float *ov);
+
+/* Copies the edge texels of a w x h entry into the one-texel border around
+   it, for the edges that 'updated' (in entry coordinates) touches, so
+   bilinear filtering at an edge reads the entry's own texels. 'pixels'
+   points at texel 0,0 of the entry; the border is at -1 and at w, h. */
+extern void XBOX_ExtrudeAtlasEntry(Uint8 *pixels, int pitch, int bpp, int w, int h,
+                                   const SDL_Rect *updated);
+
+#endif /* SDL_xbox_atlas_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
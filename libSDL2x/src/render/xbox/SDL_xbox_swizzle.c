@@ -0,0 +1,138 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../../SDL_internal.h"
+
+#include "SDL_xbox_swizzle.h"
+
+/* Bit masks selecting the x and y bits of a swizzled texel offset. */
+static void
+XBOX_GetSwizzleMasks(int width, int height, Uint32 *mask_x, Uint32 *mask_y)
+{
+    Uint32 x = 0, y = 0;
+    Uint32 bit = 1, mask_bit = 1;
+
+    while (bit < (Uint32)width || bit < (Uint32)height) {
+        if (bit < (Uint32)width) {
+            x |= mask_bit;
+            mask_bit <<= 1;
+        }
+        if (bit < (Uint32)height) {
+            y |= mask_bit;
+            mask_bit <<= 1;
+        }
+        bit <<= 1;
+    }
+
+    *mask_x = x;
+    *mask_y = y;
+}
+
+/* Spreads the low bits of 'value' over the set bits of 'mask'. */
+static Uint32
+XBOX_DepositBits(Uint32 value, Uint32 mask)
+{
+    Uint32 result = 0;
+    Uint32 bit;
+
+    for (bit = 1; mask; bit <<= 1) {
+        if (value & bit) {
+            result |= mask & (~mask + 1);
+        }
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+SDL_bool
+XBOX_CanSwizzle(int width, int height)
+{
+    if (width <= 0 || height <= 0) {
+        return SDL_FALSE;
+    }
+    return ((width & (width - 1)) == 0 && (height & (height - 1)) == 0) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Walking a row only needs one increment in swizzled space per texel:
+   (offset - mask) & mask is offset + 1 with the carry rippling through the
+   holes of the mask. 'to' and 'from' name the linear (l) and swizzled (s)
+   sides of the copy. */
+#define SWIZZLE_ROW(type, to, from)                             \
+    {                                                           \
+        type *l = (type *)linear;                               \
+        type *s = (type *)swizzled;                             \
+        Uint32 ox = start_x;                                    \
+        int i;                                                  \
+        for (i = 0; i < rect->w; ++i) {                         \
+            to = from;                                          \
+            ox = (ox - mask_x) & mask_x;                        \
+        }                                                       \
+    }
+
+static void
+XBOX_SwizzleCopy(Uint8 *linear, int pitch, Uint8 *swizzled,
+                 int width, int height, const SDL_Rect *rect, int bpp, SDL_bool to_swizzled)
+{
+    Uint32 mask_x, mask_y, start_x;
+    int row;
+
+    XBOX_GetSwizzleMasks(width, height, &mask_x, &mask_y);
+    start_x = XBOX_DepositBits((Uint32)rect->x, mask_x);
+
+    for (row = 0; row < rect->h; ++row) {
+        const Uint32 oy = XBOX_DepositBits((Uint32)(rect->y + row), mask_y);
+
+        if (to_swizzled) {
+            switch (bpp) {
+            case 4: SWIZZLE_ROW(Uint32, s[ox | oy], l[i]); break;
+            case 2: SWIZZLE_ROW(Uint16, s[ox | oy], l[i]); break;
+            case 1: SWIZZLE_ROW(Uint8, s[ox | oy], l[i]); break;
+            default: return;
+            }
+        } else {
+            switch (bpp) {
+            case 4: SWIZZLE_ROW(Uint32, l[i], s[ox | oy]); break;
+            case 2: SWIZZLE_ROW(Uint16, l[i], s[ox | oy]); break;
+            case 1: SWIZZLE_ROW(Uint8, l[i], s[ox | oy]); break;
+            default: return;
+            }
+        }
+        linear += pitch;
+    }
+}
+
+#undef SWIZZLE_ROW
+
+void
+XBOX_SwizzleRect(const void *src, int src_pitch, void *dst,
+                 int width, int height, const SDL_Rect *rect, int bpp)
+{
+    XBOX_SwizzleCopy((Uint8 *)src, src_pitch, (Uint8 *)dst, width, height, rect, bpp, SDL_TRUE);
+}
+
+void
+XBOX_UnswizzleRect(const void *src, int width, int height, const SDL_Rect *rect,
+                   void *dst, int dst_pitch, int bpp)
+{
+    XBOX_SwizzleCopy((Uint8 *)dst, dst_pitch, (Uint8 *)src, width, height, rect, bpp, SDL_FALSE);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
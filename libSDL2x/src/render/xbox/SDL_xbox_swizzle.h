@@ -0,0 +1,50 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDL_xbox_swizzle_h_
+#define SDL_xbox_swizzle_h_
+
+#include "../../SDL_internal.h"
+
+#include "SDL_rect.h"
+
+/* NV2A swizzled texture layout.
+
+   Swizzled textures interleave the bits of the x and y texel coordinates,
+   x first, until the smaller dimension runs out; the remaining bits of the
+   larger dimension go on top. Only power-of-two sizes can be swizzled.
+   These routines have no D3D dependency so they can be built on the host. */
+
+extern SDL_bool XBOX_CanSwizzle(int width, int height);
+
+/* Writes 'rect' of a linear image into a swizzled width x height image.
+   'src' points at the top-left texel of 'rect'. */
+extern void XBOX_SwizzleRect(const void *src, int src_pitch, void *dst,
+                             int width, int height, const SDL_Rect *rect, int bpp);
+
+/* Reads 'rect' of a swizzled width x height image into a linear image.
+   'dst' points at the top-left texel of 'rect'. */
+extern void XBOX_UnswizzleRect(const void *src, int width, int height, const SDL_Rect *rect,
+                               void *dst, int dst_pitch, int bpp);
+
+#endif /* SDL_xbox_swizzle_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -2720,6 +2720,11 @@ static SDL_bool ShouldAttemptTextureFramebuffer(void)
 #endif
 #if defined(__EMSCRIPTEN__)
         attempt_texture_framebuffer = SDL_FALSE;
+#endif
+#if defined(__XBOX__) /* The Xbox framebuffer already draws with the GPU, without a copy. */
+        if (_this->CreateWindowFramebuffer && (SDL_strcmp(_this->name, "Xbox") == 0)) {
+            attempt_texture_framebuffer = SDL_FALSE;
+        }
 #endif
     }
     return attempt_texture_framebuffer;
@@ -0,0 +1,285 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_XBOX
+
+#include "../SDL_sysvideo.h"
+
+#include "SDL_xboxvideo.h"
+#include "SDL_xboxframebuffer.h"
+
+/* The window surface is the memory of a linear texture, so the CPU draws
+   straight into it and the GPU scales it onto the back buffer; nothing is
+   copied. Only the rects updated since the back buffer was last drawn are
+   redrawn. */
+
+#define XBOX_SURFACE "_SDL_XboxSurface"
+
+/* More rects than this are drawn as one quad covering the window */
+#define XBOX_FRAMEBUFFER_MAX_RECTS 64
+
+typedef struct
+{
+    float x, y, z, rhw;
+    float u, v;
+} XBOX_FramebufferVertex;
+
+#define XBOX_FRAMEBUFFER_FVF (D3DFVF_XYZRHW | D3DFVF_TEX1)
+
+typedef struct
+{
+    IDirect3D8* d3d;
+    IDirect3DDevice8* device;
+    IDirect3DTexture8* texture;
+    D3DPRESENT_PARAMETERS pparams;
+    int w, h;
+
+    /* Present() flips between two buffers, so each update redraws its own
+       rects and the ones of the update before */
+    SDL_Rect lastrects[XBOX_FRAMEBUFFER_MAX_RECTS];
+    int numlastrects;
+    SDL_bool lastfull;
+    int full_redraws;           /* back buffers whose contents are unknown */
+} XBOX_Framebuffer;
+
+extern SDL_DisplayMode g_XboxDesktopMode;
+
+static void
+XBOX_SetFramebufferMode(D3DPRESENT_PARAMETERS* p, const SDL_DisplayMode* mode)
+{
+    const DWORD vflags = XGetVideoFlags();
+
+    SDL_zerop(p);
+    p->BackBufferWidth = (UINT)mode->w;
+    p->BackBufferHeight = (UINT)mode->h;
+    p->BackBufferFormat = D3DFMT_LIN_X8R8G8B8;
+    p->BackBufferCount = 1;
+    /* partial updates rely on the back buffers keeping their contents */
+    p->SwapEffect = D3DSWAPEFFECT_FLIP;
+    p->Windowed = FALSE;
+    p->EnableAutoDepthStencil = FALSE;
+    p->MultiSampleType = D3DMULTISAMPLE_NONE;
+    p->FullScreen_RefreshRateInHz = (UINT)mode->refresh_rate;
+    p->FullScreen_PresentationInterval = D3DPRESENT_INTERVAL_ONE;
+
+    /* the display modes come from XBOX_GetDisplayModes(), so they are
+       already allowed by the dashboard settings */
+    if (mode->h == 720) {
+        p->Flags = D3DPRESENTFLAG_PROGRESSIVE | D3DPRESENTFLAG_WIDESCREEN;
+    }
+    else if (mode->h == 1080) {
+        p->Flags = D3DPRESENTFLAG_INTERLACED | D3DPRESENTFLAG_WIDESCREEN;
+    }
+    else {
+        p->Flags = (mode->w == 720 && mode->h == 480 && (vflags & XC_VIDEO_FLAGS_HDTV_480p))
+            ? D3DPRESENTFLAG_PROGRESSIVE : D3DPRESENTFLAG_INTERLACED;
+        if (vflags & XC_VIDEO_FLAGS_WIDESCREEN) {
+            p->Flags |= D3DPRESENTFLAG_WIDESCREEN;
+        }
+    }
+}
+
+static void
+XBOX_FreeFramebuffer(XBOX_Framebuffer* fb)
+{
+    if (fb->texture) {
+        IDirect3DTexture8_UnlockRect(fb->texture, 0);
+        IDirect3DTexture8_Release(fb->texture);
+    }
+    if (fb->device) {
+        IDirect3DDevice8_Release(fb->device);
+    }
+    if (fb->d3d) {
+        IDirect3D8_Release(fb->d3d);
+    }
+    SDL_free(fb);
+}
+
+int
+XBOX_CreateWindowFramebuffer(_THIS, SDL_Window* window, Uint32* format, void** pixels, int* pitch)
+{
+    XBOX_Framebuffer* fb;
+    D3DLOCKED_RECT locked;
+    HRESULT result;
+    int w, h;
+
+    /* Free the old framebuffer surface */
+    XBOX_DestroyWindowFramebuffer(_this, window);
+
+    fb = (XBOX_Framebuffer*)SDL_calloc(1, sizeof(*fb));
+    if (!fb) {
+        return SDL_OutOfMemory();
+    }
+
+    if (!D3D_LoadDLL(&fb->d3d)) {
+        XBOX_FreeFramebuffer(fb);
+        return SDL_SetError("Unable to create Direct3D interface");
+    }
+
+    XBOX_SetFramebufferMode(&fb->pparams, &g_XboxDesktopMode);
+    result = IDirect3D8_CreateDevice(fb->d3d, 0, D3DDEVTYPE_HAL, NULL,
+        D3DCREATE_HARDWARE_VERTEXPROCESSING, &fb->pparams, &fb->device);
+    if (FAILED(result)) {
+        XBOX_FreeFramebuffer(fb);
+        return SDL_SetError("CreateDevice() failed (0x%lx); is a renderer using the window?", (unsigned long)result);
+    }
+
+    /* linear, so the CPU can address it like any surface */
+    SDL_GetWindowSizeInPixels(window, &w, &h);
+    result = IDirect3DDevice8_CreateTexture(fb->device, (UINT)w, (UINT)h, 1, 0,
+        D3DFMT_LIN_X8R8G8B8, D3DPOOL_DEFAULT, &fb->texture);
+    if (FAILED(result)) {
+        XBOX_FreeFramebuffer(fb);
+        return SDL_SetError("CreateTexture() failed (0x%lx)", (unsigned long)result);
+    }
+    result = IDirect3DTexture8_LockRect(fb->texture, 0, &locked, NULL, 0);
+    if (FAILED(result)) {
+        IDirect3DTexture8_Release(fb->texture);
+        fb->texture = NULL;
+        XBOX_FreeFramebuffer(fb);
+        return SDL_SetError("LockRect() failed (0x%lx)", (unsigned long)result);
+    }
+    fb->w = w;
+    fb->h = h;
+    fb->full_redraws = 2;
+
+    /* One textured quad per rect, no blending or depth */
+    IDirect3DDevice8_SetVertexShader(fb->device, XBOX_FRAMEBUFFER_FVF);
+    IDirect3DDevice8_SetRenderState(fb->device, D3DRS_ZENABLE, FALSE);
+    IDirect3DDevice8_SetRenderState(fb->device, D3DRS_CULLMODE, D3DCULL_NONE);
+    IDirect3DDevice8_SetRenderState(fb->device, D3DRS_LIGHTING, FALSE);
+    IDirect3DDevice8_SetRenderState(fb->device, D3DRS_ALPHABLENDENABLE, FALSE);
+    IDirect3DDevice8_SetTexture(fb->device, 0, (IDirect3DBaseTexture8*)fb->texture);
+    IDirect3DDevice8_SetTextureStageState(fb->device, 0, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
+    IDirect3DDevice8_SetTextureStageState(fb->device, 0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+    IDirect3DDevice8_SetTextureStageState(fb->device, 0, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+    /* linear textures can't wrap */
+    IDirect3DDevice8_SetTextureStageState(fb->device, 0, D3DTSS_ADDRESSU, D3DTADDRESS_CLAMP);
+    IDirect3DDevice8_SetTextureStageState(fb->device, 0, D3DTSS_ADDRESSV, D3DTADDRESS_CLAMP);
+    {
+        const DWORD filter = ((UINT)w == fb->pparams.BackBufferWidth && (UINT)h == fb->pparams.BackBufferHeight)
+            ? D3DTEXF_POINT : D3DTEXF_LINEAR;
+        IDirect3DDevice8_SetTextureStageState(fb->device, 0, D3DTSS_MINFILTER, filter);
+        IDirect3DDevice8_SetTextureStageState(fb->device, 0, D3DTSS_MAGFILTER, filter);
+    }
+
+    SDL_SetWindowData(window, XBOX_SURFACE, fb);
+    *format = SDL_PIXELFORMAT_RGB888;
+    *pixels = locked.pBits;
+    *pitch = (int)locked.Pitch;
+    return 0;
+}
+
+static XBOX_FramebufferVertex*
+XBOX_AddFramebufferQuad(XBOX_Framebuffer* fb, XBOX_FramebufferVertex* v, const SDL_Rect* rect)
+{
+    /* linear textures take texel coordinates */
+    const float sx = (float)fb->pparams.BackBufferWidth / (float)fb->w;
+    const float sy = (float)fb->pparams.BackBufferHeight / (float)fb->h;
+    const float u0 = (float)rect->x, v0 = (float)rect->y;
+    const float u1 = (float)(rect->x + rect->w), v1 = (float)(rect->y + rect->h);
+    const float x0 = u0 * sx - 0.5f, y0 = v0 * sy - 0.5f;
+    const float x1 = u1 * sx - 0.5f, y1 = v1 * sy - 0.5f;
+
+    v[0].x = x0; v[0].y = y0; v[0].u = u0; v[0].v = v0;
+    v[1].x = x1; v[1].y = y0; v[1].u = u1; v[1].v = v0;
+    v[2].x = x1; v[2].y = y1; v[2].u = u1; v[2].v = v1;
+    v[3].x = x0; v[3].y = y1; v[3].u = u0; v[3].v = v1;
+    v[0].z = v[1].z = v[2].z = v[3].z = 0.0f;
+    v[0].rhw = v[1].rhw = v[2].rhw = v[3].rhw = 1.0f;
+    return v + 4;
+}
+
+int
+XBOX_UpdateWindowFramebuffer(_THIS, SDL_Window* window, const SDL_Rect* rects, int numrects)
+{
+    XBOX_Framebuffer* fb = (XBOX_Framebuffer*)SDL_GetWindowData(window, XBOX_SURFACE);
+    XBOX_FramebufferVertex verts[4 * 2 * XBOX_FRAMEBUFFER_MAX_RECTS];
+    XBOX_FramebufferVertex* v = verts;
+    const SDL_Rect whole = { 0, 0, fb ? fb->w : 0, fb ? fb->h : 0 };
+    SDL_Rect clipped[XBOX_FRAMEBUFFER_MAX_RECTS];
+    SDL_bool full = SDL_FALSE;
+    int numclipped = 0;
+    int i;
+
+    if (!fb) {
+        return SDL_SetError("Couldn't find Xbox surface for window");
+    }
+
+    /* rects outside the window would sample outside the texture */
+    for (i = 0; i < numrects; ++i) {
+        if (numclipped == XBOX_FRAMEBUFFER_MAX_RECTS) {
+            full = SDL_TRUE;
+            break;
+        }
+        if (SDL_IntersectRect(&rects[i], &whole, &clipped[numclipped])) {
+            ++numclipped;
+        }
+    }
+
+    if (fb->full_redraws > 0 || fb->lastfull || full) {
+        v = XBOX_AddFramebufferQuad(fb, v, &whole);
+        if (fb->full_redraws > 0) {
+            --fb->full_redraws;
+        }
+    }
+    else {
+        for (i = 0; i < numclipped; ++i) {
+            v = XBOX_AddFramebufferQuad(fb, v, &clipped[i]);
+        }
+        for (i = 0; i < fb->numlastrects; ++i) {
+            v = XBOX_AddFramebufferQuad(fb, v, &fb->lastrects[i]);
+        }
+    }
+
+    fb->lastfull = full;
+    fb->numlastrects = full ? 0 : numclipped;
+    if (!full && numclipped > 0) {
+        SDL_memcpy(fb->lastrects, clipped, numclipped * sizeof(*clipped));
+    }
+
+    IDirect3DDevice8_BeginScene(fb->device);
+    if (v > verts) {
+        IDirect3DDevice8_DrawPrimitiveUP(fb->device, D3DPT_QUADLIST, (UINT)((v - verts) / 4), verts, sizeof(*verts));
+    }
+    IDirect3DDevice8_EndScene(fb->device);
+
+    /* the GPU reads the surface memory itself; let it finish before the
+       app draws the next frame into it */
+    IDirect3DDevice8_BlockOnFence(fb->device, IDirect3DDevice8_InsertFence(fb->device));
+    IDirect3DDevice8_Present(fb->device, NULL, NULL, NULL, NULL);
+    return 0;
+}
+
+void
+XBOX_DestroyWindowFramebuffer(_THIS, SDL_Window* window)
+{
+    XBOX_Framebuffer* fb = (XBOX_Framebuffer*)SDL_SetWindowData(window, XBOX_SURFACE, NULL);
+
+    if (fb) {
+        XBOX_FreeFramebuffer(fb);
+    }
+}
+
+#endif /* SDL_VIDEO_DRIVER_XBOX */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -30,6 +30,7 @@
 #include "../SDL_pixels_c.h"
 
 #include "SDL_xboxvideo.h"
+#include "SDL_xboxframebuffer.h"
 
 /* Initialization/Query functions */
 static int  XBOX_VideoInit(_THIS);
@@ -111,10 +112,10 @@ XBOX_CreateDevice(void)
     device->DestroyWindow = XBOX_DestroyWindow;
     device->GetWindowWMInfo = NULL;
 
-    /* No software window framebuffer path on Xbox */
-    device->CreateWindowFramebuffer = NULL;
-    device->UpdateWindowFramebuffer = NULL;
-    device->DestroyWindowFramebuffer = NULL;
+    /* Window surface backed by a linear texture the GPU scales to the screen */
+    device->CreateWindowFramebuffer = XBOX_CreateWindowFramebuffer;
+    device->UpdateWindowFramebuffer = XBOX_UpdateWindowFramebuffer;
+    device->DestroyWindowFramebuffer = XBOX_DestroyWindowFramebuffer;
 
     /* Optional window niceties not used on Xbox */
     device->OnWindowEnter = NULL;
@@ -0,0 +1,719 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Direct3D 8 part of the XDK stand-in. Resources are plain host memory and
+   the device draws nothing; it counts the calls in mock_xdk. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mock_xdk.h"
+
+DWORD mock_xdk_video_flags = 0;
+DWORD mock_xdk_video_standard = XC_VIDEO_STANDARD_NTSC_M;
+
+struct IDirect3D8
+{
+    int refcount;
+};
+
+struct IDirect3DDevice8
+{
+    int refcount;
+    D3DPRESENT_PARAMETERS pparams;
+    IDirect3DSurface8 *backbuffer;
+    DWORD fence;
+};
+
+struct IDirect3DSurface8
+{
+    int refcount;
+    D3DSURFACE_DESC desc;
+    int pitch;
+    BYTE *bits;
+    IDirect3DTexture8 *parent;  /* level 0 of a texture, sharing its memory */
+};
+
+struct IDirect3DTexture8
+{
+    int refcount;
+    IDirect3DDevice8 *device;
+    IDirect3DSurface8 level;
+};
+
+struct IDirect3DVertexBuffer8
+{
+    int refcount;
+    BYTE *data;
+};
+
+struct IDirect3DIndexBuffer8
+{
+    int refcount;
+    BYTE *data;
+};
+
+struct IDirect3DPalette8
+{
+    int refcount;
+    D3DCOLOR colors[256];
+};
+
+struct IDirect3DPushBuffer8
+{
+    int refcount;
+    int draws;                  /* draw calls recorded into it */
+};
+
+static IDirect3D8 mock_d3d = { 1 };
+static IDirect3DPushBuffer8 *mock_recording = NULL;
+
+/* Bytes per texel, or per 4x4 block for the compressed formats. */
+static int
+MockFormatBytes(D3DFORMAT format, BOOL *blocks)
+{
+    *blocks = FALSE;
+    switch (format) {
+    case D3DFMT_DXT1:
+        *blocks = TRUE;
+        return 8;
+    case D3DFMT_DXT3:
+    case D3DFMT_DXT5:
+        *blocks = TRUE;
+        return 16;
+    case D3DFMT_L8:
+    case D3DFMT_LIN_L8:
+    case D3DFMT_P8:
+        return 1;
+    case D3DFMT_A8R8G8B8:
+    case D3DFMT_X8R8G8B8:
+    case D3DFMT_LIN_A8R8G8B8:
+    case D3DFMT_LIN_X8R8G8B8:
+        return 4;
+    default:
+        return 2;
+    }
+}
+
+static BOOL
+MockInitSurface(IDirect3DSurface8 *surface, UINT width, UINT height, D3DFORMAT format, DWORD usage)
+{
+    BOOL blocks;
+    const int bytes = MockFormatBytes(format, &blocks);
+    const UINT rows = blocks ? (height + 3) / 4 : height;
+
+    surface->refcount = 1;
+    surface->desc.Format = format;
+    surface->desc.Type = D3DRTYPE_SURFACE;
+    surface->desc.Usage = usage;
+    surface->desc.Width = width;
+    surface->desc.Height = height;
+    surface->pitch = (int)(blocks ? (width + 3) / 4 : width) * bytes;
+    surface->desc.Size = (UINT)surface->pitch * rows;
+    surface->bits = (BYTE *)calloc(1, surface->desc.Size ? surface->desc.Size : 1);
+    return surface->bits ? TRUE : FALSE;
+}
+
+static void
+MockCountDraw(D3DPRIMITIVETYPE type, UINT primcount)
+{
+    mock_xdk.draw_calls++;
+    if (type == D3DPT_QUADLIST) {
+        mock_xdk.quadlist_draws++;
+        mock_xdk.quads += (int)primcount;
+    }
+    if (mock_recording) {
+        mock_recording->draws++;
+    }
+}
+
+/* --------------------------------- Direct3D ------------------------------ */
+
+IDirect3D8 *
+Direct3DCreate8(UINT version)
+{
+    (void)version;
+    return &mock_d3d;
+}
+
+ULONG IDirect3D8_Release(IDirect3D8 *d3d) { (void)d3d; return 1; }
+
+HRESULT
+IDirect3D8_CreateDevice(IDirect3D8 *d3d, UINT adapter, D3DDEVTYPE type, void *window, DWORD flags,
+                        D3DPRESENT_PARAMETERS *pparams, IDirect3DDevice8 **device)
+{
+    IDirect3DDevice8 *dev = (IDirect3DDevice8 *)calloc(1, sizeof(*dev));
+    (void)d3d; (void)adapter; (void)type; (void)window; (void)flags;
+
+    if (!dev) {
+        return D3DERR_OUTOFVIDEOMEMORY;
+    }
+    dev->refcount = 1;
+    dev->pparams = *pparams;
+    dev->backbuffer = (IDirect3DSurface8 *)calloc(1, sizeof(*dev->backbuffer));
+    MockInitSurface(dev->backbuffer, pparams->BackBufferWidth, pparams->BackBufferHeight,
+                    pparams->BackBufferFormat, D3DUSAGE_RENDERTARGET);
+    *device = dev;
+    return D3D_OK;
+}
+
+/* ---------------------------------- Device ------------------------------- */
+
+ULONG IDirect3DDevice8_AddRef(IDirect3DDevice8 *device) { return (ULONG)++device->refcount; }
+
+ULONG
+IDirect3DDevice8_Release(IDirect3DDevice8 *device)
+{
+    const int refcount = --device->refcount;
+    if (refcount == 0) {
+        IDirect3DSurface8_Release(device->backbuffer);
+        free(device);
+    }
+    return (ULONG)refcount;
+}
+
+HRESULT IDirect3DDevice8_BeginScene(IDirect3DDevice8 *device) { (void)device; return D3D_OK; }
+HRESULT IDirect3DDevice8_EndScene(IDirect3DDevice8 *device) { (void)device; return D3D_OK; }
+
+HRESULT
+IDirect3DDevice8_Clear(IDirect3DDevice8 *device, DWORD count, const D3DRECT *rects, DWORD flags, D3DCOLOR color, float z, DWORD stencil)
+{
+    (void)device; (void)count; (void)rects; (void)flags; (void)color; (void)z; (void)stencil;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_CopyRects(IDirect3DDevice8 *device, IDirect3DSurface8 *src, const RECT *rects, UINT count,
+                           IDirect3DSurface8 *dst, const POINT *points)
+{
+    BOOL blocks;
+    const int bytes = MockFormatBytes(src->desc.Format, &blocks);
+    UINT i;
+    LONG row;
+
+    (void)device;
+    mock_xdk.copy_rects_calls++;
+    for (i = 0; i < count; ++i) {
+        const RECT *r = &rects[i];
+        const LONG dx = points ? points[i].x : r->left;
+        const LONG dy = points ? points[i].y : r->top;
+        for (row = 0; row < r->bottom - r->top; ++row) {
+            memcpy(dst->bits + (dy + row) * dst->pitch + dx * bytes,
+                   src->bits + (r->top + row) * src->pitch + r->left * bytes,
+                   (size_t)(r->right - r->left) * bytes);
+        }
+    }
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_CreateImageSurface(IDirect3DDevice8 *device, UINT width, UINT height, D3DFORMAT format, IDirect3DSurface8 **surface)
+{
+    IDirect3DSurface8 *s = (IDirect3DSurface8 *)calloc(1, sizeof(*s));
+    (void)device;
+    if (!s || !MockInitSurface(s, width, height, format, 0)) {
+        free(s);
+        return D3DERR_OUTOFVIDEOMEMORY;
+    }
+    *surface = s;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_CreateTexture(IDirect3DDevice8 *device, UINT width, UINT height, UINT levels, DWORD usage,
+                               D3DFORMAT format, D3DPOOL pool, IDirect3DTexture8 **texture)
+{
+    IDirect3DTexture8 *t = (IDirect3DTexture8 *)calloc(1, sizeof(*t));
+    (void)levels; (void)pool;
+    if (!t || !MockInitSurface(&t->level, width, height, format, usage)) {
+        free(t);
+        return D3DERR_OUTOFVIDEOMEMORY;
+    }
+    t->refcount = 1;
+    t->device = device;
+    t->level.desc.Type = D3DRTYPE_TEXTURE;
+    t->level.parent = t;
+    mock_xdk.textures_created++;
+    mock_xdk.textures_alive++;
+    *texture = t;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_CreateVertexBuffer(IDirect3DDevice8 *device, UINT length, DWORD usage, DWORD fvf, D3DPOOL pool,
+                                    IDirect3DVertexBuffer8 **buffer)
+{
+    IDirect3DVertexBuffer8 *b = (IDirect3DVertexBuffer8 *)calloc(1, sizeof(*b));
+    (void)device; (void)usage; (void)fvf; (void)pool;
+    if (!b || !(b->data = (BYTE *)calloc(1, length))) {
+        free(b);
+        return D3DERR_OUTOFVIDEOMEMORY;
+    }
+    b->refcount = 1;
+    *buffer = b;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_CreateIndexBuffer(IDirect3DDevice8 *device, UINT length, DWORD usage, D3DFORMAT format, D3DPOOL pool,
+                                   IDirect3DIndexBuffer8 **buffer)
+{
+    IDirect3DIndexBuffer8 *b = (IDirect3DIndexBuffer8 *)calloc(1, sizeof(*b));
+    (void)device; (void)usage; (void)format; (void)pool;
+    if (!b || !(b->data = (BYTE *)calloc(1, length))) {
+        free(b);
+        return D3DERR_OUTOFVIDEOMEMORY;
+    }
+    b->refcount = 1;
+    *buffer = b;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_CreatePalette(IDirect3DDevice8 *device, D3DPALETTESIZE size, IDirect3DPalette8 **palette)
+{
+    IDirect3DPalette8 *p = (IDirect3DPalette8 *)calloc(1, sizeof(*p));
+    (void)device; (void)size;
+    if (!p) {
+        return D3DERR_OUTOFVIDEOMEMORY;
+    }
+    p->refcount = 1;
+    *palette = p;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_CreatePushBuffer(IDirect3DDevice8 *device, UINT size, BOOL running, IDirect3DPushBuffer8 **buffer)
+{
+    IDirect3DPushBuffer8 *b = (IDirect3DPushBuffer8 *)calloc(1, sizeof(*b));
+    (void)device; (void)size; (void)running;
+    if (!b) {
+        return D3DERR_OUTOFVIDEOMEMORY;
+    }
+    b->refcount = 1;
+    *buffer = b;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_CreateVertexShader(IDirect3DDevice8 *device, const DWORD *decl, const DWORD *function, DWORD *handle, DWORD usage)
+{
+    (void)device; (void)decl; (void)function; (void)usage;
+    *handle = 0x1001;
+    return D3D_OK;
+}
+
+HRESULT IDirect3DDevice8_DeleteVertexShader(IDirect3DDevice8 *device, DWORD handle) { (void)device; (void)handle; return D3D_OK; }
+
+HRESULT
+IDirect3DDevice8_DrawPrimitive(IDirect3DDevice8 *device, D3DPRIMITIVETYPE type, UINT start, UINT primcount)
+{
+    (void)device; (void)start;
+    MockCountDraw(type, primcount);
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_DrawPrimitiveUP(IDirect3DDevice8 *device, D3DPRIMITIVETYPE type, UINT primcount, const void *data, UINT stride)
+{
+    (void)device; (void)data; (void)stride;
+    MockCountDraw(type, primcount);
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_DrawIndexedPrimitive(IDirect3DDevice8 *device, D3DPRIMITIVETYPE type, UINT minindex, UINT numvertices,
+                                      UINT start, UINT primcount)
+{
+    (void)device; (void)minindex; (void)numvertices; (void)start;
+    MockCountDraw(type, primcount);
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_DrawIndexedPrimitiveUP(IDirect3DDevice8 *device, D3DPRIMITIVETYPE type, UINT minindex, UINT numvertices,
+                                        UINT primcount, const void *indices, D3DFORMAT format, const void *data, UINT stride)
+{
+    (void)device; (void)minindex; (void)numvertices; (void)indices; (void)format; (void)data; (void)stride;
+    MockCountDraw(type, primcount);
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_DrawVertices(IDirect3DDevice8 *device, D3DPRIMITIVETYPE type, UINT start, UINT count)
+{
+    (void)device; (void)start;
+    MockCountDraw(type, (type == D3DPT_QUADLIST) ? count / 4 : count);
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_DrawVerticesUP(IDirect3DDevice8 *device, D3DPRIMITIVETYPE type, UINT count, const void *data, UINT stride)
+{
+    (void)device; (void)data; (void)stride;
+    MockCountDraw(type, (type == D3DPT_QUADLIST) ? count / 4 : count);
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_GetDeviceCaps(IDirect3DDevice8 *device, D3DCAPS8 *caps)
+{
+    (void)device;
+    caps->MaxTextureWidth = 4096;
+    caps->MaxTextureHeight = 4096;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_GetRenderTarget(IDirect3DDevice8 *device, IDirect3DSurface8 **surface)
+{
+    IDirect3DSurface8_AddRef(device->backbuffer);
+    *surface = device->backbuffer;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_GetBackBuffer(IDirect3DDevice8 *device, int index, DWORD type, IDirect3DSurface8 **surface)
+{
+    (void)index; (void)type;
+    return IDirect3DDevice8_GetRenderTarget(device, surface);
+}
+
+HRESULT
+IDirect3DDevice8_Present(IDirect3DDevice8 *device, const RECT *src, const RECT *dst, void *window, void *region)
+{
+    (void)device; (void)src; (void)dst; (void)window; (void)region;
+    mock_xdk.presents++;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_Reset(IDirect3DDevice8 *device, D3DPRESENT_PARAMETERS *pparams)
+{
+    device->pparams = *pparams;
+    mock_xdk.resets++;
+    return D3D_OK;
+}
+
+void IDirect3DDevice8_SetFlickerFilter(IDirect3DDevice8 *device, DWORD filter) { (void)device; (void)filter; }
+void IDirect3DDevice8_SetSoftDisplayFilter(IDirect3DDevice8 *device, BOOL enable) { (void)device; (void)enable; }
+HRESULT IDirect3DDevice8_SetScreenSpaceOffset(IDirect3DDevice8 *device, float x, float y) { (void)device; (void)x; (void)y; return D3D_OK; }
+
+HRESULT
+IDirect3DDevice8_SetRenderState(IDirect3DDevice8 *device, D3DRENDERSTATETYPE state, DWORD value)
+{
+    (void)device; (void)state; (void)value;
+    mock_xdk.render_state_calls++;
+    return D3D_OK;
+}
+
+HRESULT IDirect3DDevice8_SetRenderTarget(IDirect3DDevice8 *device, IDirect3DSurface8 *target, IDirect3DSurface8 *depth) { (void)device; (void)target; (void)depth; return D3D_OK; }
+HRESULT IDirect3DDevice8_SetScissors(IDirect3DDevice8 *device, DWORD count, BOOL exclusive, const D3DRECT *rects) { (void)device; (void)count; (void)exclusive; (void)rects; return D3D_OK; }
+HRESULT IDirect3DDevice8_SetStreamSource(IDirect3DDevice8 *device, UINT stream, IDirect3DVertexBuffer8 *buffer, UINT stride) { (void)device; (void)stream; (void)buffer; (void)stride; return D3D_OK; }
+HRESULT IDirect3DDevice8_SetIndices(IDirect3DDevice8 *device, IDirect3DIndexBuffer8 *buffer, UINT base) { (void)device; (void)buffer; (void)base; return D3D_OK; }
+
+HRESULT
+IDirect3DDevice8_SetTexture(IDirect3DDevice8 *device, DWORD stage, IDirect3DBaseTexture8 *texture)
+{
+    (void)device; (void)stage; (void)texture;
+    mock_xdk.set_texture_calls++;
+    return D3D_OK;
+}
+
+HRESULT IDirect3DDevice8_SetPalette(IDirect3DDevice8 *device, DWORD stage, IDirect3DPalette8 *palette) { (void)device; (void)stage; (void)palette; return D3D_OK; }
+
+HRESULT
+IDirect3DDevice8_SetTextureStageState(IDirect3DDevice8 *device, DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD value)
+{
+    (void)device; (void)stage; (void)type; (void)value;
+    mock_xdk.texture_stage_state_calls++;
+    return D3D_OK;
+}
+
+HRESULT IDirect3DDevice8_SetTransform(IDirect3DDevice8 *device, D3DTRANSFORMSTATETYPE type, const D3DMATRIX *matrix) { (void)device; (void)type; (void)matrix; return D3D_OK; }
+HRESULT IDirect3DDevice8_SetVertexShader(IDirect3DDevice8 *device, DWORD handle) { (void)device; (void)handle; return D3D_OK; }
+HRESULT IDirect3DDevice8_SetViewport(IDirect3DDevice8 *device, const D3DVIEWPORT8 *viewport) { (void)device; (void)viewport; return D3D_OK; }
+
+HRESULT
+IDirect3DDevice8_BeginPushBuffer(IDirect3DDevice8 *device, IDirect3DPushBuffer8 *buffer)
+{
+    (void)device;
+    if (mock_recording) {
+        return D3DERR_INVALIDCALL;
+    }
+    buffer->draws = 0;
+    mock_recording = buffer;
+    mock_xdk.recording = 1;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_EndPushBuffer(IDirect3DDevice8 *device)
+{
+    (void)device;
+    if (!mock_recording) {
+        return D3DERR_INVALIDCALL;
+    }
+    mock_recording = NULL;
+    mock_xdk.recording = 0;
+    mock_xdk.pushbuffers_recorded++;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DDevice8_RunPushBuffer(IDirect3DDevice8 *device, IDirect3DPushBuffer8 *buffer, void *fixups)
+{
+    (void)device; (void)buffer; (void)fixups;
+    mock_xdk.pushbuffer_runs++;
+    return D3D_OK;
+}
+
+void IDirect3DDevice8_KickPushBuffer(IDirect3DDevice8 *device) { (void)device; }
+void IDirect3DDevice8_BlockUntilIdle(IDirect3DDevice8 *device) { (void)device; }
+
+/* One 60 Hz field per vertical blank. */
+void
+IDirect3DDevice8_BlockUntilVerticalBlank(IDirect3DDevice8 *device)
+{
+    const ULONGLONG field = 16667;
+    (void)device;
+    MockXDK_Advance(field - (mock_xdk.time_us % field));
+}
+
+void
+IDirect3DDevice8_GetDisplayFieldStatus(IDirect3DDevice8 *device, D3DFIELD_STATUS *status)
+{
+    (void)device;
+    status->Field = D3DFIELD_PROGRESSIVE;
+    status->VBlankCount = (DWORD)(mock_xdk.time_us / 16667);
+}
+
+HRESULT
+IDirect3DDevice8_GetRasterStatus(IDirect3DDevice8 *device, D3DRASTER_STATUS *status)
+{
+    (void)device;
+    status->InVBlank = FALSE;
+    status->ScanLine = 0;
+    return D3D_OK;
+}
+
+/* The mock GPU finishes everything at once, so fences never stay pending. */
+DWORD
+IDirect3DDevice8_InsertFence(IDirect3DDevice8 *device)
+{
+    mock_xdk.fences_inserted++;
+    return ++device->fence;
+}
+
+BOOL IDirect3DDevice8_IsFencePending(IDirect3DDevice8 *device, DWORD fence) { (void)device; (void)fence; return FALSE; }
+
+void
+IDirect3DDevice8_BlockOnFence(IDirect3DDevice8 *device, DWORD fence)
+{
+    (void)device; (void)fence;
+    mock_xdk.fence_blocks++;
+}
+
+void
+IDirect3DDevice8_InsertCallback(IDirect3DDevice8 *device, D3DCALLBACKTYPE type, D3DCALLBACK callback, DWORD context)
+{
+    (void)device; (void)type;
+    callback(context);
+}
+
+/* -------------------------------- Resources ------------------------------ */
+
+ULONG
+IDirect3DPushBuffer8_Release(IDirect3DPushBuffer8 *buffer)
+{
+    const int refcount = --buffer->refcount;
+    if (refcount == 0) {
+        free(buffer);
+    }
+    return (ULONG)refcount;
+}
+
+ULONG
+IDirect3DPalette8_Release(IDirect3DPalette8 *palette)
+{
+    const int refcount = --palette->refcount;
+    if (refcount == 0) {
+        free(palette);
+    }
+    return (ULONG)refcount;
+}
+
+HRESULT IDirect3DPalette8_Lock(IDirect3DPalette8 *palette, D3DCOLOR **colors, DWORD flags) { (void)flags; *colors = palette->colors; return D3D_OK; }
+HRESULT IDirect3DPalette8_Unlock(IDirect3DPalette8 *palette) { (void)palette; return D3D_OK; }
+
+HRESULT
+IDirect3DBaseTexture8_GetDevice(IDirect3DBaseTexture8 *texture, IDirect3DDevice8 **device)
+{
+    IDirect3DTexture8 *t = (IDirect3DTexture8 *)texture;
+    IDirect3DDevice8_AddRef(t->device);
+    *device = t->device;
+    return D3D_OK;
+}
+
+BOOL IDirect3DResource8_IsBusy(IDirect3DResource8 *resource) { (void)resource; return FALSE; }
+
+ULONG
+IDirect3DSurface8_AddRef(IDirect3DSurface8 *surface)
+{
+    if (surface->parent) {
+        return IDirect3DTexture8_AddRef(surface->parent);
+    }
+    return (ULONG)++surface->refcount;
+}
+
+ULONG
+IDirect3DSurface8_Release(IDirect3DSurface8 *surface)
+{
+    int refcount;
+
+    if (surface->parent) {
+        return IDirect3DTexture8_Release(surface->parent);
+    }
+    refcount = --surface->refcount;
+    if (refcount == 0) {
+        free(surface->bits);
+        free(surface);
+    }
+    return (ULONG)refcount;
+}
+
+HRESULT IDirect3DSurface8_GetDesc(IDirect3DSurface8 *surface, D3DSURFACE_DESC *desc) { *desc = surface->desc; return D3D_OK; }
+
+HRESULT
+IDirect3DSurface8_LockRect(IDirect3DSurface8 *surface, D3DLOCKED_RECT *locked, const RECT *rect, DWORD flags)
+{
+    BOOL blocks;
+    const int bytes = MockFormatBytes(surface->desc.Format, &blocks);
+
+    (void)flags;
+    locked->Pitch = surface->pitch;
+    locked->pBits = surface->bits;
+    if (rect) {
+        locked->pBits = surface->bits + (blocks ? rect->top / 4 : rect->top) * surface->pitch +
+                        (blocks ? rect->left / 4 : rect->left) * bytes;
+    }
+    return D3D_OK;
+}
+
+HRESULT IDirect3DSurface8_UnlockRect(IDirect3DSurface8 *surface) { (void)surface; return D3D_OK; }
+
+ULONG IDirect3DTexture8_AddRef(IDirect3DTexture8 *texture) { return (ULONG)++texture->refcount; }
+
+ULONG
+IDirect3DTexture8_Release(IDirect3DTexture8 *texture)
+{
+    const int refcount = --texture->refcount;
+    if (refcount == 0) {
+        free(texture->level.bits);
+        free(texture);
+        mock_xdk.textures_alive--;
+    }
+    return (ULONG)refcount;
+}
+
+BOOL IDirect3DTexture8_IsBusy(IDirect3DTexture8 *texture) { (void)texture; return FALSE; }
+
+HRESULT
+IDirect3DTexture8_GetLevelDesc(IDirect3DTexture8 *texture, UINT level, D3DSURFACE_DESC *desc)
+{
+    if (level != 0) {
+        return D3DERR_INVALIDCALL;
+    }
+    *desc = texture->level.desc;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DTexture8_GetSurfaceLevel(IDirect3DTexture8 *texture, UINT level, IDirect3DSurface8 **surface)
+{
+    if (level != 0) {
+        return D3DERR_INVALIDCALL;
+    }
+    IDirect3DTexture8_AddRef(texture);
+    *surface = &texture->level;
+    return D3D_OK;
+}
+
+HRESULT
+IDirect3DTexture8_LockRect(IDirect3DTexture8 *texture, UINT level, D3DLOCKED_RECT *locked, const RECT *rect, DWORD flags)
+{
+    if (level != 0) {
+        return D3DERR_INVALIDCALL;
+    }
+    mock_xdk.texture_locks++;
+    return IDirect3DSurface8_LockRect(&texture->level, locked, rect, flags);
+}
+
+HRESULT IDirect3DTexture8_UnlockRect(IDirect3DTexture8 *texture, UINT level) { (void)texture; (void)level; return D3D_OK; }
+
+HRESULT
+IDirect3DVertexBuffer8_Lock(IDirect3DVertexBuffer8 *buffer, UINT offset, UINT size, BYTE **data, DWORD flags)
+{
+    (void)size; (void)flags;
+    *data = buffer->data + offset;
+    return D3D_OK;
+}
+
+HRESULT IDirect3DVertexBuffer8_Unlock(IDirect3DVertexBuffer8 *buffer) { (void)buffer; return D3D_OK; }
+
+ULONG
+IDirect3DVertexBuffer8_Release(IDirect3DVertexBuffer8 *buffer)
+{
+    const int refcount = --buffer->refcount;
+    if (refcount == 0) {
+        free(buffer->data);
+        free(buffer);
+    }
+    return (ULONG)refcount;
+}
+
+HRESULT
+IDirect3DIndexBuffer8_Lock(IDirect3DIndexBuffer8 *buffer, UINT offset, UINT size, BYTE **data, DWORD flags)
+{
+    (void)size; (void)flags;
+    *data = buffer->data + offset;
+    return D3D_OK;
+}
+
+HRESULT IDirect3DIndexBuffer8_Unlock(IDirect3DIndexBuffer8 *buffer) { (void)buffer; return D3D_OK; }
+
+ULONG
+IDirect3DIndexBuffer8_Release(IDirect3DIndexBuffer8 *buffer)
+{
+    const int refcount = --buffer->refcount;
+    if (refcount == 0) {
+        free(buffer->data);
+        free(buffer);
+    }
+    return (ULONG)refcount;
+}
+
+/* ------------------------------- Video mode ------------------------------ */
+
+DWORD XGetVideoFlags(void) { return mock_xdk_video_flags; }
+DWORD XGetVideoStandard(void) { return mock_xdk_video_standard; }
+
+/* vi: set ts=4 sw=4 expandtab: */
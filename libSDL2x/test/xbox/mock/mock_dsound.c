@@ -0,0 +1,324 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* DirectSound part of the XDK stand-in. A playing buffer moves its cursor
+   with the simulated clock and sets the notification events it passes. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mock_xdk.h"
+
+#define MOCK_MAX_NOTIFY 64
+
+struct IDirectSound
+{
+    int refcount;
+};
+
+struct IDirectSoundBuffer
+{
+    int refcount;
+    BYTE *bits;
+    DWORD size;
+    DWORD bytes_per_second;
+    BOOL playing;
+    ULONGLONG position;         /* bytes played since Play, unwrapped */
+    DWORD num_notify;
+    DSBPOSITIONNOTIFY notify[MOCK_MAX_NOTIFY];
+};
+
+static IDirectSound mock_dsound = { 0 };
+static LPDIRECTSOUNDBUFFER mock_buffer = NULL;
+
+/* Moves the play cursor of the buffer over the time that passed. */
+static void
+MockDSound_Tick(ULONGLONG from_us, ULONGLONG to_us)
+{
+    LPDIRECTSOUNDBUFFER buffer = mock_buffer;
+    ULONGLONG from, to, pos;
+    DWORD i;
+
+    if (!buffer || !buffer->playing) {
+        return;
+    }
+    from = buffer->position;
+    to = (to_us - mock_xdk.ds_play_started_us) * buffer->bytes_per_second / 1000000;
+    (void)from_us;
+    buffer->position = to;
+
+    for (i = 0; i < buffer->num_notify; ++i) {
+        /* first time past from that the cursor reaches this offset */
+        pos = from - (from % buffer->size) + buffer->notify[i].dwOffset;
+        if (pos <= from) {
+            pos += buffer->size;
+        }
+        if (pos <= to) {
+            SetEvent(buffer->notify[i].hEventNotify);
+        }
+    }
+}
+
+LPDIRECTSOUNDBUFFER
+MockDSound_GetBuffer(void)
+{
+    return mock_buffer;
+}
+
+DWORD
+MockDSound_GetPlayCursor(LPDIRECTSOUNDBUFFER buffer)
+{
+    return (DWORD)(buffer->position % buffer->size);
+}
+
+DWORD
+MockDSound_GetBufferBytes(LPDIRECTSOUNDBUFFER buffer)
+{
+    return buffer->size;
+}
+
+HRESULT
+DirectSoundCreate(LPGUID guid, LPDIRECTSOUND *sound, LPUNKNOWN outer)
+{
+    (void)guid; (void)outer;
+    mock_dsound.refcount++;
+    *sound = &mock_dsound;
+    return DS_OK;
+}
+
+void
+DirectSoundDoWork(void)
+{
+}
+
+ULONG
+IDirectSound_Release(LPDIRECTSOUND sound)
+{
+    return (ULONG)--sound->refcount;
+}
+
+HRESULT
+IDirectSound_SetMixBinHeadroom(LPDIRECTSOUND sound, DWORD mixbin, DWORD headroom)
+{
+    (void)sound; (void)mixbin; (void)headroom;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSound_CreateSoundBuffer(LPDIRECTSOUND sound, const DSBUFFERDESC *desc, LPDIRECTSOUNDBUFFER *buffer, LPUNKNOWN outer)
+{
+    LPDIRECTSOUNDBUFFER result;
+
+    (void)sound; (void)outer;
+    if (!desc->lpwfxFormat || desc->dwBufferBytes < DSBSIZE_MIN) {
+        return DSERR_INVALIDCALL;
+    }
+    result = (LPDIRECTSOUNDBUFFER)calloc(1, sizeof(*result));
+    if (!result || !(result->bits = (BYTE *)calloc(1, desc->dwBufferBytes))) {
+        free(result);
+        return DSERR_OUTOFMEMORY;
+    }
+    result->refcount = 1;
+    result->size = desc->dwBufferBytes;
+    result->bytes_per_second = desc->lpwfxFormat->nAvgBytesPerSec;
+    mock_buffer = result;
+    mock_xdk_tick = MockDSound_Tick;
+    *buffer = result;
+    return DS_OK;
+}
+
+ULONG
+IDirectSoundBuffer_Release(LPDIRECTSOUNDBUFFER buffer)
+{
+    const int refcount = --buffer->refcount;
+    if (refcount == 0) {
+        if (mock_buffer == buffer) {
+            mock_buffer = NULL;
+        }
+        free(buffer->bits);
+        free(buffer);
+    }
+    return (ULONG)refcount;
+}
+
+/* The write cursor is the play cursor: the mock has no hardware lead. */
+HRESULT
+IDirectSoundBuffer_GetCurrentPosition(LPDIRECTSOUNDBUFFER buffer, LPDWORD play, LPDWORD write)
+{
+    const DWORD cursor = MockDSound_GetPlayCursor(buffer);
+    if (play) {
+        *play = cursor;
+    }
+    if (write) {
+        *write = cursor;
+    }
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_GetStatus(LPDIRECTSOUNDBUFFER buffer, LPDWORD status)
+{
+    *status = buffer->playing ? DSBSTATUS_PLAYING : 0;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_Play(LPDIRECTSOUNDBUFFER buffer, DWORD reserved1, DWORD reserved2, DWORD flags)
+{
+    (void)reserved1; (void)reserved2; (void)flags;
+    mock_xdk.ds_play_calls++;
+    if (!buffer->playing) {
+        buffer->playing = TRUE;
+        buffer->position = 0;
+        mock_xdk.ds_play_started_us = mock_xdk.time_us;
+    }
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_Stop(LPDIRECTSOUNDBUFFER buffer)
+{
+    mock_xdk.ds_stop_calls++;
+    buffer->playing = FALSE;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_Lock(LPDIRECTSOUNDBUFFER buffer, DWORD offset, DWORD bytes, LPVOID *ptr1, LPDWORD bytes1,
+                        LPVOID *ptr2, LPDWORD bytes2, DWORD flags)
+{
+    if (flags & DSBLOCK_ENTIREBUFFER) {
+        offset = 0;
+        bytes = buffer->size;
+    }
+    if (offset >= buffer->size || bytes > buffer->size) {
+        return DSERR_INVALIDCALL;
+    }
+    *ptr1 = buffer->bits + offset;
+    if (offset + bytes <= buffer->size) {
+        *bytes1 = bytes;
+        if (ptr2) {
+            *ptr2 = NULL;
+        }
+        if (bytes2) {
+            *bytes2 = 0;
+        }
+    } else {
+        *bytes1 = buffer->size - offset;
+        if (!ptr2 || !bytes2) {
+            return DSERR_INVALIDCALL;
+        }
+        *ptr2 = buffer->bits;
+        *bytes2 = bytes - *bytes1;
+    }
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_Unlock(LPDIRECTSOUNDBUFFER buffer, LPVOID ptr1, DWORD bytes1, LPVOID ptr2, DWORD bytes2)
+{
+    (void)buffer; (void)ptr1; (void)bytes1; (void)ptr2; (void)bytes2;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetFormat(LPDIRECTSOUNDBUFFER buffer, const WAVEFORMATEX *format)
+{
+    buffer->bytes_per_second = format->nAvgBytesPerSec;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetHeadroom(LPDIRECTSOUNDBUFFER buffer, DWORD headroom)
+{
+    (void)buffer; (void)headroom;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetMixBins(LPDIRECTSOUNDBUFFER buffer, DSMIXBINS *mixbins)
+{
+    (void)buffer; (void)mixbins;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetVolume(LPDIRECTSOUNDBUFFER buffer, LONG volume)
+{
+    (void)buffer; (void)volume;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetFrequency(LPDIRECTSOUNDBUFFER buffer, DWORD frequency)
+{
+    (void)buffer; (void)frequency;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetPitch(LPDIRECTSOUNDBUFFER buffer, LONG pitch)
+{
+    (void)buffer; (void)pitch;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetCurrentPosition(LPDIRECTSOUNDBUFFER buffer, DWORD position)
+{
+    buffer->position = position;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetBufferData(LPDIRECTSOUNDBUFFER buffer, LPVOID data, DWORD bytes)
+{
+    (void)buffer; (void)data; (void)bytes;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetLoopRegion(LPDIRECTSOUNDBUFFER buffer, DWORD start, DWORD length)
+{
+    (void)buffer; (void)start; (void)length;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetNotificationPositions(LPDIRECTSOUNDBUFFER buffer, DWORD count, LPCDSBPOSITIONNOTIFY notify)
+{
+    if (count > MOCK_MAX_NOTIFY) {
+        return DSERR_INVALIDCALL;
+    }
+    memcpy(buffer->notify, notify, count * sizeof(*notify));
+    buffer->num_notify = count;
+    mock_xdk.ds_notify_positions += (int)count;
+    return DS_OK;
+}
+
+HRESULT
+IDirectSoundBuffer_SetPosition(LPDIRECTSOUNDBUFFER buffer, FLOAT x, FLOAT y, FLOAT z, DWORD apply)
+{
+    (void)buffer; (void)x; (void)y; (void)z; (void)apply;
+    return DS_OK;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,154 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Win32 parts of the XDK stand-in: a simulated clock and events. */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mock_xdk.h"
+
+MockXDK mock_xdk;
+void (*mock_xdk_tick)(ULONGLONG from_us, ULONGLONG to_us) = NULL;
+
+typedef struct
+{
+    BOOL manual_reset;
+    BOOL signaled;
+} MockEvent;
+
+void
+MockXDK_ResetCounters(void)
+{
+    const ULONGLONG now = mock_xdk.time_us;
+    memset(&mock_xdk, 0, sizeof(mock_xdk));
+    mock_xdk.time_us = now;
+}
+
+void
+MockXDK_Advance(ULONGLONG us)
+{
+    const ULONGLONG from = mock_xdk.time_us;
+    mock_xdk.time_us += us;
+    if (mock_xdk_tick) {
+        mock_xdk_tick(from, mock_xdk.time_us);
+    }
+}
+
+int
+_snprintf(char *buf, size_t size, const char *fmt, ...)
+{
+    va_list ap;
+    int result;
+
+    va_start(ap, fmt);
+    result = vsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return result;
+}
+
+HANDLE
+CreateEvent(void *attributes, BOOL manual_reset, BOOL initial_state, const char *name)
+{
+    MockEvent *event = (MockEvent *)calloc(1, sizeof(*event));
+    (void)attributes;
+    (void)name;
+    if (event) {
+        event->manual_reset = manual_reset;
+        event->signaled = initial_state;
+    }
+    return event;
+}
+
+BOOL
+SetEvent(HANDLE handle)
+{
+    ((MockEvent *)handle)->signaled = TRUE;
+    return TRUE;
+}
+
+BOOL
+ResetEvent(HANDLE handle)
+{
+    ((MockEvent *)handle)->signaled = FALSE;
+    return TRUE;
+}
+
+BOOL
+CloseHandle(HANDLE handle)
+{
+    free(handle);
+    return TRUE;
+}
+
+/* Runs the clock in 100us steps until the event is set or the timeout
+   passes. */
+DWORD
+WaitForSingleObject(HANDLE handle, DWORD ms)
+{
+    MockEvent *event = (MockEvent *)handle;
+    const ULONGLONG end = (ms == INFINITE) ? ~0ull : mock_xdk.time_us + (ULONGLONG)ms * 1000;
+
+    mock_xdk.event_waits++;
+    for (;;) {
+        if (event->signaled) {
+            if (!event->manual_reset) {
+                event->signaled = FALSE;
+            }
+            mock_xdk.event_wakeups++;
+            return WAIT_OBJECT_0;
+        }
+        if (mock_xdk.time_us >= end) {
+            return WAIT_TIMEOUT;
+        }
+        MockXDK_Advance((end - mock_xdk.time_us < 100) ? end - mock_xdk.time_us : 100);
+    }
+}
+
+void
+Sleep(DWORD ms)
+{
+    MockXDK_Advance((ULONGLONG)ms * 1000);
+}
+
+DWORD
+GetTickCount(void)
+{
+    return (DWORD)(mock_xdk.time_us / 1000);
+}
+
+BOOL
+QueryPerformanceCounter(LARGE_INTEGER *counter)
+{
+    counter->QuadPart = (LONGLONG)mock_xdk.time_us;
+    return TRUE;
+}
+
+BOOL
+QueryPerformanceFrequency(LARGE_INTEGER *frequency)
+{
+    frequency->QuadPart = 1000000;
+    return TRUE;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,87 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* What the XDK stand-in recorded, for the tests to check. */
+
+#ifndef mock_xdk_h_
+#define mock_xdk_h_
+
+#include <xtl.h>
+
+typedef struct MockXDK
+{
+    /* Simulated clock, advanced by Sleep(), waits and vertical blanks. */
+    ULONGLONG time_us;
+
+    /* Direct3D device calls */
+    int draw_calls;             /* every Draw*Primitive* / DrawVertices* call */
+    int quadlist_draws;         /* draws with D3DPT_QUADLIST */
+    int quads;                  /* primitives drawn by those */
+    int render_state_calls;
+    int texture_stage_state_calls;
+    int set_texture_calls;
+    int copy_rects_calls;
+    int texture_locks;
+    int textures_created;
+    int textures_alive;
+    int fences_inserted;
+    int fence_blocks;
+    int pushbuffers_recorded;
+    int pushbuffer_runs;
+    int presents;
+    int resets;
+    int recording;              /* between BeginPushBuffer and EndPushBuffer */
+
+    /* DirectSound buffer calls */
+    int ds_play_calls;
+    int ds_stop_calls;
+    int ds_notify_positions;
+    ULONGLONG ds_play_started_us;
+
+    /* Win32 */
+    int event_waits;            /* WaitForSingleObject calls */
+    int event_wakeups;          /* ... that returned WAIT_OBJECT_0 */
+} MockXDK;
+
+extern MockXDK mock_xdk;
+
+/* Clears the counters; the clock keeps running. */
+extern void MockXDK_ResetCounters(void);
+
+/* Moves the simulated clock forward, running whatever depends on time
+   (the DirectSound play cursor). */
+extern void MockXDK_Advance(ULONGLONG us);
+
+/* Called by MockXDK_Advance; the DirectSound mock installs one. */
+extern void (*mock_xdk_tick)(ULONGLONG from_us, ULONGLONG to_us);
+
+/* Video flags and standard reported by XGetVideoFlags/XGetVideoStandard. */
+extern DWORD mock_xdk_video_flags;
+extern DWORD mock_xdk_video_standard;
+
+/* DirectSound: the last secondary buffer created, its play cursor and size. */
+extern LPDIRECTSOUNDBUFFER MockDSound_GetBuffer(void);
+extern DWORD MockDSound_GetPlayCursor(LPDIRECTSOUNDBUFFER buffer);
+extern DWORD MockDSound_GetBufferBytes(LPDIRECTSOUNDBUFFER buffer);
+
+#endif /* mock_xdk_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
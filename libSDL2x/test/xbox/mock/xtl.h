@@ -0,0 +1,423 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Host stand-in for the parts of the XDK headers the Xbox backends use.
+
+   Only declarations live here; mock_xdk.c implements them on top of host
+   memory and records what the backends asked for in MockXDK (mock_xdk.h).
+   Values match the XDK where the backends or the tests depend on them. */
+
+#ifndef XTL_MOCK_H
+#define XTL_MOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ----------------------------- Win32 basics ------------------------------ */
+
+#ifndef __cdecl
+#define __cdecl
+#endif
+#define WINAPI
+#define VOID void
+#define CONST const
+#define FAR
+
+typedef int BOOL;
+typedef unsigned char UCHAR;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef unsigned long DWORD;
+typedef long LONG;
+typedef unsigned int UINT;
+typedef long HRESULT;
+typedef float FLOAT;
+typedef void *HANDLE;
+typedef void *LPVOID;
+typedef DWORD *LPDWORD;
+typedef DWORD *PDWORD;
+typedef long long LONGLONG;
+typedef unsigned long long ULONGLONG;
+typedef unsigned long ULONG;
+typedef short SHORT;
+typedef char CHAR;
+typedef unsigned short WCHAR;
+
+typedef union {
+    struct { DWORD LowPart; LONG HighPart; };
+    struct { DWORD LowPart; LONG HighPart; } u;
+    LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+#define TRUE 1
+#define FALSE 0
+#define FAILED(h) ((HRESULT)(h) < 0)
+#define SUCCEEDED(h) ((HRESULT)(h) >= 0)
+#define S_OK 0
+#define E_FAIL ((HRESULT)0x80004005L)
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 258
+
+typedef struct { LONG left, top, right, bottom; } RECT;
+typedef struct { LONG x, y; } POINT;
+
+int _snprintf(char *, size_t, const char *, ...);
+DWORD WaitForSingleObject(HANDLE, DWORD);
+HANDLE CreateEvent(void *, BOOL, BOOL, const char *);
+BOOL SetEvent(HANDLE);
+BOOL ResetEvent(HANDLE);
+BOOL CloseHandle(HANDLE);
+void Sleep(DWORD);
+DWORD GetTickCount(void);
+BOOL QueryPerformanceCounter(LARGE_INTEGER *);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER *);
+
+/* ------------------------------- Direct3D 8 ------------------------------ */
+
+typedef DWORD D3DCOLOR;
+#define D3DCOLOR_ARGB(a,r,g,b) ((D3DCOLOR)(((DWORD)((a)&0xff)<<24)|(((r)&0xff)<<16)|(((g)&0xff)<<8)|((b)&0xff)))
+
+typedef enum {
+    D3DFMT_L8 = 0x00, D3DFMT_A1R5G5B5 = 0x02, D3DFMT_X1R5G5B5 = 0x03, D3DFMT_A4R4G4B4 = 0x04,
+    D3DFMT_R5G6B5 = 0x05, D3DFMT_A8R8G8B8 = 0x06, D3DFMT_X8R8G8B8 = 0x07, D3DFMT_P8 = 0x0b,
+    D3DFMT_DXT1 = 0x0c, D3DFMT_DXT2 = 0x0e, D3DFMT_DXT3 = 0x0e, D3DFMT_DXT4 = 0x0f, D3DFMT_DXT5 = 0x0f,
+    D3DFMT_LIN_A1R5G5B5 = 0x10, D3DFMT_LIN_R5G6B5 = 0x11, D3DFMT_LIN_A8R8G8B8 = 0x12,
+    D3DFMT_LIN_L8 = 0x13, D3DFMT_LIN_X1R5G5B5 = 0x1c, D3DFMT_LIN_A4R4G4B4 = 0x1d,
+    D3DFMT_LIN_X8R8G8B8 = 0x1e, D3DFMT_YUY2 = 0x24, D3DFMT_UYVY = 0x25,
+    D3DFMT_D16 = 0x2c, D3DFMT_LIN_D16 = 0x30, D3DFMT_INDEX16 = 101,
+    D3DFMT_UNKNOWN = 0x7fffffff
+} D3DFORMAT;
+typedef enum { D3DPOOL_DEFAULT = 0, D3DPOOL_MANAGED = 1, D3DPOOL_SYSTEMMEM = 2 } D3DPOOL;
+typedef enum {
+    D3DPT_POINTLIST = 1, D3DPT_LINELIST = 2, D3DPT_LINELOOP = 3, D3DPT_LINESTRIP = 4,
+    D3DPT_TRIANGLELIST = 5, D3DPT_TRIANGLESTRIP = 6, D3DPT_TRIANGLEFAN = 7,
+    D3DPT_QUADLIST = 8, D3DPT_QUADSTRIP = 9, D3DPT_POLYGON = 10
+} D3DPRIMITIVETYPE;
+typedef enum { D3DTEXF_NONE = 0, D3DTEXF_POINT = 1, D3DTEXF_LINEAR = 2 } D3DTEXTUREFILTERTYPE;
+typedef enum {
+    D3DBLEND_ZERO = 0, D3DBLEND_ONE = 1, D3DBLEND_SRCCOLOR = 0x300, D3DBLEND_INVSRCCOLOR,
+    D3DBLEND_SRCALPHA, D3DBLEND_INVSRCALPHA, D3DBLEND_DESTALPHA, D3DBLEND_INVDESTALPHA,
+    D3DBLEND_DESTCOLOR, D3DBLEND_INVDESTCOLOR
+} D3DBLEND;
+typedef enum {
+    D3DRS_ZENABLE, D3DRS_ZWRITEENABLE, D3DRS_CULLMODE, D3DRS_LIGHTING, D3DRS_ALPHABLENDENABLE,
+    D3DRS_SRCBLEND, D3DRS_DESTBLEND, D3DRS_ALPHATESTENABLE, D3DRS_BLENDOP, D3DRS_SWATHWIDTH,
+    D3DRS_TEXTUREFACTOR, D3DRS_MAX
+} D3DRENDERSTATETYPE;
+typedef enum {
+    D3DTSS_COLOROP, D3DTSS_COLORARG1, D3DTSS_COLORARG2, D3DTSS_ALPHAOP, D3DTSS_ALPHAARG1,
+    D3DTSS_ALPHAARG2, D3DTSS_ADDRESSU, D3DTSS_ADDRESSV, D3DTSS_MAGFILTER, D3DTSS_MINFILTER,
+    D3DTSS_MIPFILTER, D3DTSS_COLORKEYOP, D3DTSS_COLORSIGN, D3DTSS_MAX
+} D3DTEXTURESTAGESTATETYPE;
+typedef enum { D3DTS_VIEW = 2, D3DTS_PROJECTION = 3, D3DTS_WORLD = 256 } D3DTRANSFORMSTATETYPE;
+typedef enum { D3DDEVTYPE_HAL = 1 } D3DDEVTYPE;
+typedef enum { D3DSWAPEFFECT_DISCARD = 1, D3DSWAPEFFECT_FLIP = 2, D3DSWAPEFFECT_COPY = 3 } D3DSWAPEFFECT;
+typedef enum { D3DMULTISAMPLE_NONE = 0 } D3DMULTISAMPLE_TYPE;
+typedef enum { D3DRTYPE_SURFACE = 1, D3DRTYPE_TEXTURE = 3 } D3DRESOURCETYPE;
+typedef enum { D3DPALETTE_SIZE_256 = 0 } D3DPALETTESIZE;
+typedef enum { D3DCALLBACK_READ = 0, D3DCALLBACK_WRITE = 1 } D3DCALLBACKTYPE;
+
+#define D3DZB_FALSE 0
+#define D3DCULL_NONE 0
+#define D3DTADDRESS_WRAP 1
+#define D3DTADDRESS_CLAMP 3
+#define D3DTOP_DISABLE 1
+#define D3DTOP_SELECTARG1 2
+#define D3DTOP_MODULATE 4
+#define D3DTA_DIFFUSE 0
+#define D3DTA_CURRENT 1
+#define D3DTA_TEXTURE 2
+#define D3DTA_TFACTOR 3
+#define D3DCLEAR_TARGET 1
+#define D3DCREATE_HARDWARE_VERTEXPROCESSING 0x40
+#define D3DPRESENTFLAG_WIDESCREEN 0x10
+#define D3DPRESENTFLAG_INTERLACED 0x20
+#define D3DPRESENTFLAG_PROGRESSIVE 0x40
+#define D3DPRESENT_INTERVAL_DEFAULT 0
+#define D3DPRESENT_INTERVAL_ONE 1
+#define D3DPRESENT_INTERVAL_TWO 2
+#define D3DPRESENT_INTERVAL_IMMEDIATE 0x80000000
+#define D3DUSAGE_RENDERTARGET 1
+#define D3DUSAGE_WRITEONLY 8
+#define D3DUSAGE_DYNAMIC 0x200
+#define D3DLOCK_READONLY 0x10
+#define D3DLOCK_NOOVERWRITE 0x1000
+#define D3DLOCK_DISCARD 0x2000
+#define D3DLOCK_NOFLUSH 0x10000
+#define D3DFVF_XYZ 0x2
+#define D3DFVF_XYZRHW 0x4
+#define D3DFVF_DIFFUSE 0x40
+#define D3DFVF_TEX1 0x100
+#define D3DSDE_POSITION 0
+#define D3DSDE_DIFFUSE 3
+#define D3DSDE_TEXCOORD0 9
+#define D3DPALETTE_256 0
+#define D3DFIELD_ODD 1
+#define D3DFIELD_EVEN 2
+#define D3DFIELD_PROGRESSIVE 3
+#define D3D_OK 0
+#define D3D_SDK_VERSION 220
+
+#define D3DERR_OUTOFVIDEOMEMORY ((HRESULT)0x8876017c)
+#define D3DERR_WRONGTEXTUREFORMAT ((HRESULT)0x88760818)
+#define D3DERR_UNSUPPORTEDCOLOROPERATION ((HRESULT)0x88760819)
+#define D3DERR_UNSUPPORTEDCOLORARG ((HRESULT)0x8876081a)
+#define D3DERR_UNSUPPORTEDALPHAOPERATION ((HRESULT)0x8876081b)
+#define D3DERR_UNSUPPORTEDALPHAARG ((HRESULT)0x8876081c)
+#define D3DERR_TOOMANYOPERATIONS ((HRESULT)0x8876081d)
+#define D3DERR_CONFLICTINGTEXTUREFILTER ((HRESULT)0x8876081e)
+#define D3DERR_UNSUPPORTEDTEXTUREFILTER ((HRESULT)0x8876081f)
+#define D3DERR_CONFLICTINGTEXTUREPALETTE ((HRESULT)0x88760826)
+#define D3DERR_DRIVERINTERNALERROR ((HRESULT)0x88760827)
+#define D3DERR_NOTFOUND ((HRESULT)0x88760866)
+#define D3DERR_MOREDATA ((HRESULT)0x88760867)
+#define D3DERR_DEVICELOST ((HRESULT)0x88760868)
+#define D3DERR_DEVICENOTRESET ((HRESULT)0x88760869)
+#define D3DERR_NOTAVAILABLE ((HRESULT)0x8876086a)
+#define D3DERR_INVALIDDEVICE ((HRESULT)0x8876086b)
+#define D3DERR_INVALIDCALL ((HRESULT)0x8876086c)
+
+#define D3DVSD_STREAM(s) (0x10000000|(s))
+#define D3DVSD_REG(r,t) (0x20000000|((t)<<16)|(r))
+#define D3DVSD_END() 0xFFFFFFFF
+#define D3DVSDE_POSITION 0
+#define D3DVSDE_DIFFUSE 3
+#define D3DVSDE_TEXCOORD0 9
+#define D3DVSDT_FLOAT2 0x21
+#define D3DVSDT_D3DCOLOR 0x40
+
+#define XC_VIDEO_FLAGS_WIDESCREEN 1
+#define XC_VIDEO_FLAGS_HDTV_720p 2
+#define XC_VIDEO_FLAGS_HDTV_1080i 4
+#define XC_VIDEO_FLAGS_HDTV_480p 8
+#define XC_VIDEO_FLAGS_PAL_60Hz 0x40
+#define XC_VIDEO_STANDARD_NTSC_M 1
+#define XC_VIDEO_STANDARD_PAL_I 3
+
+typedef struct { LONG x1, y1, x2, y2; } D3DRECT;
+typedef struct { DWORD X, Y, Width, Height; float MinZ, MaxZ; } D3DVIEWPORT8;
+typedef struct {
+    union {
+        struct { float _11, _12, _13, _14, _21, _22, _23, _24, _31, _32, _33, _34, _41, _42, _43, _44; };
+        float m[4][4];
+    };
+} D3DMATRIX;
+typedef struct { int Pitch; void *pBits; } D3DLOCKED_RECT;
+typedef struct {
+    D3DFORMAT Format; D3DRESOURCETYPE Type; DWORD Usage; UINT Size;
+    D3DMULTISAMPLE_TYPE MultiSampleType; UINT Width; UINT Height;
+} D3DSURFACE_DESC;
+typedef struct { UINT MaxTextureWidth, MaxTextureHeight; } D3DCAPS8;
+typedef struct {
+    UINT BackBufferWidth, BackBufferHeight; D3DFORMAT BackBufferFormat; UINT BackBufferCount;
+    D3DMULTISAMPLE_TYPE MultiSampleType; D3DSWAPEFFECT SwapEffect; void *hDeviceWindow; BOOL Windowed;
+    BOOL EnableAutoDepthStencil; D3DFORMAT AutoDepthStencilFormat; DWORD Flags;
+    UINT FullScreen_RefreshRateInHz; UINT FullScreen_PresentationInterval;
+    void *BufferSurfaces[3]; void *DepthStencilSurface;
+} D3DPRESENT_PARAMETERS;
+typedef struct { BOOL InVBlank; UINT ScanLine; } D3DRASTER_STATUS;
+typedef struct { DWORD Field; DWORD VBlankCount; } D3DFIELD_STATUS;
+
+typedef struct IDirect3D8 IDirect3D8;
+typedef struct IDirect3DDevice8 IDirect3DDevice8;
+typedef struct IDirect3DResource8 IDirect3DResource8;
+typedef struct IDirect3DBaseTexture8 IDirect3DBaseTexture8;
+typedef struct IDirect3DTexture8 IDirect3DTexture8;
+typedef struct IDirect3DSurface8 IDirect3DSurface8;
+typedef struct IDirect3DVertexBuffer8 IDirect3DVertexBuffer8;
+typedef struct IDirect3DIndexBuffer8 IDirect3DIndexBuffer8;
+typedef struct IDirect3DPalette8 IDirect3DPalette8;
+typedef struct IDirect3DPushBuffer8 IDirect3DPushBuffer8;
+typedef IDirect3DPushBuffer8 D3DPushBuffer;
+typedef IDirect3DPalette8 D3DPalette;
+typedef IDirect3DVertexBuffer8 *LPDIRECT3DVERTEXBUFFER8;
+typedef IDirect3DSurface8 *LPDIRECT3DSURFACE8;
+typedef IDirect3DTexture8 *LPDIRECT3DTEXTURE8;
+typedef IDirect3DIndexBuffer8 *LPDIRECT3DINDEXBUFFER8;
+typedef void (__cdecl *D3DCALLBACK)(DWORD);
+
+IDirect3D8 *Direct3DCreate8(UINT);
+HRESULT IDirect3D8_CreateDevice(IDirect3D8 *, UINT, D3DDEVTYPE, void *, DWORD, D3DPRESENT_PARAMETERS *, IDirect3DDevice8 **);
+ULONG IDirect3D8_Release(IDirect3D8 *);
+
+ULONG IDirect3DDevice8_AddRef(IDirect3DDevice8 *);
+ULONG IDirect3DDevice8_Release(IDirect3DDevice8 *);
+HRESULT IDirect3DDevice8_BeginScene(IDirect3DDevice8 *);
+HRESULT IDirect3DDevice8_EndScene(IDirect3DDevice8 *);
+HRESULT IDirect3DDevice8_Clear(IDirect3DDevice8 *, DWORD, const D3DRECT *, DWORD, D3DCOLOR, float, DWORD);
+HRESULT IDirect3DDevice8_CopyRects(IDirect3DDevice8 *, IDirect3DSurface8 *, const RECT *, UINT, IDirect3DSurface8 *, const POINT *);
+HRESULT IDirect3DDevice8_CreateImageSurface(IDirect3DDevice8 *, UINT, UINT, D3DFORMAT, IDirect3DSurface8 **);
+HRESULT IDirect3DDevice8_CreateTexture(IDirect3DDevice8 *, UINT, UINT, UINT, DWORD, D3DFORMAT, D3DPOOL, IDirect3DTexture8 **);
+HRESULT IDirect3DDevice8_CreateVertexBuffer(IDirect3DDevice8 *, UINT, DWORD, DWORD, D3DPOOL, IDirect3DVertexBuffer8 **);
+HRESULT IDirect3DDevice8_CreateIndexBuffer(IDirect3DDevice8 *, UINT, DWORD, D3DFORMAT, D3DPOOL, IDirect3DIndexBuffer8 **);
+HRESULT IDirect3DDevice8_CreatePalette(IDirect3DDevice8 *, D3DPALETTESIZE, IDirect3DPalette8 **);
+HRESULT IDirect3DDevice8_CreatePushBuffer(IDirect3DDevice8 *, UINT, BOOL, IDirect3DPushBuffer8 **);
+HRESULT IDirect3DDevice8_CreateVertexShader(IDirect3DDevice8 *, const DWORD *, const DWORD *, DWORD *, DWORD);
+HRESULT IDirect3DDevice8_DeleteVertexShader(IDirect3DDevice8 *, DWORD);
+HRESULT IDirect3DDevice8_DrawPrimitive(IDirect3DDevice8 *, D3DPRIMITIVETYPE, UINT, UINT);
+HRESULT IDirect3DDevice8_DrawPrimitiveUP(IDirect3DDevice8 *, D3DPRIMITIVETYPE, UINT, const void *, UINT);
+HRESULT IDirect3DDevice8_DrawIndexedPrimitive(IDirect3DDevice8 *, D3DPRIMITIVETYPE, UINT, UINT, UINT, UINT);
+HRESULT IDirect3DDevice8_DrawIndexedPrimitiveUP(IDirect3DDevice8 *, D3DPRIMITIVETYPE, UINT, UINT, UINT, const void *, D3DFORMAT, const void *, UINT);
+HRESULT IDirect3DDevice8_DrawVertices(IDirect3DDevice8 *, D3DPRIMITIVETYPE, UINT, UINT);
+HRESULT IDirect3DDevice8_DrawVerticesUP(IDirect3DDevice8 *, D3DPRIMITIVETYPE, UINT, const void *, UINT);
+HRESULT IDirect3DDevice8_GetDeviceCaps(IDirect3DDevice8 *, D3DCAPS8 *);
+HRESULT IDirect3DDevice8_GetRenderTarget(IDirect3DDevice8 *, IDirect3DSurface8 **);
+HRESULT IDirect3DDevice8_GetBackBuffer(IDirect3DDevice8 *, int, DWORD, IDirect3DSurface8 **);
+HRESULT IDirect3DDevice8_Present(IDirect3DDevice8 *, const RECT *, const RECT *, void *, void *);
+HRESULT IDirect3DDevice8_Reset(IDirect3DDevice8 *, D3DPRESENT_PARAMETERS *);
+void IDirect3DDevice8_SetFlickerFilter(IDirect3DDevice8 *, DWORD);
+void IDirect3DDevice8_SetSoftDisplayFilter(IDirect3DDevice8 *, BOOL);
+HRESULT IDirect3DDevice8_SetScreenSpaceOffset(IDirect3DDevice8 *, float, float);
+HRESULT IDirect3DDevice8_SetRenderState(IDirect3DDevice8 *, D3DRENDERSTATETYPE, DWORD);
+HRESULT IDirect3DDevice8_SetRenderTarget(IDirect3DDevice8 *, IDirect3DSurface8 *, IDirect3DSurface8 *);
+HRESULT IDirect3DDevice8_SetScissors(IDirect3DDevice8 *, DWORD, BOOL, const D3DRECT *);
+HRESULT IDirect3DDevice8_SetStreamSource(IDirect3DDevice8 *, UINT, IDirect3DVertexBuffer8 *, UINT);
+HRESULT IDirect3DDevice8_SetIndices(IDirect3DDevice8 *, IDirect3DIndexBuffer8 *, UINT);
+HRESULT IDirect3DDevice8_SetTexture(IDirect3DDevice8 *, DWORD, IDirect3DBaseTexture8 *);
+HRESULT IDirect3DDevice8_SetPalette(IDirect3DDevice8 *, DWORD, IDirect3DPalette8 *);
+HRESULT IDirect3DDevice8_SetTextureStageState(IDirect3DDevice8 *, DWORD, D3DTEXTURESTAGESTATETYPE, DWORD);
+HRESULT IDirect3DDevice8_SetTransform(IDirect3DDevice8 *, D3DTRANSFORMSTATETYPE, const D3DMATRIX *);
+HRESULT IDirect3DDevice8_SetVertexShader(IDirect3DDevice8 *, DWORD);
+HRESULT IDirect3DDevice8_SetViewport(IDirect3DDevice8 *, const D3DVIEWPORT8 *);
+HRESULT IDirect3DDevice8_BeginPushBuffer(IDirect3DDevice8 *, IDirect3DPushBuffer8 *);
+HRESULT IDirect3DDevice8_EndPushBuffer(IDirect3DDevice8 *);
+HRESULT IDirect3DDevice8_RunPushBuffer(IDirect3DDevice8 *, IDirect3DPushBuffer8 *, void *);
+void IDirect3DDevice8_KickPushBuffer(IDirect3DDevice8 *);
+void IDirect3DDevice8_BlockUntilIdle(IDirect3DDevice8 *);
+void IDirect3DDevice8_BlockUntilVerticalBlank(IDirect3DDevice8 *);
+void IDirect3DDevice8_GetDisplayFieldStatus(IDirect3DDevice8 *, D3DFIELD_STATUS *);
+HRESULT IDirect3DDevice8_GetRasterStatus(IDirect3DDevice8 *, D3DRASTER_STATUS *);
+DWORD IDirect3DDevice8_InsertFence(IDirect3DDevice8 *);
+BOOL IDirect3DDevice8_IsFencePending(IDirect3DDevice8 *, DWORD);
+void IDirect3DDevice8_BlockOnFence(IDirect3DDevice8 *, DWORD);
+void IDirect3DDevice8_InsertCallback(IDirect3DDevice8 *, D3DCALLBACKTYPE, D3DCALLBACK, DWORD);
+
+ULONG IDirect3DPushBuffer8_Release(IDirect3DPushBuffer8 *);
+ULONG IDirect3DPalette8_Release(IDirect3DPalette8 *);
+HRESULT IDirect3DPalette8_Lock(IDirect3DPalette8 *, D3DCOLOR **, DWORD);
+HRESULT IDirect3DPalette8_Unlock(IDirect3DPalette8 *);
+HRESULT IDirect3DBaseTexture8_GetDevice(IDirect3DBaseTexture8 *, IDirect3DDevice8 **);
+BOOL IDirect3DResource8_IsBusy(IDirect3DResource8 *);
+ULONG IDirect3DSurface8_AddRef(IDirect3DSurface8 *);
+ULONG IDirect3DSurface8_Release(IDirect3DSurface8 *);
+HRESULT IDirect3DSurface8_GetDesc(IDirect3DSurface8 *, D3DSURFACE_DESC *);
+HRESULT IDirect3DSurface8_LockRect(IDirect3DSurface8 *, D3DLOCKED_RECT *, const RECT *, DWORD);
+HRESULT IDirect3DSurface8_UnlockRect(IDirect3DSurface8 *);
+ULONG IDirect3DTexture8_AddRef(IDirect3DTexture8 *);
+ULONG IDirect3DTexture8_Release(IDirect3DTexture8 *);
+BOOL IDirect3DTexture8_IsBusy(IDirect3DTexture8 *);
+HRESULT IDirect3DTexture8_GetLevelDesc(IDirect3DTexture8 *, UINT, D3DSURFACE_DESC *);
+HRESULT IDirect3DTexture8_GetSurfaceLevel(IDirect3DTexture8 *, UINT, IDirect3DSurface8 **);
+HRESULT IDirect3DTexture8_LockRect(IDirect3DTexture8 *, UINT, D3DLOCKED_RECT *, const RECT *, DWORD);
+HRESULT IDirect3DTexture8_UnlockRect(IDirect3DTexture8 *, UINT);
+HRESULT IDirect3DVertexBuffer8_Lock(IDirect3DVertexBuffer8 *, UINT, UINT, BYTE **, DWORD);
+HRESULT IDirect3DVertexBuffer8_Unlock(IDirect3DVertexBuffer8 *);
+ULONG IDirect3DVertexBuffer8_Release(IDirect3DVertexBuffer8 *);
+HRESULT IDirect3DIndexBuffer8_Lock(IDirect3DIndexBuffer8 *, UINT, UINT, BYTE **, DWORD);
+HRESULT IDirect3DIndexBuffer8_Unlock(IDirect3DIndexBuffer8 *);
+ULONG IDirect3DIndexBuffer8_Release(IDirect3DIndexBuffer8 *);
+
+void XGSwizzleRect(const void *, DWORD, const RECT *, void *, DWORD, DWORD, const POINT *, DWORD);
+DWORD XGetVideoFlags(void);
+DWORD XGetVideoStandard(void);
+
+/* ------------------------------ DirectSound ------------------------------ */
+
+typedef struct { DWORD Data1; WORD Data2, Data3; BYTE Data4[8]; } GUID;
+typedef GUID *LPGUID;
+typedef const GUID *LPCGUID;
+typedef void *LPUNKNOWN;
+
+#define E_NOINTERFACE ((HRESULT)0x80004002L)
+#define DS_OK 0
+#define DSERR_CONTROLUNAVAIL ((HRESULT)0x8878001E)
+#define DSERR_INVALIDCALL ((HRESULT)0x88780032)
+#define DSERR_NODRIVER ((HRESULT)0x88780078)
+#define DSERR_OUTOFMEMORY ((HRESULT)0x8007000E)
+#define DSERR_UNSUPPORTED ((HRESULT)0x80004001)
+#define DSBSTATUS_PLAYING 1
+#define DSBPLAY_LOOPING 1
+#define DSBLOCK_ENTIREBUFFER 2
+#define DSBSIZE_MIN 4
+#define DSBSIZE_MAX 0x0FFFFFFF
+#define DSBCAPS_CTRL3D 0x10
+#define DSBCAPS_CTRLFREQUENCY 0x20
+#define DSBCAPS_CTRLVOLUME 0x80
+#define DSBCAPS_CTRLPOSITIONNOTIFY 0x100
+#define DSBCAPS_LOCDEFER 0x40000
+#define DSBVOLUME_MAX 0
+#define DSBVOLUME_MIN (-10000)
+#define DSBFREQUENCY_ORIGINAL 0
+#define DSBHEADROOM_DEFAULT_2D 600
+#define DSMIXBIN_FRONT_LEFT 0
+#define DSMIXBIN_FRONT_RIGHT 1
+#define DSMIXBIN_FRONT_CENTER 2
+#define DSMIXBIN_LOW_FREQUENCY 3
+#define DSMIXBIN_BACK_LEFT 4
+#define DSMIXBIN_BACK_RIGHT 5
+#define WAVE_FORMAT_PCM 1
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+typedef struct {
+    WORD wFormatTag; WORD nChannels; DWORD nSamplesPerSec; DWORD nAvgBytesPerSec;
+    WORD nBlockAlign; WORD wBitsPerSample; WORD cbSize;
+} WAVEFORMATEX;
+typedef struct {
+    WAVEFORMATEX Format; union { WORD wValidBitsPerSample; } Samples;
+    DWORD dwChannelMask; GUID SubFormat;
+} WAVEFORMATEXTENSIBLE;
+typedef struct { DWORD dwMixBin; LONG lVolume; } DSMIXBINVOLUMEPAIR;
+typedef struct { DWORD dwMixBinCount; DSMIXBINVOLUMEPAIR *lpMixBinVolumePairs; } DSMIXBINS;
+typedef struct {
+    DWORD dwSize; DWORD dwFlags; DWORD dwBufferBytes; WAVEFORMATEX *lpwfxFormat;
+    DSMIXBINS *lpMixBins; DWORD dwInputMixBin;
+} DSBUFFERDESC;
+typedef struct { DWORD dwOffset; HANDLE hEventNotify; } DSBPOSITIONNOTIFY;
+typedef const DSBPOSITIONNOTIFY *LPCDSBPOSITIONNOTIFY;
+typedef struct IDirectSound IDirectSound, *LPDIRECTSOUND;
+typedef struct IDirectSoundBuffer IDirectSoundBuffer, *LPDIRECTSOUNDBUFFER;
+
+HRESULT DirectSoundCreate(LPGUID, LPDIRECTSOUND *, LPUNKNOWN);
+void DirectSoundDoWork(void);
+ULONG IDirectSound_Release(LPDIRECTSOUND);
+HRESULT IDirectSound_SetMixBinHeadroom(LPDIRECTSOUND, DWORD, DWORD);
+HRESULT IDirectSound_CreateSoundBuffer(LPDIRECTSOUND, const DSBUFFERDESC *, LPDIRECTSOUNDBUFFER *, LPUNKNOWN);
+ULONG IDirectSoundBuffer_Release(LPDIRECTSOUNDBUFFER);
+HRESULT IDirectSoundBuffer_GetCurrentPosition(LPDIRECTSOUNDBUFFER, LPDWORD, LPDWORD);
+HRESULT IDirectSoundBuffer_GetStatus(LPDIRECTSOUNDBUFFER, LPDWORD);
+HRESULT IDirectSoundBuffer_Play(LPDIRECTSOUNDBUFFER, DWORD, DWORD, DWORD);
+HRESULT IDirectSoundBuffer_Stop(LPDIRECTSOUNDBUFFER);
+HRESULT IDirectSoundBuffer_Lock(LPDIRECTSOUNDBUFFER, DWORD, DWORD, LPVOID *, LPDWORD, LPVOID *, LPDWORD, DWORD);
+HRESULT IDirectSoundBuffer_Unlock(LPDIRECTSOUNDBUFFER, LPVOID, DWORD, LPVOID, DWORD);
+HRESULT IDirectSoundBuffer_SetFormat(LPDIRECTSOUNDBUFFER, const WAVEFORMATEX *);
+HRESULT IDirectSoundBuffer_SetHeadroom(LPDIRECTSOUNDBUFFER, DWORD);
+HRESULT IDirectSoundBuffer_SetMixBins(LPDIRECTSOUNDBUFFER, DSMIXBINS *);
+HRESULT IDirectSoundBuffer_SetVolume(LPDIRECTSOUNDBUFFER, LONG);
+HRESULT IDirectSoundBuffer_SetFrequency(LPDIRECTSOUNDBUFFER, DWORD);
+HRESULT IDirectSoundBuffer_SetPitch(LPDIRECTSOUNDBUFFER, LONG);
+HRESULT IDirectSoundBuffer_SetCurrentPosition(LPDIRECTSOUNDBUFFER, DWORD);
+HRESULT IDirectSoundBuffer_SetBufferData(LPDIRECTSOUNDBUFFER, LPVOID, DWORD);
+HRESULT IDirectSoundBuffer_SetLoopRegion(LPDIRECTSOUNDBUFFER, DWORD, DWORD);
+HRESULT IDirectSoundBuffer_SetNotificationPositions(LPDIRECTSOUNDBUFFER, DWORD, LPCDSBPOSITIONNOTIFY);
+HRESULT IDirectSoundBuffer_SetPosition(LPDIRECTSOUNDBUFFER, FLOAT, FLOAT, FLOAT, DWORD);
+
+#endif /* XTL_MOCK_H */
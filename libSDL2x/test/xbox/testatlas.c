@@ -0,0 +1,260 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Checks the skyline atlas packer: entries stay on the page, never overlap,
+   keep their padding apart, may end on the page edge, map to the right
+   texture coordinates, and get their edges copied into their border. */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "SDL_xbox_atlas.h"
+
+#include "testxbox.h"
+
+#define MAX_ENTRIES 1024
+
+/* Two entries grown by the padding on their right and bottom must not
+   touch; that is what keeps bilinear filtering from reading a neighbour. */
+static SDL_bool
+PaddedOverlap(const SDL_Rect *a, const SDL_Rect *b, int padding)
+{
+    return (a->x < b->x + b->w + padding && b->x < a->x + a->w + padding &&
+            a->y < b->y + b->h + padding && b->y < a->y + a->h + padding) ? SDL_TRUE : SDL_FALSE;
+}
+
+static void
+CheckEntries(const SDL_Rect *rects, int count, int pagew, int pageh, int padding)
+{
+    int i, j, bad = 0;
+
+    for (i = 0; i < count; ++i) {
+        XBOX_CHECK(rects[i].x >= 0 && rects[i].y >= 0);
+        XBOX_CHECK(rects[i].x + rects[i].w <= pagew);
+        XBOX_CHECK(rects[i].y + rects[i].h <= pageh);
+        for (j = i + 1; j < count; ++j) {
+            if (PaddedOverlap(&rects[i], &rects[j], padding)) {
+                fprintf(stderr, "entries %d (%d,%d %dx%d) and %d (%d,%d %dx%d) are too close\n",
+                        i, rects[i].x, rects[i].y, rects[i].w, rects[i].h,
+                        j, rects[j].x, rects[j].y, rects[j].w, rects[j].h);
+                ++bad;
+            }
+        }
+    }
+    XBOX_CHECK_INT(bad, 0);
+}
+
+/* Packs pseudo-random sizes until the page fills up. */
+static void
+TestRandomFill(int pagew, int pageh, int padding, unsigned int seed)
+{
+    static XBOX_AtlasPacker packer;
+    static SDL_Rect rects[MAX_ENTRIES];
+    int count = 0, misses = 0;
+
+    srand(seed);
+    XBOX_InitAtlasPacker(&packer, pagew, pageh, padding);
+    while (count < MAX_ENTRIES && misses < 64) {
+        const int w = 1 + rand() % 40;
+        const int h = 1 + rand() % 40;
+        if (XBOX_AtlasPack(&packer, w, h, &rects[count])) {
+            XBOX_CHECK_INT(rects[count].w, w);
+            XBOX_CHECK_INT(rects[count].h, h);
+            ++count;
+        } else {
+            ++misses;
+        }
+    }
+    XBOX_CHECK(count > 1);
+    CheckEntries(rects, count, pagew, pageh, padding);
+}
+
+/* Entries the size of the page, or ending exactly on its edge, must fit:
+   padding only separates entries from each other. */
+static void
+TestEdgeFit(void)
+{
+    XBOX_AtlasPacker packer;
+    SDL_Rect rects[4];
+
+    XBOX_InitAtlasPacker(&packer, 64, 64, 2);
+    XBOX_CHECK(XBOX_AtlasPack(&packer, 64, 64, &rects[0]));
+    XBOX_CHECK_INT(rects[0].x, 0);
+    XBOX_CHECK_INT(rects[0].y, 0);
+    XBOX_CHECK(!XBOX_AtlasPack(&packer, 1, 1, &rects[1]));
+
+    /* 30 + 2 + 32 = 64: the second entry ends on the right edge */
+    XBOX_InitAtlasPacker(&packer, 64, 64, 2);
+    XBOX_CHECK(XBOX_AtlasPack(&packer, 30, 64, &rects[0]));
+    XBOX_CHECK(XBOX_AtlasPack(&packer, 32, 64, &rects[1]));
+    XBOX_CHECK_INT(rects[1].x, 32);
+    XBOX_CHECK(!XBOX_AtlasPack(&packer, 1, 1, &rects[2]));
+    CheckEntries(rects, 2, 64, 64, 2);
+
+    /* one texel too wide once the padding is counted */
+    XBOX_InitAtlasPacker(&packer, 64, 64, 2);
+    XBOX_CHECK(XBOX_AtlasPack(&packer, 30, 64, &rects[0]));
+    XBOX_CHECK(!XBOX_AtlasPack(&packer, 33, 64, &rects[1]));
+
+    /* stacking down to the bottom edge */
+    XBOX_InitAtlasPacker(&packer, 64, 64, 2);
+    XBOX_CHECK(XBOX_AtlasPack(&packer, 64, 30, &rects[0]));
+    XBOX_CHECK(XBOX_AtlasPack(&packer, 64, 32, &rects[1]));
+    XBOX_CHECK_INT(rects[1].y, 32);
+    CheckEntries(rects, 2, 64, 64, 2);
+
+    XBOX_InitAtlasPacker(&packer, 64, 64, 2);
+    XBOX_CHECK(!XBOX_AtlasPack(&packer, 65, 1, &rects[0]));
+    XBOX_CHECK(!XBOX_AtlasPack(&packer, 0, 1, &rects[0]));
+}
+
+/* Entries of one size tile a row with exactly 'padding' texels between them. */
+static void
+TestPaddingSpacing(void)
+{
+    XBOX_AtlasPacker packer;
+    SDL_Rect rect;
+    int i;
+
+    XBOX_InitAtlasPacker(&packer, 128, 128, 4);
+    for (i = 0; i < 5; ++i) {
+        XBOX_CHECK(XBOX_AtlasPack(&packer, 20, 10, &rect));
+        XBOX_CHECK_INT(rect.x, i * 24);
+        XBOX_CHECK_INT(rect.y, 0);
+    }
+    /* 5 * 24 = 120 leaves 8 texels: a 10 wide entry goes on the next shelf */
+    XBOX_CHECK(XBOX_AtlasPack(&packer, 10, 10, &rect));
+    XBOX_CHECK_INT(rect.x, 0);
+    XBOX_CHECK_INT(rect.y, 14);
+}
+
+static void
+TestUVTransform(void)
+{
+    SDL_Rect entry;
+    float su, sv, ou, ov;
+
+    entry.x = 64;
+    entry.y = 32;
+    entry.w = 48;
+    entry.h = 16;
+    XBOX_GetAtlasUVTransform(&entry, 256, 128, &su, &sv, &ou, &ov);
+
+    /* texel coordinates of the entry's corners land on its page corners */
+    XBOX_CHECK(fabsf(0.0f * su + ou - 64.0f / 256.0f) < 1e-6f);
+    XBOX_CHECK(fabsf(0.0f * sv + ov - 32.0f / 128.0f) < 1e-6f);
+    XBOX_CHECK(fabsf(48.0f * su + ou - 112.0f / 256.0f) < 1e-6f);
+    XBOX_CHECK(fabsf(16.0f * sv + ov - 48.0f / 128.0f) < 1e-6f);
+    XBOX_CHECK(fabsf(su - 1.0f / 256.0f) < 1e-9f);
+    XBOX_CHECK(fabsf(sv - 1.0f / 128.0f) < 1e-9f);
+}
+
+#define EXTRUDE_W 5
+#define EXTRUDE_H 4
+#define EXTRUDE_PITCH (EXTRUDE_W + 2)
+#define EXTRUDE_BORDER 0xDEADBEEFu
+
+static Uint32
+ExtrudeTexel(const Uint32 *pixels, int x, int y)
+{
+    return pixels[(y + 1) * EXTRUDE_PITCH + (x + 1)];
+}
+
+/* Every border texel holds a copy of the nearest entry texel; 'rect' limits
+   which border texels must have been written, the rest keep the marker. */
+static void
+CheckBorder(const Uint32 *pixels, const SDL_Rect *rect)
+{
+    int x, y, bad = 0;
+
+    for (y = -1; y <= EXTRUDE_H; ++y) {
+        for (x = -1; x <= EXTRUDE_W; ++x) {
+            const int cx = SDL_clamp(x, 0, EXTRUDE_W - 1);
+            const int cy = SDL_clamp(y, 0, EXTRUDE_H - 1);
+            const SDL_bool border = (x != cx || y != cy) ? SDL_TRUE : SDL_FALSE;
+            const SDL_bool written = (cx >= rect->x && cx < rect->x + rect->w &&
+                                      cy >= rect->y && cy < rect->y + rect->h) ? SDL_TRUE : SDL_FALSE;
+            Uint32 expected;
+
+            if (!border) {
+                continue;
+            }
+            expected = written ? ExtrudeTexel(pixels, cx, cy) : EXTRUDE_BORDER;
+            if (ExtrudeTexel(pixels, x, y) != expected) {
+                fprintf(stderr, "border texel %d,%d is 0x%08x, expected 0x%08x\n",
+                        x, y, (unsigned int)ExtrudeTexel(pixels, x, y), (unsigned int)expected);
+                ++bad;
+            }
+        }
+    }
+    XBOX_CHECK_INT(bad, 0);
+}
+
+static void
+TestExtrudeUpdate(int x, int y, int w, int h)
+{
+    Uint32 pixels[EXTRUDE_PITCH * (EXTRUDE_H + 2)];
+    SDL_Rect rect;
+    int i;
+
+    rect.x = x;
+    rect.y = y;
+    rect.w = w;
+    rect.h = h;
+    for (i = 0; i < (int)SDL_arraysize(pixels); ++i) {
+        pixels[i] = EXTRUDE_BORDER;
+    }
+    for (i = 0; i < EXTRUDE_W * EXTRUDE_H; ++i) {
+        pixels[(i / EXTRUDE_W + 1) * EXTRUDE_PITCH + (i % EXTRUDE_W + 1)] = 0xFF000000u | (Uint32)i;
+    }
+    XBOX_ExtrudeAtlasEntry((Uint8 *)(pixels + EXTRUDE_PITCH + 1), EXTRUDE_PITCH * 4, 4,
+                           EXTRUDE_W, EXTRUDE_H, &rect);
+    CheckBorder(pixels, &rect);
+}
+
+/* The border around an entry copies its edges, corners included, and only
+   where an update touched them. */
+static void
+TestExtrude(void)
+{
+    TestExtrudeUpdate(0, 0, EXTRUDE_W, EXTRUDE_H);
+    TestExtrudeUpdate(1, 1, 2, 2);
+    TestExtrudeUpdate(3, 1, 2, 2);
+    TestExtrudeUpdate(0, 2, 2, 2);
+    TestExtrudeUpdate(4, 3, 1, 1);
+}
+
+int
+main(int argc, char *argv[])
+{
+    TestEdgeFit();
+    TestPaddingSpacing();
+    TestRandomFill(256, 256, 0, 1);
+    TestRandomFill(256, 256, 1, 2);
+    TestRandomFill(512, 256, 2, 3);
+    TestRandomFill(128, 512, 4, 4);
+    TestUVTransform();
+    TestExtrude();
+
+    return testxbox_done("testatlas");
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,191 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Runs the Xbox DirectSound driver against the mock buffer, whose play
+   cursor follows a simulated clock, and checks how the audio thread waits
+   for it. The driver source is built into this test so the checks can look
+   at its private state; the harness below plays the part of SDL_audio.c. */
+
+#include "SDL_directsound.c"
+
+#include "mock_xdk.h"
+#include "testxbox.h"
+
+/* ------------------------------- Harness --------------------------------- */
+
+static SDL_AudioDriverImpl impl;
+static SDL_AudioDevice device;
+static SDL_AudioFormat first_format;
+
+void
+SDL_Delay(Uint32 ms)
+{
+    Sleep(ms);
+}
+
+SDL_AudioFormat
+SDL_FirstAudioFormat(SDL_AudioFormat format)
+{
+    first_format = format;
+    return format;
+}
+
+SDL_AudioFormat
+SDL_NextAudioFormat(void)
+{
+    return 0;
+}
+
+void
+SDL_CalculateAudioSpec(SDL_AudioSpec *spec)
+{
+    spec->silence = (spec->format == AUDIO_U8) ? 0x80 : 0x00;
+    spec->size = (SDL_AUDIO_BITSIZE(spec->format) / 8) * spec->channels * spec->samples;
+}
+
+/* Opens a 48 kHz stereo device with 512 sample periods. */
+static void
+TestOpenDevice(const char *low_latency)
+{
+    SDL_SetHint(SDL_HINT_AUDIO_XBOX_LOW_LATENCY, low_latency);
+    SDL_zero(impl);
+    SDL_zero(device);
+    XBOX_CHECK(DSOUND_Init(&impl));
+    device.spec.freq = 48000;
+    device.spec.format = AUDIO_S16;
+    device.spec.channels = 2;
+    device.spec.samples = 512;
+    MockXDK_ResetCounters();
+    XBOX_CHECK_INT(impl.OpenDevice(&device, NULL), 0);
+}
+
+static void
+TestCloseDevice(void)
+{
+    impl.CloseDevice(&device);
+    impl.Deinitialize();
+}
+
+/* One turn of the audio thread: fill the next period, then wait for room. */
+static void
+TestRunPeriod(void)
+{
+    Uint8 *buf = impl.GetDeviceBuf(&device);
+
+    XBOX_CHECK(buf != NULL);
+    if (buf) {
+        SDL_memset(buf, device.spec.silence, device.spec.size);
+    }
+    impl.PlayDevice(&device);
+    impl.WaitDevice(&device);
+}
+
+/* Microseconds of audio in one period. */
+static ULONGLONG
+TestPeriodMicroseconds(void)
+{
+    return (ULONGLONG)device.spec.samples * 1000000 / device.spec.freq;
+}
+
+/* -------------------------------- Tests ---------------------------------- */
+
+/* The audio thread sleeps on the chunk notifications and each wait ends
+   with the event, not the timeout. */
+static void
+TestNotifyWakeup(void)
+{
+    const ULONGLONG start = mock_xdk.time_us;
+    ULONGLONG elapsed;
+    int i;
+
+    TestOpenDevice("0");
+    XBOX_CHECK(device.hidden->notify_event != NULL);
+    XBOX_CHECK_INT(mock_xdk.ds_notify_positions, device.hidden->num_buffers);
+
+    for (i = 0; i < 64; ++i) {
+        TestRunPeriod();
+    }
+    XBOX_CHECK_INT(mock_xdk.ds_play_calls, 1);
+    XBOX_CHECK(mock_xdk.event_waits >= 63);
+    XBOX_CHECK_INT(mock_xdk.event_wakeups, mock_xdk.event_waits);
+
+    /* one period written per period played, with no time lost waiting */
+    elapsed = mock_xdk.time_us - start;
+    XBOX_CHECK(elapsed >= 63 * TestPeriodMicroseconds());
+    XBOX_CHECK(elapsed <= 64 * TestPeriodMicroseconds() + 100);
+
+    TestCloseDevice();
+    XBOX_CHECK_INT(mock_xdk.ds_stop_calls, 1);
+}
+
+/* The buffer starts playing as soon as the first periods are written, and
+   low latency mode keeps the requested number of periods queued. */
+static void
+TestLatency(void)
+{
+    ULONGLONG start;
+    int i;
+
+    /* normal buffering starts after the first period */
+    TestOpenDevice("0");
+    start = mock_xdk.time_us;
+    TestRunPeriod();
+    XBOX_CHECK_INT(mock_xdk.ds_play_calls, 1);
+    XBOX_CHECK_INT((int)(mock_xdk.ds_play_started_us - start), 0);
+    TestCloseDevice();
+
+    /* low latency starts after the lead periods */
+    TestOpenDevice("2");
+    XBOX_CHECK(device.hidden->ring != NULL);
+    XBOX_CHECK_INT(device.hidden->num_buffers, DSOUND_LOW_LATENCY_CHUNKS);
+    XBOX_CHECK_INT(device.hidden->lead_chunks, 2);
+    start = mock_xdk.time_us;
+    TestRunPeriod();
+    XBOX_CHECK_INT(mock_xdk.ds_play_calls, 0);
+    TestRunPeriod();
+    XBOX_CHECK_INT(mock_xdk.ds_play_calls, 1);
+    XBOX_CHECK_INT((int)(mock_xdk.ds_play_started_us - start), 0);
+
+    /* steady state: never more than lead + 1 periods queued, never none */
+    for (i = 0; i < 256; ++i) {
+        const DWORD numchunks = (DWORD)device.hidden->num_buffers;
+        const DWORD playing = MockDSound_GetPlayCursor(MockDSound_GetBuffer()) / device.spec.size;
+        const DWORD queued = (device.hidden->writechunk + numchunks - playing) % numchunks;
+
+        XBOX_CHECK(queued >= 1);
+        XBOX_CHECK(queued <= (DWORD)device.hidden->lead_chunks + 1);
+        TestRunPeriod();
+    }
+    XBOX_CHECK_INT(mock_xdk.ds_play_calls, 1);
+    XBOX_CHECK_INT(mock_xdk.event_wakeups, mock_xdk.event_waits);
+    TestCloseDevice();
+}
+
+int
+main(int argc, char *argv[])
+{
+    TestNotifyWakeup();
+    TestLatency();
+
+    return testxbox_done("testdsound");
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
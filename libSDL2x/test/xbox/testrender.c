@@ -0,0 +1,696 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Runs the Xbox Direct3D 8 renderer against the mock device and checks what
+   it sends to the device. The renderer source is built into this test so the
+   checks can look at its private state; the harness below plays the part of
+   SDL_render.c, queueing commands and vertices the way it does. */
+
+#include <math.h>
+
+#include "SDL_render_xbox.c"
+
+#include "mock_xdk.h"
+#include "testxbox.h"
+
+/* ------------------------------- Harness --------------------------------- */
+
+#define TEST_MAX_COMMANDS 256
+
+static SDL_Renderer *renderer;
+static D3D_RenderData *renderdata;
+static int window_w = 640, window_h = 480;
+static SDL_RenderCommand commands[TEST_MAX_COMMANDS];
+static int numcommands;
+static Uint8 vertex_data[256 * 1024];
+static size_t vertex_used;
+
+SDL_bool
+D3D_LoadDLL(IDirect3D8 **d3d)
+{
+    *d3d = Direct3DCreate8(D3D_SDK_VERSION);
+    return SDL_TRUE;
+}
+
+void
+SDL_GetWindowSize(SDL_Window *window, int *w, int *h)
+{
+    (void)window;
+    if (w) *w = window_w;
+    if (h) *h = window_h;
+}
+
+void
+SDL_SetWindowSize(SDL_Window *window, int w, int h)
+{
+    (void)window;
+    window_w = w;
+    window_h = h;
+}
+
+int SDL_PushEvent(SDL_Event *event) { (void)event; return 1; }
+
+int
+SDL_ConvertPixels(int width, int height, Uint32 src_format, const void *src, int src_pitch,
+                  Uint32 dst_format, void *dst, int dst_pitch)
+{
+    (void)width; (void)height; (void)src_format; (void)src; (void)src_pitch;
+    (void)dst_format; (void)dst; (void)dst_pitch;
+    return SDL_Unsupported();
+}
+
+/* Same packing of blend modes as SDL_render.c. */
+static SDL_BlendMode
+TestLongBlendMode(SDL_BlendMode mode)
+{
+    switch (mode) {
+    case SDL_BLENDMODE_NONE:
+        return (SDL_BlendMode)0x00010010;
+    case SDL_BLENDMODE_BLEND:
+        return (SDL_BlendMode)0x06010651;
+    case SDL_BLENDMODE_ADD:
+        return (SDL_BlendMode)0x02010251;
+    case SDL_BLENDMODE_MOD:
+        return (SDL_BlendMode)0x02010320;
+    case SDL_BLENDMODE_MUL:
+        return (SDL_BlendMode)0x02010690;
+    default:
+        return mode;
+    }
+}
+
+SDL_BlendFactor SDL_GetBlendModeSrcColorFactor(SDL_BlendMode mode) { return (SDL_BlendFactor)((TestLongBlendMode(mode) >> 4) & 0xF); }
+SDL_BlendFactor SDL_GetBlendModeDstColorFactor(SDL_BlendMode mode) { return (SDL_BlendFactor)((TestLongBlendMode(mode) >> 8) & 0xF); }
+SDL_BlendOperation SDL_GetBlendModeColorOperation(SDL_BlendMode mode) { return (SDL_BlendOperation)(TestLongBlendMode(mode) & 0xF); }
+SDL_BlendFactor SDL_GetBlendModeSrcAlphaFactor(SDL_BlendMode mode) { return (SDL_BlendFactor)((TestLongBlendMode(mode) >> 20) & 0xF); }
+SDL_BlendFactor SDL_GetBlendModeDstAlphaFactor(SDL_BlendMode mode) { return (SDL_BlendFactor)((TestLongBlendMode(mode) >> 24) & 0xF); }
+SDL_BlendOperation SDL_GetBlendModeAlphaOperation(SDL_BlendMode mode) { return (SDL_BlendOperation)((TestLongBlendMode(mode) >> 16) & 0xF); }
+
+void *
+SDL_AllocateRenderVertices(SDL_Renderer *r, const size_t numbytes, const size_t alignment, size_t *offset)
+{
+    const size_t align = alignment ? alignment : 1;
+    const size_t start = ((vertex_used + align - 1) / align) * align;
+
+    (void)r;
+    if (start + numbytes > sizeof(vertex_data)) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    vertex_used = start + numbytes;
+    *offset = start;
+    return vertex_data + start;
+}
+
+/* Hands the queued commands to the renderer, like SDL_RenderFlush(). */
+int
+SDL_RenderFlush(SDL_Renderer *r)
+{
+    int result = 0;
+
+    if (numcommands) {
+        result = r->RunCommandQueue(r, commands, vertex_data, vertex_used);
+    }
+    numcommands = 0;
+    vertex_used = 0;
+    return result;
+}
+
+static SDL_RenderCommand *
+TestQueueCommand(SDL_RenderCommandType type)
+{
+    SDL_RenderCommand *cmd;
+
+    if (numcommands == TEST_MAX_COMMANDS) {
+        SDL_RenderFlush(renderer);
+    }
+    cmd = &commands[numcommands];
+    SDL_zerop(cmd);
+    cmd->command = type;
+    if (numcommands > 0) {
+        commands[numcommands - 1].next = cmd;
+    }
+    ++numcommands;
+    return cmd;
+}
+
+static void
+TestSetDrawCommand(SDL_RenderCommand *cmd, SDL_BlendMode blend, SDL_Texture *texture, Uint32 argb)
+{
+    cmd->data.draw.a = (Uint8)(argb >> 24);
+    cmd->data.draw.r = (Uint8)(argb >> 16);
+    cmd->data.draw.g = (Uint8)(argb >> 8);
+    cmd->data.draw.b = (Uint8)argb;
+    cmd->data.draw.blend = blend;
+    cmd->data.draw.texture = texture;
+}
+
+static void
+TestFillRect(float x, float y, float w, float h, SDL_BlendMode blend, Uint32 argb)
+{
+    SDL_RenderCommand *cmd = TestQueueCommand(SDL_RENDERCMD_FILL_RECTS);
+    const SDL_FRect rect = { x, y, w, h };
+
+    TestSetDrawCommand(cmd, blend, NULL, argb);
+    XBOX_CHECK_INT(renderer->QueueFillRects(renderer, cmd, &rect, 1), 0);
+}
+
+static void
+TestCopy(SDL_Texture *texture, int sx, int sy, int sw, int sh, float x, float y, SDL_BlendMode blend)
+{
+    SDL_RenderCommand *cmd = TestQueueCommand(SDL_RENDERCMD_COPY);
+    const SDL_Rect src = { sx, sy, sw, sh };
+    const SDL_FRect dst = { x, y, (float)sw, (float)sh };
+
+    TestSetDrawCommand(cmd, blend, texture, 0xFFFFFFFF);
+    XBOX_CHECK_INT(renderer->QueueCopy(renderer, cmd, texture, &src, &dst), 0);
+}
+
+static void
+TestPresent(void)
+{
+    XBOX_CHECK_INT(SDL_RenderFlush(renderer), 0);
+    XBOX_CHECK_INT(renderer->RenderPresent(renderer), 0);
+}
+
+static SDL_XboxRenderStats
+TestGetStats(void)
+{
+    SDL_XboxRenderStats stats;
+    SDL_zero(stats);
+    XBOX_CHECK_INT(SDL_RenderGetXboxStats(renderer, &stats), 0);
+    return stats;
+}
+
+static SDL_Texture *
+TestCreateTexture(Uint32 format, int access, int w, int h)
+{
+    SDL_Texture *texture = (SDL_Texture *)SDL_calloc(1, sizeof(*texture));
+
+    texture->format = format;
+    texture->access = access;
+    texture->w = w;
+    texture->h = h;
+    texture->blendMode = SDL_BLENDMODE_BLEND;
+    texture->scaleMode = SDL_ScaleModeNearest;
+    texture->renderer = renderer;
+    if (renderer->CreateTexture(renderer, texture) < 0) {
+        fprintf(stderr, "CreateTexture failed: %s\n", SDL_GetError());
+        ++testxbox_failures;
+        SDL_free(texture);
+        return NULL;
+    }
+    texture->next = renderer->textures;
+    renderer->textures = texture;
+    return texture;
+}
+
+static void
+TestDestroyTexture(SDL_Texture *texture)
+{
+    SDL_Texture **link;
+
+    if (texture) {
+        for (link = &renderer->textures; *link; link = &(*link)->next) {
+            if (*link == texture) {
+                *link = texture->next;
+                break;
+            }
+        }
+        renderer->DestroyTexture(renderer, texture);
+        SDL_free(texture);
+    }
+}
+
+static void
+TestFillTexture(SDL_Texture *texture, const SDL_Rect *rect)
+{
+    static Uint32 pixels[64 * 64];
+    size_t i;
+
+    for (i = 0; i < SDL_arraysize(pixels); ++i) {
+        pixels[i] = 0xFF000000u | (Uint32)(i * 2654435761u >> 8);
+    }
+    XBOX_CHECK_INT(renderer->UpdateTexture(renderer, texture, rect, pixels, rect ? rect->w * 4 : texture->w * 4), 0);
+}
+
+static void
+TestCreateRenderer(void)
+{
+    renderer = (SDL_Renderer *)SDL_calloc(1, sizeof(*renderer));
+    if (D3D_CreateRenderer(renderer, (SDL_Window *)&window_w, 0) < 0) {
+        fprintf(stderr, "D3D_CreateRenderer failed: %s\n", SDL_GetError());
+        exit(1);
+    }
+    renderdata = (D3D_RenderData *)renderer->driverdata;
+}
+
+static void
+TestDestroyRenderer(void)
+{
+    renderer->DestroyRenderer(renderer);
+    renderer = NULL;
+    renderdata = NULL;
+}
+
+/* -------------------------------- Tests ---------------------------------- */
+
+/* Runs of FILL_RECTS or COPY commands that share texture, blend mode and
+   layout go out as one QUADLIST draw. */
+static void
+TestBatching(void)
+{
+    SDL_Texture *texture;
+    SDL_XboxRenderStats stats;
+    int i;
+
+    TestCreateRenderer();
+    TestPresent();
+
+    /* eight fills of one colour: one draw */
+    MockXDK_ResetCounters();
+    for (i = 0; i < 8; ++i) {
+        TestFillRect(10.0f * i, 10.0f, 8.0f, 8.0f, SDL_BLENDMODE_BLEND, 0xFF204080);
+    }
+    XBOX_CHECK_INT(SDL_RenderFlush(renderer), 0);
+    XBOX_CHECK_INT(mock_xdk.draw_calls, 1);
+    XBOX_CHECK_INT(mock_xdk.quadlist_draws, 1);
+    XBOX_CHECK_INT(mock_xdk.quads, 8);
+
+    /* differently tinted fills still share a draw */
+    MockXDK_ResetCounters();
+    for (i = 0; i < 8; ++i) {
+        TestFillRect(10.0f * i, 30.0f, 8.0f, 8.0f, SDL_BLENDMODE_BLEND, 0xFF000000u | (Uint32)(i * 0x101010));
+    }
+    XBOX_CHECK_INT(SDL_RenderFlush(renderer), 0);
+    XBOX_CHECK_INT(mock_xdk.draw_calls, 1);
+    XBOX_CHECK_INT(mock_xdk.quads, 8);
+
+    /* a blend mode change splits the run */
+    MockXDK_ResetCounters();
+    TestFillRect(0.0f, 50.0f, 8.0f, 8.0f, SDL_BLENDMODE_BLEND, 0xFFFFFFFF);
+    TestFillRect(10.0f, 50.0f, 8.0f, 8.0f, SDL_BLENDMODE_BLEND, 0xFFFFFFFF);
+    TestFillRect(20.0f, 50.0f, 8.0f, 8.0f, SDL_BLENDMODE_NONE, 0xFFFFFFFF);
+    XBOX_CHECK_INT(SDL_RenderFlush(renderer), 0);
+    XBOX_CHECK_INT(mock_xdk.draw_calls, 2);
+    XBOX_CHECK_INT(mock_xdk.quads, 3);
+
+    /* sprites from one texture: one draw; a viewport command that changes
+       nothing does not split the run */
+    texture = TestCreateTexture(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 64, 64);
+    TestFillTexture(texture, NULL);
+    MockXDK_ResetCounters();
+    for (i = 0; i < 6; ++i) {
+        TestCopy(texture, (i % 4) * 16, 0, 16, 16, 20.0f * i, 100.0f, SDL_BLENDMODE_BLEND);
+        if (i == 2) {
+            SDL_RenderCommand *cmd = TestQueueCommand(SDL_RENDERCMD_SETVIEWPORT);
+            cmd->data.viewport.rect = renderdata->drawstate.viewport;
+        }
+    }
+    XBOX_CHECK_INT(SDL_RenderFlush(renderer), 0);
+    XBOX_CHECK_INT(mock_xdk.draw_calls, 1);
+    XBOX_CHECK_INT(mock_xdk.quadlist_draws, 1);
+    XBOX_CHECK_INT(mock_xdk.quads, 6);
+
+    /* the frame counters see every command but only the draws issued */
+    TestPresent();
+    stats = TestGetStats();
+    XBOX_CHECK_INT(stats.commands, 8 + 8 + 3 + 6);
+    XBOX_CHECK_INT(stats.draws, 1 + 1 + 2 + 1);
+
+    TestDestroyTexture(texture);
+    TestDestroyRenderer();
+}
+
+/* Fills alternating between blending and not, one frame each; returns the
+   frame counters and leaves the device calls of the frame in mock_xdk. */
+static SDL_XboxRenderStats
+TestAlternatingBlendFrame(int fills)
+{
+    int i;
+
+    MockXDK_ResetCounters();
+    for (i = 0; i < fills; ++i) {
+        TestFillRect(10.0f * i, 10.0f, 8.0f, 8.0f,
+                     (i & 1) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND, 0xFF204080);
+    }
+    TestPresent();
+    return TestGetStats();
+}
+
+/* Every state write reaching the device is counted as issued, and repeats
+   of the shadowed value are dropped. */
+static void
+TestStateCache(void)
+{
+    SDL_XboxRenderStats two, eight;
+
+    TestCreateRenderer();
+    TestAlternatingBlendFrame(2);
+
+    two = TestAlternatingBlendFrame(2);
+    XBOX_CHECK_INT(mock_xdk.draw_calls, 2);
+    XBOX_CHECK_INT(two.states_issued, mock_xdk.render_state_calls +
+                   mock_xdk.texture_stage_state_calls + mock_xdk.set_texture_calls);
+
+    /* six more blend toggles: only ALPHABLENDENABLE reaches the device, the
+       blend factors, colour and stage arguments are filtered */
+    eight = TestAlternatingBlendFrame(8);
+    XBOX_CHECK_INT(mock_xdk.draw_calls, 8);
+    XBOX_CHECK_INT(eight.states_issued, mock_xdk.render_state_calls +
+                   mock_xdk.texture_stage_state_calls + mock_xdk.set_texture_calls);
+    XBOX_CHECK_INT(eight.states_issued, two.states_issued + 6);
+    XBOX_CHECK(eight.states_filtered > two.states_filtered);
+
+    TestDestroyRenderer();
+}
+
+/* One frame of fills and sprites; returns its counters and leaves the device
+   calls of the frame in mock_xdk. */
+static SDL_XboxRenderStats
+TestSpriteFrame(SDL_Texture *texture)
+{
+    int i;
+
+    MockXDK_ResetCounters();
+    for (i = 0; i < 4; ++i) {
+        TestFillRect(10.0f * i, 10.0f, 8.0f, 8.0f, SDL_BLENDMODE_NONE, 0xFF204080);
+    }
+    for (i = 0; i < 4; ++i) {
+        TestCopy(texture, i * 16, 0, 16, 16, 20.0f * i, 100.0f, SDL_BLENDMODE_BLEND);
+    }
+    TestPresent();
+    return TestGetStats();
+}
+
+/* The stats overlay is one extra draw that the frame counters leave out. */
+static void
+TestStatsOverlay(void)
+{
+    SDL_Texture *texture;
+    SDL_XboxRenderStats plain, overlay;
+    int draws, quads;
+
+    TestCreateRenderer();
+    texture = TestCreateTexture(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 64, 64);
+    TestFillTexture(texture, NULL);
+    TestSpriteFrame(texture);
+
+    plain = TestSpriteFrame(texture);
+    draws = mock_xdk.draw_calls;
+    quads = mock_xdk.quads;
+
+    XBOX_CHECK_INT(SDL_RenderSetXboxStatsOverlay(renderer, SDL_TRUE), 0);
+    overlay = TestSpriteFrame(texture);
+    XBOX_CHECK_INT(mock_xdk.draw_calls, draws + 1);
+    XBOX_CHECK_INT(mock_xdk.quads, quads + D3D_OVERLAY_BARS + 2);
+    XBOX_CHECK_INT(overlay.commands, plain.commands);
+    XBOX_CHECK_INT(overlay.draws, plain.draws);
+    XBOX_CHECK_INT(overlay.states_issued, plain.states_issued);
+    XBOX_CHECK_INT(overlay.states_filtered, plain.states_filtered);
+    XBOX_CHECK_INT(overlay.vertex_bytes, plain.vertex_bytes);
+    XBOX_CHECK_INT(overlay.upload_bytes, plain.upload_bytes);
+
+    XBOX_CHECK_INT(SDL_RenderSetXboxStatsOverlay(renderer, SDL_FALSE), 0);
+    TestSpriteFrame(texture);
+    XBOX_CHECK_INT(mock_xdk.draw_calls, draws);
+
+    TestDestroyTexture(texture);
+    TestDestroyRenderer();
+}
+
+/* A texture uploads only the part written since its last upload. */
+static void
+TestDirtyUpload(void)
+{
+    const SDL_Rect small = { 4, 4, 10, 5 };
+    const SDL_Rect other = { 20, 10, 6, 3 };
+    SDL_Texture *texture;
+    SDL_XboxRenderStats stats;
+
+    TestCreateRenderer();
+    texture = TestCreateTexture(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 64, 64);
+    TestFillTexture(texture, NULL);
+    TestCopy(texture, 0, 0, 64, 64, 0.0f, 0.0f, SDL_BLENDMODE_BLEND);
+    TestPresent();
+    stats = TestGetStats();
+    XBOX_CHECK_INT(stats.texture_uploads, 1);
+    XBOX_CHECK_INT(stats.upload_bytes, 64 * 64 * 4);
+
+    TestFillTexture(texture, &small);
+    TestCopy(texture, 0, 0, 64, 64, 0.0f, 0.0f, SDL_BLENDMODE_BLEND);
+    TestPresent();
+    stats = TestGetStats();
+    XBOX_CHECK_INT(stats.texture_uploads, 1);
+    XBOX_CHECK_INT(stats.upload_bytes, 10 * 5 * 4);
+
+    /* two writes before a draw upload their bounding rectangle once */
+    TestFillTexture(texture, &small);
+    TestFillTexture(texture, &other);
+    TestCopy(texture, 0, 0, 64, 64, 0.0f, 0.0f, SDL_BLENDMODE_BLEND);
+    TestPresent();
+    stats = TestGetStats();
+    XBOX_CHECK_INT(stats.texture_uploads, 1);
+    XBOX_CHECK_INT(stats.upload_bytes, 22 * 9 * 4);
+
+    TestCopy(texture, 0, 0, 64, 64, 0.0f, 0.0f, SDL_BLENDMODE_BLEND);
+    TestPresent();
+    stats = TestGetStats();
+    XBOX_CHECK_INT(stats.texture_uploads, 0);
+    XBOX_CHECK_INT(stats.upload_bytes, 0);
+
+    TestDestroyTexture(texture);
+    TestDestroyRenderer();
+}
+
+static int
+TestTexturePins(SDL_Texture *texture)
+{
+    return D3D_GetTextureDataRep((D3D_TextureData *)texture->driverdata, NULL, NULL)->pins;
+}
+
+/* Display lists replay push buffers, except for draws with streaming
+   textures, and refuse to run once a reset recreated their textures. */
+static void
+TestDisplayListReset(void)
+{
+    SDL_Texture *texture, *streaming;
+    SDL_XboxDisplayList *list, *streamlist;
+
+    TestCreateRenderer();
+    texture = TestCreateTexture(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 64, 64);
+    streaming = TestCreateTexture(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, 32, 32);
+    TestFillTexture(texture, NULL);
+    TestPresent();
+
+    XBOX_CHECK_INT(SDL_RenderBeginXboxDisplayList(renderer), 0);
+    TestCopy(texture, 0, 0, 16, 16, 0.0f, 0.0f, SDL_BLENDMODE_BLEND);
+    list = SDL_RenderEndXboxDisplayList(renderer);
+    XBOX_CHECK(list != NULL);
+    XBOX_CHECK_INT(list->numsegments, 1);
+    XBOX_CHECK(list->segments[0].pushbuffer != NULL);
+    XBOX_CHECK_INT(TestTexturePins(texture), 1);
+
+    /* the streaming draw stays a command, bound to the buffer current at
+       replay */
+    XBOX_CHECK_INT(SDL_RenderBeginXboxDisplayList(renderer), 0);
+    TestCopy(streaming, 0, 0, 16, 16, 0.0f, 0.0f, SDL_BLENDMODE_BLEND);
+    streamlist = SDL_RenderEndXboxDisplayList(renderer);
+    XBOX_CHECK(streamlist != NULL);
+    XBOX_CHECK_INT(streamlist->numsegments, 1);
+    XBOX_CHECK(streamlist->segments[0].pushbuffer == NULL);
+    XBOX_CHECK(streamlist->segments[0].cmds != NULL);
+
+    MockXDK_ResetCounters();
+    XBOX_CHECK_INT(SDL_RenderRunXboxDisplayList(renderer, list), 0);
+    XBOX_CHECK_INT(SDL_RenderRunXboxDisplayList(renderer, streamlist), 0);
+    XBOX_CHECK_INT(mock_xdk.pushbuffer_runs, 1);
+    XBOX_CHECK_INT(mock_xdk.draw_calls, 1);
+    TestPresent();
+
+    /* after a reset both lists are stale and their pins are gone */
+    XBOX_CHECK_INT(D3D_Reset(renderer), 0);
+    XBOX_CHECK_INT(TestTexturePins(texture), 0);
+    MockXDK_ResetCounters();
+    XBOX_CHECK(SDL_RenderRunXboxDisplayList(renderer, list) < 0);
+    XBOX_CHECK(SDL_RenderRunXboxDisplayList(renderer, streamlist) < 0);
+    XBOX_CHECK_INT(mock_xdk.pushbuffer_runs, 0);
+    XBOX_CHECK_INT(mock_xdk.draw_calls, 0);
+
+    SDL_RenderDestroyXboxDisplayList(list);
+    SDL_RenderDestroyXboxDisplayList(streamlist);
+    XBOX_CHECK_INT(TestTexturePins(texture), 0);
+
+    TestDestroyTexture(streaming);
+    TestDestroyTexture(texture);
+    TestDestroyRenderer();
+}
+
+/* Static textures in an atlas page sit inside a border of copies of their
+   edge texels, so bilinear filtering never reads the entry next door. */
+static void
+TestAtlasBorder(void)
+{
+    const SDL_Rect corner = { 12, 12, 4, 4 };
+    SDL_Texture *textures[2];
+    D3DLOCKED_RECT locked;
+    int i, x, y, bad = 0;
+
+    SDL_SetHint(SDL_HINT_RENDER_XBOX_ATLAS, "1");
+    TestCreateRenderer();
+    for (i = 0; i < 2; ++i) {
+        textures[i] = TestCreateTexture(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 16, 16);
+        TestFillTexture(textures[i], NULL);
+    }
+    XBOX_CHECK(renderdata->atlases != NULL);
+    XBOX_CHECK(((D3D_TextureData *)textures[0]->driverdata)->atlas == renderdata->atlases);
+    XBOX_CHECK(((D3D_TextureData *)textures[1]->driverdata)->atlas == renderdata->atlases);
+
+    /* a later write to one corner refreshes that part of the border */
+    TestFillTexture(textures[1], &corner);
+
+    XBOX_CHECK_INT(IDirect3DTexture8_LockRect(renderdata->atlases->texture.staging, 0, &locked, NULL, 0), D3D_OK);
+    for (i = 0; i < 2; ++i) {
+        const SDL_Rect *entry = &((D3D_TextureData *)textures[i]->driverdata)->atlasrect;
+        const Uint8 *origin = (const Uint8 *)locked.pBits + entry->y * locked.Pitch + entry->x * 4;
+
+        XBOX_CHECK(entry->x >= 1 && entry->y >= 1);
+        for (y = -1; y <= entry->h; ++y) {
+            for (x = -1; x <= entry->w; ++x) {
+                const int cx = SDL_clamp(x, 0, entry->w - 1);
+                const int cy = SDL_clamp(y, 0, entry->h - 1);
+                if (SDL_memcmp(origin + y * (int)locked.Pitch + x * 4,
+                               origin + cy * (int)locked.Pitch + cx * 4, 4) != 0) {
+                    ++bad;
+                }
+            }
+        }
+    }
+    XBOX_CHECK_INT(bad, 0);
+
+    /* the whole entry and its border go up with the next draw */
+    TestCopy(textures[0], 0, 0, 16, 16, 0.0f, 0.0f, SDL_BLENDMODE_BLEND);
+    TestPresent();
+    XBOX_CHECK(!renderdata->atlases->texture.dirty);
+
+    TestDestroyTexture(textures[1]);
+    TestDestroyTexture(textures[0]);
+    TestDestroyRenderer();
+    SDL_SetHint(SDL_HINT_RENDER_XBOX_ATLAS, NULL);
+}
+
+/* A partial lock of a streaming texture moves to the next buffer too, and
+   carries the rest of the previous buffer over, so the GPU never reads a
+   buffer while the CPU writes it. */
+static void
+TestStreamingPartialLock(void)
+{
+    const SDL_Rect rect = { 8, 4, 5, 3 };
+    SDL_Texture *texture;
+    D3D_TextureRep *rep;
+    D3DLOCKED_RECT before, after;
+    void *pixels;
+    int pitch, previous, x, y, bad = 0;
+
+    TestCreateRenderer();
+    texture = TestCreateTexture(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, 32, 32);
+    rep = &((D3D_TextureData *)texture->driverdata)->texture;
+    XBOX_CHECK_INT(rep->numstreaming, 2);
+    TestFillTexture(texture, NULL);
+    previous = rep->curstreaming;
+
+    XBOX_CHECK_INT(renderer->LockTexture(renderer, texture, &rect, &pixels, &pitch), 0);
+    XBOX_CHECK(rep->curstreaming != previous);
+    for (y = 0; y < rect.h; ++y) {
+        for (x = 0; x < rect.w; ++x) {
+            ((Uint32 *)((Uint8 *)pixels + y * pitch))[x] = 0x12345678u;
+        }
+    }
+    renderer->UnlockTexture(renderer, texture);
+
+    IDirect3DTexture8_LockRect(rep->streaming[previous], 0, &before, NULL, D3DLOCK_READONLY);
+    IDirect3DTexture8_LockRect(rep->texture, 0, &after, NULL, D3DLOCK_READONLY);
+    for (y = 0; y < rep->h; ++y) {
+        for (x = 0; x < rep->w; ++x) {
+            const Uint32 old = ((const Uint32 *)((const Uint8 *)before.pBits + y * before.Pitch))[x];
+            const Uint32 cur = ((const Uint32 *)((const Uint8 *)after.pBits + y * after.Pitch))[x];
+            const SDL_bool inside = (x >= rect.x && x < rect.x + rect.w &&
+                                     y >= rect.y && y < rect.y + rect.h) ? SDL_TRUE : SDL_FALSE;
+            if (old == 0x12345678u || cur != (inside ? 0x12345678u : old)) {
+                ++bad;
+            }
+        }
+    }
+    XBOX_CHECK_INT(bad, 0);
+
+    /* partial updates rotate as well */
+    previous = rep->curstreaming;
+    TestFillTexture(texture, &rect);
+    XBOX_CHECK(rep->curstreaming != previous);
+
+    TestDestroyTexture(texture);
+    TestDestroyRenderer();
+}
+
+/* Rotated copies use a polynomial sine and cosine: exact on multiples of
+   90 degrees and within float precision of libm elsewhere. */
+static void
+TestSinCos(void)
+{
+    static const double exact[] = { 0.0, 90.0, 180.0, 270.0, 360.0, -90.0, -180.0, 450.0, -720.0 };
+    float s, c;
+    double angle;
+    int i, bad = 0;
+
+    for (i = 0; i < (int)SDL_arraysize(exact); ++i) {
+        const int quadrant = ((int)(exact[i] / 90.0) % 4 + 4) % 4;
+        D3D_SinCosDegrees(exact[i], &s, &c);
+        XBOX_CHECK(s == (float)(quadrant == 1) - (float)(quadrant == 3));
+        XBOX_CHECK(c == (float)(quadrant == 0) - (float)(quadrant == 2));
+    }
+
+    for (angle = -1000.0; angle <= 1000.0; angle += 0.37) {
+        const double radians = angle * (3.14159265358979323846 / 180.0);
+        D3D_SinCosDegrees(angle, &s, &c);
+        if (fabs(s - sin(radians)) > 1e-6 || fabs(c - cos(radians)) > 1e-6) {
+            fprintf(stderr, "angle %g: %g %g, expected %g %g\n", angle, s, c, sin(radians), cos(radians));
+            ++bad;
+        }
+    }
+    XBOX_CHECK_INT(bad, 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    TestBatching();
+    TestStateCache();
+    TestStatsOverlay();
+    TestDirtyUpload();
+    TestDisplayListReset();
+    TestAtlasBorder();
+    TestStreamingPartialLock();
+    TestSinCos();
+
+    return testxbox_done("testrender");
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,218 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Checks XBOX_SwizzleRect/XBOX_UnswizzleRect against a straightforward
+   bit-by-bit interleave of the texel coordinates. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL_xbox_swizzle.h"
+
+#include "testxbox.h"
+
+/* Texel index of (x, y) in a swizzled width x height image: x and y bits
+   alternate, x first, until the shorter side runs out of bits. */
+static Uint32
+ReferenceOffset(int x, int y, int width, int height)
+{
+    Uint32 offset = 0;
+    int out = 0, bit;
+
+    for (bit = 0; (1 << bit) < width || (1 << bit) < height; ++bit) {
+        if ((1 << bit) < width) {
+            offset |= (Uint32)((x >> bit) & 1) << out++;
+        }
+        if ((1 << bit) < height) {
+            offset |= (Uint32)((y >> bit) & 1) << out++;
+        }
+    }
+    return offset;
+}
+
+static Uint32
+TexelValue(int x, int y)
+{
+    return 0x01000000u * (Uint32)(x + 1) + 0x00010000u * (Uint32)(y + 1) + (Uint32)(x * 31 + y * 7);
+}
+
+static void
+StoreTexel(Uint8 *p, int bpp, Uint32 value)
+{
+    switch (bpp) {
+    case 4: *(Uint32 *)p = value; break;
+    case 2: *(Uint16 *)p = (Uint16)value; break;
+    default: *p = (Uint8)value; break;
+    }
+}
+
+static Uint32
+LoadTexel(const Uint8 *p, int bpp)
+{
+    switch (bpp) {
+    case 4: return *(const Uint32 *)p;
+    case 2: return *(const Uint16 *)p;
+    default: return *p;
+    }
+}
+
+static Uint32
+Truncate(Uint32 value, int bpp)
+{
+    return (bpp == 4) ? value : (value & ((1u << (bpp * 8)) - 1));
+}
+
+static void
+TestKnownOffsets(void)
+{
+    XBOX_CHECK_INT(ReferenceOffset(1, 0, 4, 4), 1);
+    XBOX_CHECK_INT(ReferenceOffset(0, 1, 4, 4), 2);
+    XBOX_CHECK_INT(ReferenceOffset(3, 3, 4, 4), 15);
+    XBOX_CHECK_INT(ReferenceOffset(4, 1, 8, 2), 10);
+}
+
+static void
+TestCanSwizzle(void)
+{
+    XBOX_CHECK(XBOX_CanSwizzle(1, 1));
+    XBOX_CHECK(XBOX_CanSwizzle(64, 8));
+    XBOX_CHECK(!XBOX_CanSwizzle(0, 8));
+    XBOX_CHECK(!XBOX_CanSwizzle(48, 8));
+    XBOX_CHECK(!XBOX_CanSwizzle(8, 12));
+}
+
+/* Swizzles a whole linear image, compares every texel with the reference
+   layout, then unswizzles it back. */
+static void
+TestRoundTrip(int width, int height, int bpp)
+{
+    const int pitch = width * bpp;
+    Uint8 *linear = (Uint8 *)malloc((size_t)pitch * height);
+    Uint8 *swizzled = (Uint8 *)malloc((size_t)pitch * height);
+    Uint8 *back = (Uint8 *)malloc((size_t)pitch * height);
+    SDL_Rect rect;
+    int x, y, bad = 0;
+
+    for (y = 0; y < height; ++y) {
+        for (x = 0; x < width; ++x) {
+            StoreTexel(linear + y * pitch + x * bpp, bpp, TexelValue(x, y));
+        }
+    }
+    memset(swizzled, 0xCD, (size_t)pitch * height);
+    memset(back, 0xCD, (size_t)pitch * height);
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = width;
+    rect.h = height;
+    XBOX_SwizzleRect(linear, pitch, swizzled, width, height, &rect, bpp);
+
+    for (y = 0; y < height; ++y) {
+        for (x = 0; x < width; ++x) {
+            const Uint32 offset = ReferenceOffset(x, y, width, height);
+            if (LoadTexel(swizzled + offset * bpp, bpp) != Truncate(TexelValue(x, y), bpp)) {
+                ++bad;
+            }
+        }
+    }
+    if (bad) {
+        fprintf(stderr, "%dx%d bpp %d: %d texels out of place\n", width, height, bpp, bad);
+    }
+    XBOX_CHECK_INT(bad, 0);
+
+    XBOX_UnswizzleRect(swizzled, width, height, &rect, back, pitch, bpp);
+    XBOX_CHECK(memcmp(linear, back, (size_t)pitch * height) == 0);
+
+    free(linear);
+    free(swizzled);
+    free(back);
+}
+
+/* Swizzles a sub-rectangle into a cleared image: only the texels inside
+   the rectangle may change. */
+static void
+TestSubRect(int width, int height, int bpp, int rx, int ry, int rw, int rh)
+{
+    const int src_pitch = rw * bpp;
+    Uint8 *src = (Uint8 *)malloc((size_t)src_pitch * rh);
+    Uint8 *swizzled = (Uint8 *)calloc((size_t)width * height, bpp);
+    Uint8 *back = (Uint8 *)calloc((size_t)src_pitch, rh);
+    SDL_Rect rect;
+    int x, y, bad = 0;
+
+    for (y = 0; y < rh; ++y) {
+        for (x = 0; x < rw; ++x) {
+            StoreTexel(src + y * src_pitch + x * bpp, bpp, TexelValue(rx + x, ry + y) | 1);
+        }
+    }
+
+    rect.x = rx;
+    rect.y = ry;
+    rect.w = rw;
+    rect.h = rh;
+    XBOX_SwizzleRect(src, src_pitch, swizzled, width, height, &rect, bpp);
+
+    for (y = 0; y < height; ++y) {
+        for (x = 0; x < width; ++x) {
+            const Uint32 texel = LoadTexel(swizzled + ReferenceOffset(x, y, width, height) * bpp, bpp);
+            const SDL_bool inside = (x >= rx && x < rx + rw && y >= ry && y < ry + rh);
+            const Uint32 expected = inside ? Truncate(TexelValue(x, y) | 1, bpp) : 0;
+            if (texel != expected) {
+                ++bad;
+            }
+        }
+    }
+    XBOX_CHECK_INT(bad, 0);
+
+    XBOX_UnswizzleRect(swizzled, width, height, &rect, back, src_pitch, bpp);
+    XBOX_CHECK(memcmp(src, back, (size_t)src_pitch * rh) == 0);
+
+    free(src);
+    free(swizzled);
+    free(back);
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const int sizes[][2] = {
+        { 1, 1 }, { 2, 8 }, { 8, 2 }, { 16, 16 }, { 64, 32 }, { 32, 128 }
+    };
+    static const int bpps[] = { 1, 2, 4 };
+    size_t i, j;
+
+    TestKnownOffsets();
+    TestCanSwizzle();
+
+    for (i = 0; i < SDL_arraysize(sizes); ++i) {
+        for (j = 0; j < SDL_arraysize(bpps); ++j) {
+            TestRoundTrip(sizes[i][0], sizes[i][1], bpps[j]);
+        }
+    }
+
+    TestSubRect(16, 16, 4, 3, 5, 7, 9);
+    TestSubRect(64, 32, 2, 33, 1, 30, 17);
+    TestSubRect(8, 32, 1, 0, 31, 8, 1);
+
+    return testxbox_done("testswizzle");
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,195 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* SDL entry points the Xbox sources under test call: the stdlib ones mapped
+   onto the host C library, errors and logs kept local (set TESTXBOX_VERBOSE
+   to print them), and a small hint table, so the tests don't need a full
+   SDL build. */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "SDL_stdinc.h"
+#include "SDL_assert.h"
+#include "SDL_error.h"
+#include "SDL_hints.h"
+#include "SDL_log.h"
+
+#include "testxbox.h"
+
+int testxbox_failures = 0;
+
+int
+testxbox_done(const char *name)
+{
+    if (testxbox_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, testxbox_failures);
+        return 1;
+    }
+    printf("%s: passed\n", name);
+    return 0;
+}
+
+void *SDL_malloc(size_t size) { return malloc(size); }
+void *SDL_calloc(size_t nmemb, size_t size) { return calloc(nmemb, size); }
+void *SDL_realloc(void *mem, size_t size) { return realloc(mem, size); }
+void SDL_free(void *mem) { free(mem); }
+void *SDL_memset(void *dst, int c, size_t len) { return memset(dst, c, len); }
+void *SDL_memcpy(void *dst, const void *src, size_t len) { return memcpy(dst, src, len); }
+void *SDL_memmove(void *dst, const void *src, size_t len) { return memmove(dst, src, len); }
+int SDL_memcmp(const void *s1, const void *s2, size_t len) { return memcmp(s1, s2, len); }
+int SDL_atoi(const char *str) { return atoi(str); }
+double SDL_sin(double x) { return sin(x); }
+double SDL_cos(double x) { return cos(x); }
+float SDL_sinf(float x) { return sinf(x); }
+float SDL_cosf(float x) { return cosf(x); }
+float SDL_sqrtf(float x) { return sqrtf(x); }
+
+static char testxbox_error[256];
+
+int
+SDL_SetError(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(testxbox_error, sizeof(testxbox_error), fmt, ap);
+    va_end(ap);
+    if (getenv("TESTXBOX_VERBOSE")) {
+        fprintf(stderr, "SDL_SetError: %s\n", testxbox_error);
+    }
+    return -1;
+}
+
+const char *SDL_GetError(void) { return testxbox_error; }
+void SDL_ClearError(void) { testxbox_error[0] = '\0'; }
+
+int
+SDL_Error(SDL_errorcode code)
+{
+    switch (code) {
+    case SDL_ENOMEM: return SDL_SetError("Out of memory");
+    case SDL_UNSUPPORTED: return SDL_SetError("That operation is not supported");
+    default: return SDL_SetError("Unknown SDL error");
+    }
+}
+
+static void
+testxbox_log(const char *fmt, va_list ap)
+{
+    if (getenv("TESTXBOX_VERBOSE")) {
+        vfprintf(stderr, fmt, ap);
+        fputc('\n', stderr);
+    }
+}
+
+void
+SDL_Log(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    testxbox_log(fmt, ap);
+    va_end(ap);
+}
+
+void
+SDL_LogError(int category, const char *fmt, ...)
+{
+    va_list ap;
+    (void)category;
+    va_start(ap, fmt);
+    testxbox_log(fmt, ap);
+    va_end(ap);
+}
+
+SDL_AssertState
+SDL_ReportAssertion(SDL_AssertData *data, const char *func, const char *file, int line)
+{
+    fprintf(stderr, "%s:%d: %s: assertion '%s' failed\n", file, line, func, data->condition);
+    abort();
+    return SDL_ASSERTION_ABORT;
+}
+
+/* A handful of hints is all the tests set. */
+#define TESTXBOX_MAX_HINTS 16
+
+static struct
+{
+    char name[64];
+    char value[64];
+} testxbox_hints[TESTXBOX_MAX_HINTS];
+
+SDL_bool
+SDL_SetHint(const char *name, const char *value)
+{
+    int i, slot = -1;
+
+    for (i = 0; i < TESTXBOX_MAX_HINTS; ++i) {
+        if (strcmp(testxbox_hints[i].name, name) == 0) {
+            slot = i;
+            break;
+        }
+        if (slot < 0 && !testxbox_hints[i].name[0]) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        return SDL_FALSE;
+    }
+    if (!value) {
+        testxbox_hints[slot].name[0] = '\0';
+        return SDL_TRUE;
+    }
+    snprintf(testxbox_hints[slot].name, sizeof(testxbox_hints[slot].name), "%s", name);
+    snprintf(testxbox_hints[slot].value, sizeof(testxbox_hints[slot].value), "%s", value);
+    return SDL_TRUE;
+}
+
+const char *
+SDL_GetHint(const char *name)
+{
+    int i;
+
+    for (i = 0; i < TESTXBOX_MAX_HINTS; ++i) {
+        if (testxbox_hints[i].name[0] && strcmp(testxbox_hints[i].name, name) == 0) {
+            return testxbox_hints[i].value;
+        }
+    }
+    return NULL;
+}
+
+SDL_bool
+SDL_GetHintBoolean(const char *name, SDL_bool default_value)
+{
+    const char *hint = SDL_GetHint(name);
+
+    if (!hint || !*hint) {
+        return default_value;
+    }
+    return (*hint == '0' || SDL_strcasecmp(hint, "false") == 0) ? SDL_FALSE : SDL_TRUE;
+}
+
+int SDL_strcasecmp(const char *str1, const char *str2) { return strcasecmp(str1, str2); }
+
+/* vi: set ts=4 sw=4 expandtab: */
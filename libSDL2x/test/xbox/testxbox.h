@@ -0,0 +1,59 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2019 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Host test helpers for the Xbox backends.
+
+   The tests build the Xbox sources with the Xbox configuration on a desktop
+   compiler, against the small XDK stand-in in mock/ and the SDL shims in
+   testxbox.c. Each test is a plain program that exits non-zero on failure. */
+
+#ifndef testxbox_h_
+#define testxbox_h_
+
+#include <stdio.h>
+
+extern int testxbox_failures;
+
+#define XBOX_CHECK(cond)                                                    \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++testxbox_failures;                                            \
+        }                                                                   \
+    } while (0)
+
+#define XBOX_CHECK_INT(actual, expected)                                    \
+    do {                                                                    \
+        const long long a_ = (long long)(actual);                           \
+        const long long e_ = (long long)(expected);                         \
+        if (a_ != e_) {                                                     \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n",           \
+                    __FILE__, __LINE__, #actual, a_, e_);                   \
+            ++testxbox_failures;                                            \
+        }                                                                   \
+    } while (0)
+
+/* Prints a summary and returns the exit code for main(). */
+extern int testxbox_done(const char *name);
+
+#endif /* testxbox_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -1048,6 +1048,19 @@ extern "C" {
 	 */
 	extern DECLSPEC int SDLCALL IMG_isQOI(SDL_RWops* src);
 
+	/**
+	 * Detect DDS image data on a readable/seekable SDL_RWops.
+	 *
+	 * This function will always attempt to seek the RWops back to where it
+	 * started when this function was called.
+	 *
+	 * \param src a seekable/readable SDL_RWops to provide image data.
+	 * \returns non-zero if this is DDS data, zero otherwise.
+	 *
+	 * \sa IMG_LoadDDSTexture_RW
+	 */
+	extern DECLSPEC int SDLCALL IMG_isDDS(SDL_RWops* src);
+
 	/**
 	 * Detect TIFF image data on a readable/seekable SDL_RWops.
 	 *
@@ -1705,6 +1718,37 @@ extern "C" {
 	 */
 	extern DECLSPEC SDL_Surface* SDLCALL IMG_LoadQOI_RW(SDL_RWops* src);
 
+	/**
+	 * Load a DDS image directly.
+	 *
+	 * DDS images hold DXT compressed data, which cannot be stored in an
+	 * SDL_Surface; this always fails. Use IMG_LoadDDSTexture_RW() or
+	 * IMG_LoadTexture() instead.
+	 *
+	 * \param src an SDL_RWops to load image data from.
+	 * \returns NULL, with an error set.
+	 *
+	 * \sa IMG_LoadDDSTexture_RW
+	 */
+	extern DECLSPEC SDL_Surface* SDLCALL IMG_LoadDDS_RW(SDL_RWops* src);
+
+	/**
+	 * Load a DXT1/DXT3/DXT5 DDS image into a compressed GPU texture.
+	 *
+	 * The compressed blocks are uploaded as is, so the texture takes a quarter
+	 * (DXT3/DXT5) or an eighth (DXT1) of the memory of a 32-bit texture. Only
+	 * the top mipmap level is loaded. The renderer must support the
+	 * SDL_PIXELFORMAT_DXT* formats, and the image must have power-of-two
+	 * dimensions. IMG_LoadTexture() and friends call this for DDS data.
+	 *
+	 * \param renderer the SDL_Renderer to use to create the GPU texture.
+	 * \param src an SDL_RWops to load image data from. It is not closed.
+	 * \returns a new static texture, or NULL on error.
+	 *
+	 * \sa IMG_isDDS
+	 */
+	extern DECLSPEC SDL_Texture* SDLCALL IMG_LoadDDSTexture_RW(SDL_Renderer* renderer, SDL_RWops* src);
+
 	/**
 	 * Load a TGA image directly.
 	 *
@@ -62,6 +62,7 @@ static struct {
 	{ "CUR", IMG_isCUR, IMG_LoadCUR_RW },
 	{ "ICO", IMG_isICO, IMG_LoadICO_RW },
 	{ "BMP", IMG_isBMP, IMG_LoadBMP_RW },
+	{ "DDS", IMG_isDDS, IMG_LoadDDS_RW },
 	{ "GIF", IMG_isGIF, IMG_LoadGIF_RW },
 	{ "JPG", IMG_isJPG, IMG_LoadJPG_RW },
 	{ "JXL", IMG_isJXL, IMG_LoadJXL_RW },
@@ -304,30 +305,37 @@ SDL_Surface* IMG_LoadTyped_RW(SDL_RWops* src, int freesrc, const char* type)
 #if SDL_VERSION_ATLEAST(2,0,0)
 SDL_Texture* IMG_LoadTexture(SDL_Renderer* renderer, const char* file)
 {
-	SDL_Texture* texture = NULL;
-	SDL_Surface* surface = IMG_Load(file);
-	if (surface) {
-		texture = SDL_CreateTextureFromSurface(renderer, surface);
-		SDL_FreeSurface(surface);
+	SDL_RWops* src = SDL_RWFromFile(file, "rb");
+	const char* ext = SDL_strrchr(file, '.');
+	if (ext) {
+		ext++;
 	}
-	return texture;
+	if (!src) {
+		/* The error message has been set in SDL_RWFromFile */
+		return NULL;
+	}
+	return IMG_LoadTextureTyped_RW(renderer, src, 1, ext);
 }
 
 SDL_Texture* IMG_LoadTexture_RW(SDL_Renderer* renderer, SDL_RWops* src, int freesrc)
 {
-	SDL_Texture* texture = NULL;
-	SDL_Surface* surface = IMG_Load_RW(src, freesrc);
-	if (surface) {
-		texture = SDL_CreateTextureFromSurface(renderer, surface);
-		SDL_FreeSurface(surface);
-	}
-	return texture;
+	return IMG_LoadTextureTyped_RW(renderer, src, freesrc, NULL);
 }
 
 SDL_Texture* IMG_LoadTextureTyped_RW(SDL_Renderer* renderer, SDL_RWops* src, int freesrc, const char* type)
 {
 	SDL_Texture* texture = NULL;
-	SDL_Surface* surface = IMG_LoadTyped_RW(src, freesrc, type);
+	SDL_Surface* surface;
+
+	/* Compressed images go to the renderer without a surface in between */
+	if (src && IMG_isDDS(src)) {
+		texture = IMG_LoadDDSTexture_RW(renderer, src);
+		if (freesrc)
+			SDL_RWclose(src);
+		return texture;
+	}
+
+	surface = IMG_LoadTyped_RW(src, freesrc, type);
 	if (surface) {
 		texture = SDL_CreateTextureFromSurface(renderer, surface);
 		SDL_FreeSurface(surface);
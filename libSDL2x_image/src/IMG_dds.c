@@ -0,0 +1,173 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+	 claim that you wrote the original software. If you use this software
+	 in a product, an acknowledgment in the product documentation would be
+	 appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+	 misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* This is a DDS image file loading framework.
+ *
+ * Only DXT1/DXT3/DXT5 compressed images are supported, and only as textures:
+ * the compressed blocks are handed to the renderer as is. Mipmaps beyond the
+ * top level are ignored.
+ */
+
+#include "SDL_image.h"
+
+#if defined(LOAD_DDS) && defined(SDL_PIXELFORMAT_DXT1)
+
+#define DDS_MAGIC           0x20534444 /* "DDS " */
+#define DDS_HEADER_SIZE     124
+#define DDS_PIXELFORMAT_SIZE 32
+#define DDPF_FOURCC         0x00000004
+
+/* See if an image is contained in a data source */
+int IMG_isDDS(SDL_RWops* src)
+{
+	Sint64 start;
+	int is_DDS;
+	Uint32 magic;
+
+	if (!src)
+		return 0;
+	start = SDL_RWtell(src);
+	is_DDS = 0;
+	magic = SDL_ReadLE32(src);
+	if (magic == DDS_MAGIC) {
+		is_DDS = 1;
+	}
+	SDL_RWseek(src, start, RW_SEEK_SET);
+	return(is_DDS);
+}
+
+/* Load a DDS type image from an SDL datasource */
+SDL_Surface* IMG_LoadDDS_RW(SDL_RWops* src)
+{
+	(void)src;
+	IMG_SetError("DDS images can only be loaded as textures, use IMG_LoadTexture()");
+	return(NULL);
+}
+
+/* Load a DDS type image from an SDL datasource into a compressed texture */
+SDL_Texture* IMG_LoadDDSTexture_RW(SDL_Renderer* renderer, SDL_RWops* src)
+{
+	Uint32 header[DDS_HEADER_SIZE / 4];
+	Uint32 format, flags, fourcc;
+	int w, h, i, blockbytes, pitch;
+	size_t size;
+	void* blocks;
+	SDL_Texture* texture;
+
+	if (!src) {
+		IMG_SetError("Passed a NULL data source");
+		return NULL;
+	}
+
+	if (SDL_ReadLE32(src) != DDS_MAGIC) {
+		IMG_SetError("File is not a DDS image");
+		return NULL;
+	}
+	for (i = 0; i < SDL_arraysize(header); ++i) {
+		header[i] = SDL_ReadLE32(src);
+	}
+	if (header[0] != DDS_HEADER_SIZE || header[18] != DDS_PIXELFORMAT_SIZE) {
+		IMG_SetError("Corrupt DDS header");
+		return NULL;
+	}
+
+	h = (int)header[2];
+	w = (int)header[3];
+	flags = header[19];
+	fourcc = header[20];
+
+	if (!(flags & DDPF_FOURCC)) {
+		IMG_SetError("Unsupported DDS image: only DXT1/DXT3/DXT5 are supported");
+		return NULL;
+	}
+	switch (fourcc) {
+	case SDL_FOURCC('D', 'X', 'T', '1'):
+		format = SDL_PIXELFORMAT_DXT1;
+		blockbytes = 8;
+		break;
+	case SDL_FOURCC('D', 'X', 'T', '3'):
+		format = SDL_PIXELFORMAT_DXT3;
+		blockbytes = 16;
+		break;
+	case SDL_FOURCC('D', 'X', 'T', '5'):
+		format = SDL_PIXELFORMAT_DXT5;
+		blockbytes = 16;
+		break;
+	default:
+		IMG_SetError("Unsupported DDS image: only DXT1/DXT3/DXT5 are supported");
+		return NULL;
+	}
+	if (w <= 0 || h <= 0 || w > 0x4000 || h > 0x4000) {
+		IMG_SetError("Invalid DDS image size %dx%d", w, h);
+		return NULL;
+	}
+
+	pitch = ((w + 3) / 4) * blockbytes;
+	size = (size_t)pitch * (size_t)((h + 3) / 4);
+	blocks = SDL_malloc(size);
+	if (!blocks) {
+		SDL_OutOfMemory();
+		return NULL;
+	}
+	if (SDL_RWread(src, blocks, size, 1) != 1) {
+		SDL_free(blocks);
+		IMG_SetError("Truncated DDS image data");
+		return NULL;
+	}
+
+	texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC, w, h);
+	if (texture) {
+		if (SDL_UpdateTexture(texture, NULL, blocks, pitch) < 0) {
+			SDL_DestroyTexture(texture);
+			texture = NULL;
+		} else {
+			SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+		}
+	}
+	SDL_free(blocks);
+	return texture;
+}
+
+#else
+#if _MSC_VER >= 1300
+#pragma warning(disable : 4100) /* warning C4100: 'op' : unreferenced formal parameter */
+#endif
+
+/* See if an image is contained in a data source */
+int IMG_isDDS(SDL_RWops* src)
+{
+	return(0);
+}
+
+/* Load a DDS type image from an SDL datasource */
+SDL_Surface* IMG_LoadDDS_RW(SDL_RWops* src)
+{
+	return(NULL);
+}
+
+/* Load a DDS type image from an SDL datasource into a compressed texture */
+SDL_Texture* IMG_LoadDDSTexture_RW(SDL_Renderer* renderer, SDL_RWops* src)
+{
+	IMG_SetError("DDS images are not supported");
+	return(NULL);
+}
+
+#endif /* LOAD_DDS */
@@ -2097,6 +2097,50 @@ extern DECLSPEC int SDLCALL Mix_GetMusicVolume(Mix_Music *music);
  */
 extern DECLSPEC int SDLCALL Mix_MasterVolume(int volume);
 
+/**
+ * Play chunks on Xbox APU hardware voices instead of mixing them in software.
+ *
+ * Each playing channel gets its own DirectSound voice that plays the chunk
+ * straight from its sample memory. The APU then does the volume, panning
+ * (Mix_SetPanning(), Mix_SetDistance() and Mix_SetPosition()) and pitch
+ * (Mix_SetXboxChannelFrequency()), and the CPU only mixes music. If more
+ * channels play than there are voices, the channel that has been playing
+ * longest is halted to free one.
+ *
+ * Effects registered with Mix_RegisterEffect() on a channel do not run
+ * while hardware voices are in use; postmix effects still apply to music.
+ * Chunk memory must stay valid while it plays, as it does with
+ * Mix_FreeChunk().
+ *
+ * The mixer must be open with 8 or 16-bit integer mono or stereo audio.
+ * Changing the number of voices halts all channels.
+ *
+ * On other platforms the voices are mixed in software at the mixer rate,
+ * without panning or pitch, so the same code can run off the console.
+ *
+ * \param voices the number of voices to reserve, 0 to go back to software
+ *               mixing, or -1 to query.
+ * \returns the number of voices in use, which can be fewer than asked for
+ *          if the APU runs out, or -1 on error.
+ *
+ * \sa Mix_SetXboxChannelFrequency
+ */
+extern DECLSPEC int SDLCALL Mix_AllocateXboxVoices(int voices);
+
+/**
+ * Set the playback rate of a channel played on an Xbox hardware voice.
+ *
+ * Playing a chunk at a different rate than the mixer changes its pitch.
+ * Specifying a channel of -1 sets every channel.
+ *
+ * \param channel the channel to change, or -1 for all channels.
+ * \param frequency the rate in Hz, or 0 to play at the mixer rate.
+ * \returns zero.
+ *
+ * \sa Mix_AllocateXboxVoices
+ */
+extern DECLSPEC int SDLCALL Mix_SetXboxChannelFrequency(int channel, int frequency);
+
 /**
  * Halt playing of a particular channel.
  *
@@ -2139,6 +2139,26 @@ int Mix_SetPosition(int channel, Sint16 angle, Uint8 distance)
     return retval;
 }
 
+/* The stereo levels Mix_SetPanning(), Mix_SetDistance() and Mix_SetPosition()
+   gave a channel, for channels played on hardware voices where the effect
+   itself never runs. */
+void _Eff_GetPositionLevels(int channel, Uint8 *left, Uint8 *right, SDL_bool *swap)
+{
+    position_args *args = NULL;
+
+    if (channel >= 0 && channel < position_channels) {
+        args = pos_args_array[channel];
+    }
+    if (args == NULL || !args->in_use) {
+        *left = *right = 255;
+        *swap = SDL_FALSE;
+        return;
+    }
+    *left = (Uint8)((args->left_u8 * args->distance_u8) / 255);
+    *right = (Uint8)((args->right_u8 * args->distance_u8) / 255);
+    *swap = (args->room_angle == 180) ? SDL_TRUE : SDL_FALSE;
+}
+
 /* end of effects_position.c ... */
 
 /* vi: set ts=4 sw=4 expandtab: */
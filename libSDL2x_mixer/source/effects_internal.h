@@ -42,6 +42,8 @@ int _Mix_RegisterEffect_locked(int channel, Mix_EffectFunc_t f,
 int _Mix_UnregisterEffect_locked(int channel, Mix_EffectFunc_t f);
 int _Mix_UnregisterAllEffects_locked(int channel);
 
+void _Eff_GetPositionLevels(int channel, Uint8 *left, Uint8 *right, SDL_bool *swap);
+
 #endif /* _INCLUDE_EFFECTS_INTERNAL_H_ */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -26,6 +26,7 @@
 #include "music.h"
 #include "load_aiff.h"
 #include "load_voc.h"
+#include "xbox_voices.h"
 
 #define MIX_INTERNAL_EFFECT__
 #include "effects_internal.h"
@@ -87,6 +88,14 @@ static struct _Mix_Channel {
     Uint32 fade_length;
     Uint32 ticks_fade;
     effect_info *effects;
+    int voice;              /* hardware voice playing this channel, or -1 */
+    int voice_restart;      /* a new chunk was queued over the voice */
+    int voice_paused;
+    int voice_volume;       /* levels last sent to the voice */
+    Uint8 voice_left, voice_right;
+    SDL_bool voice_swap;
+    int frequency;          /* Mix_SetXboxChannelFrequency() */
+    int voice_frequency;
 } *mix_channel = NULL;
 
 static effect_info *posteffects = NULL;
@@ -94,6 +103,10 @@ static effect_info *posteffects = NULL;
 static int num_channels;
 static int reserved_channels = 0;
 
+/* Mix_AllocateXboxVoices(): owning channel of each hardware voice, or -1 */
+static int *voice_channel = NULL;
+static int num_voices = 0;
+
 
 /* Support for hooking into the mixer callback system */
 static Mix_MixCallback mix_postmix = NULL;
@@ -304,6 +317,118 @@ static void _Mix_channel_done_playing(int channel)
 }
 
 
+static void Mix_HaltChannel_locked(int which);
+
+static void _Mix_release_voice(int which)
+{
+    int voice = mix_channel[which].voice;
+
+    if (voice >= 0) {
+        XboxVoice_Stop(voice);
+        voice_channel[voice] = -1;
+        mix_channel[which].voice = -1;
+    }
+}
+
+/* Find a free voice for a channel, or take the one that has been playing
+   longest. MAKE SURE you hold the audio lock. */
+static int _Mix_acquire_voice(int which)
+{
+    int tries, i;
+
+    for (tries = 0; tries < num_voices; ++tries) {
+        int oldest = -1;
+
+        for (i = 0; i < num_voices; ++i) {
+            if (voice_channel[i] < 0) {
+                voice_channel[i] = which;
+                mix_channel[which].voice = i;
+                return i;
+            }
+            if (oldest < 0 || (Sint32)(mix_channel[voice_channel[i]].start_time - mix_channel[voice_channel[oldest]].start_time) < 0) {
+                oldest = i;
+            }
+        }
+        /* the finished callback may start something on the freed voice,
+           so look again */
+        Mix_HaltChannel_locked(voice_channel[oldest]);
+    }
+    return -1;
+}
+
+/*
+ * Bring a channel's hardware voice in line with the channel: start, restart,
+ *  pause and stop it, push volume, panning and frequency, and finish the
+ *  channel when the voice ran out. Called from the audio callback and
+ *  whenever a chunk is queued.
+ *  MAKE SURE Mix_LockAudio() is called before this (or you're in the
+ *   audio callback).
+ */
+static void _Mix_sync_voice(int which, int master_vol)
+{
+    struct _Mix_Channel *channel = &mix_channel[which];
+    Uint8 left, right;
+    SDL_bool swap;
+    int volume;
+
+    if (channel->voice >= 0 && (channel->playing <= 0 || channel->voice_restart)) {
+        _Mix_release_voice(which);
+    }
+    if (channel->playing <= 0 || channel->paused) {
+        if (channel->voice >= 0 && !channel->voice_paused) {
+            XboxVoice_Pause(channel->voice, SDL_TRUE);
+            channel->voice_paused = 1;
+        }
+        return;
+    }
+
+    if (channel->voice < 0) {
+        if (_Mix_acquire_voice(which) < 0 ||
+            XboxVoice_Start(channel->voice, channel->chunk->abuf, channel->chunk->alen,
+                            (channel->looping < 0) ? SDL_TRUE : SDL_FALSE) < 0) {
+            _Mix_release_voice(which);
+            Mix_HaltChannel_locked(which);
+            return;
+        }
+        channel->voice_restart = 0;
+        channel->voice_paused = 0;
+        channel->voice_volume = -1;
+        channel->voice_frequency = 0;
+    } else if (channel->voice_paused) {
+        XboxVoice_Pause(channel->voice, SDL_FALSE);
+        channel->voice_paused = 0;
+    } else if (!XboxVoice_IsPlaying(channel->voice)) {
+        /* The APU only loops forever; count the other loops here */
+        if (channel->looping > 0) {
+            --channel->looping;
+            XboxVoice_Start(channel->voice, channel->chunk->abuf, channel->chunk->alen, SDL_FALSE);
+        } else {
+            _Mix_release_voice(which);
+            channel->playing = 0;
+            channel->looping = 0;
+            channel->fading = MIX_NO_FADING;
+            channel->expire = 0;
+            _Mix_channel_done_playing(which);
+            return;
+        }
+    }
+
+    volume = (master_vol * (channel->volume * channel->chunk->volume)) / (MIX_MAX_VOLUME * MIX_MAX_VOLUME);
+    _Eff_GetPositionLevels(which, &left, &right, &swap);
+    if (volume != channel->voice_volume || left != channel->voice_left ||
+        right != channel->voice_right || swap != channel->voice_swap) {
+        XboxVoice_SetLevels(channel->voice, volume, left, right, swap);
+        channel->voice_volume = volume;
+        channel->voice_left = left;
+        channel->voice_right = right;
+        channel->voice_swap = swap;
+    }
+    if (channel->frequency != channel->voice_frequency) {
+        XboxVoice_SetFrequency(channel->voice, channel->frequency);
+        channel->voice_frequency = channel->frequency;
+    }
+}
+
 static void *Mix_DoEffects(int chan, void *snd, int len)
 {
     int posteffect = (chan == MIX_CHANNEL_POST);
@@ -381,7 +506,7 @@ mix_channels(void *udata, Uint8 *stream, int len)
                     }
                 }
             }
-            if (mix_channel[i].playing > 0) {
+            if (mix_channel[i].playing > 0 && !num_voices) {
                 int volume = (master_vol * (mix_channel[i].volume * mix_channel[i].chunk->volume)) / (MIX_MAX_VOLUME * MIX_MAX_VOLUME);
                 int index = 0;
                 int remaining = len;
@@ -442,6 +567,12 @@ mix_channels(void *udata, Uint8 *stream, int len)
                 }
             }
         }
+        if (num_voices) {
+            _Mix_sync_voice(i, master_vol);
+        }
+    }
+    if (num_voices) {
+        XboxVoice_Mix(stream, len);
     }
 
     /* rcg06122001 run posteffects... */
@@ -521,6 +652,9 @@ int Mix_OpenAudioDevice(int frequency, Uint16 format, int nchannels, int chunksi
         mix_channel[i].expire = 0;
         mix_channel[i].effects = NULL;
         mix_channel[i].paused = 0;
+        mix_channel[i].voice = -1;
+        mix_channel[i].voice_restart = 0;
+        mix_channel[i].frequency = 0;
     }
     Mix_VolumeMusic(SDL_MIX_MAXVOLUME);
 
@@ -602,6 +736,9 @@ int Mix_AllocateChannels(int numchans)
                 mix_channel[i].expire = 0;
                 mix_channel[i].effects = NULL;
                 mix_channel[i].paused = 0;
+                mix_channel[i].voice = -1;
+                mix_channel[i].voice_restart = 0;
+                mix_channel[i].frequency = 0;
             }
         }
         num_channels = numchans;
@@ -978,6 +1115,7 @@ Mix_Chunk *Mix_QuickLoad_RAW(Uint8 *mem, Uint32 len)
 /* MAKE SURE you hold the audio lock (Mix_LockAudio()) before calling this! */
 static void  Mix_HaltChannel_locked(int which)
 {
+    _Mix_release_voice(which);
     if (Mix_Playing(which)) {
         mix_channel[which].playing = 0;
         mix_channel[which].looping = 0;
@@ -1133,6 +1271,10 @@ int Mix_PlayChannelTimed(int which, Mix_Chunk *chunk, int loops, int ticks)
             mix_channel[which].fading = MIX_NO_FADING;
             mix_channel[which].start_time = sdl_ticks;
             mix_channel[which].expire = (ticks > 0) ? (sdl_ticks + (Uint32)ticks) : 0;
+            if (num_voices) {
+                mix_channel[which].voice_restart = 1;
+                _Mix_sync_voice(which, SDL_AtomicGet(&master_volume));
+            }
         }
     }
     Mix_UnlockAudio();
@@ -1214,6 +1356,10 @@ int Mix_FadeInChannelTimed(int which, Mix_Chunk *chunk, int loops, int ms, int t
             mix_channel[which].fade_length = (Uint32)ms;
             mix_channel[which].start_time = mix_channel[which].ticks_fade = sdl_ticks;
             mix_channel[which].expire = (ticks > 0) ? (sdl_ticks+(Uint32)ticks) : 0;
+            if (num_voices) {
+                mix_channel[which].voice_restart = 1;
+                _Mix_sync_voice(which, SDL_AtomicGet(&master_volume));
+            }
         }
     }
     Mix_UnlockAudio();
@@ -1410,6 +1556,7 @@ void Mix_CloseAudio(void)
             close_music();
             Mix_SetMusicCMD(NULL);
             Mix_HaltChannel(-1);
+            Mix_AllocateXboxVoices(0);
             _Mix_DeinitEffects();
             SDL_CloseAudioDevice(audio_device);
             audio_device = 0;
@@ -1793,6 +1940,63 @@ int Mix_MasterVolume(int volume)
     return prev_volume;
 }
 
+/* Play channels on hardware voices instead of mixing them into the stream */
+int Mix_AllocateXboxVoices(int voices)
+{
+    int *owners = NULL;
+    int i;
+
+    if (voices < 0) {
+        return num_voices;
+    }
+
+    Mix_LockAudio();
+    for (i = 0; i < num_channels; ++i) {
+        Mix_HaltChannel_locked(i);
+    }
+    XboxVoice_Close();
+    SDL_free(voice_channel);
+    voice_channel = NULL;
+    num_voices = 0;
+
+    if (voices > 0) {
+        owners = (int *)SDL_malloc((size_t)voices * sizeof(int));
+        if (owners == NULL) {
+            Mix_UnlockAudio();
+            return Mix_OutOfMemory();
+        }
+        voices = XboxVoice_Open(&mixer, voices);
+        if (voices < 0) {
+            SDL_free(owners);
+            Mix_UnlockAudio();
+            return -1;
+        }
+        for (i = 0; i < voices; ++i) {
+            owners[i] = -1;
+        }
+        voice_channel = owners;
+        num_voices = voices;
+    }
+    Mix_UnlockAudio();
+    return num_voices;
+}
+
+int Mix_SetXboxChannelFrequency(int which, int frequency)
+{
+    int i;
+
+    if (which == -1) {
+        for (i = 0; i < num_channels; ++i) {
+            Mix_SetXboxChannelFrequency(i, frequency);
+        }
+    } else if (which >= 0 && which < num_channels) {
+        Mix_LockAudio();
+        mix_channel[which].frequency = (frequency > 0) ? frequency : 0;
+        Mix_UnlockAudio();
+    }
+    return 0;
+}
+
 /* end of mixer.c ... */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,325 @@
+/*
+  SDL_mixer:  An audio mixer library based on the SDL library
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* This file supports playing chunks on the Xbox APU, one DirectSound
+   buffer per playing channel, instead of mixing them on the CPU. */
+
+#include "SDL.h"
+
+#include "SDL_mixer.h"
+#include "xbox_voices.h"
+
+#ifdef __XBOX__
+
+#include <xtl.h>
+
+typedef struct
+{
+    LPDIRECTSOUNDBUFFER buffer;
+    DWORD play_flags;
+} XboxVoice;
+
+static LPDIRECTSOUND voice_sound = NULL;
+static XboxVoice *voices = NULL;
+static int num_voices = 0;
+
+/* Linear gain to the hundredths of a decibel DirectSound works in */
+static LONG gain_to_millibels(float gain)
+{
+    LONG mb;
+
+    if (gain <= 0.0f) {
+        return DSBVOLUME_MIN;
+    }
+    mb = (LONG)(2000.0 * SDL_log10((double)gain));
+    return (mb < DSBVOLUME_MIN) ? DSBVOLUME_MIN : mb;
+}
+
+int XboxVoice_Open(const SDL_AudioSpec *spec, int count)
+{
+    WAVEFORMATEX wfx;
+    DSBUFFERDESC desc;
+    HRESULT result;
+    int i;
+
+    if (spec->format != AUDIO_U8 && spec->format != AUDIO_S16LSB) {
+        return Mix_SetError("Hardware voices need 8 or 16-bit integer audio");
+    }
+    if (spec->channels > 2) {
+        return Mix_SetError("Hardware voices need mono or stereo audio");
+    }
+
+    result = DirectSoundCreate(NULL, &voice_sound, NULL);
+    if (result != DS_OK) {
+        return Mix_SetError("DirectSoundCreate failed (0x%x)", (unsigned int)result);
+    }
+
+    voices = (XboxVoice *)SDL_calloc((size_t)count, sizeof(*voices));
+    if (voices == NULL) {
+        XboxVoice_Close();
+        return Mix_OutOfMemory();
+    }
+
+    SDL_zero(wfx);
+    wfx.wFormatTag = WAVE_FORMAT_PCM;
+    wfx.nChannels = spec->channels;
+    wfx.nSamplesPerSec = (DWORD)spec->freq;
+    wfx.wBitsPerSample = (WORD)SDL_AUDIO_BITSIZE(spec->format);
+    wfx.nBlockAlign = (WORD)(wfx.nChannels * (wfx.wBitsPerSample / 8));
+    wfx.nAvgBytesPerSec = wfx.nSamplesPerSec * wfx.nBlockAlign;
+
+    /* no storage of their own; SetBufferData() points them at a chunk */
+    SDL_zero(desc);
+    desc.dwSize = sizeof(desc);
+    desc.dwBufferBytes = 0;
+    desc.lpwfxFormat = &wfx;
+
+    /* the APU may have fewer voices left than asked for */
+    for (i = 0; i < count; ++i) {
+        if (IDirectSound_CreateSoundBuffer(voice_sound, &desc, &voices[i].buffer, NULL) != DS_OK) {
+            break;
+        }
+        /* same headroom as the SDL stream, so chunks keep their loudness */
+        IDirectSoundBuffer_SetHeadroom(voices[i].buffer, DSBHEADROOM_DEFAULT_2D);
+    }
+    num_voices = i;
+
+    if (!num_voices) {
+        XboxVoice_Close();
+        return Mix_SetError("Couldn't create any hardware voices");
+    }
+    return num_voices;
+}
+
+void XboxVoice_Close(void)
+{
+    int i;
+
+    for (i = 0; i < num_voices; ++i) {
+        IDirectSoundBuffer_Stop(voices[i].buffer);
+        IDirectSoundBuffer_Release(voices[i].buffer);
+    }
+    SDL_free(voices);
+    voices = NULL;
+    num_voices = 0;
+
+    if (voice_sound) {
+        IDirectSound_Release(voice_sound);
+        voice_sound = NULL;
+    }
+}
+
+int XboxVoice_Start(int voice, Uint8 *data, Uint32 len, SDL_bool loop)
+{
+    LPDIRECTSOUNDBUFFER buffer = voices[voice].buffer;
+    HRESULT result;
+
+    IDirectSoundBuffer_Stop(buffer);
+    result = IDirectSoundBuffer_SetBufferData(buffer, data, len);
+    if (result == DS_OK) {
+        IDirectSoundBuffer_SetCurrentPosition(buffer, 0);
+        voices[voice].play_flags = loop ? DSBPLAY_LOOPING : 0;
+        result = IDirectSoundBuffer_Play(buffer, 0, 0, voices[voice].play_flags);
+    }
+    if (result != DS_OK) {
+        return Mix_SetError("Couldn't start hardware voice (0x%x)", (unsigned int)result);
+    }
+    return 0;
+}
+
+void XboxVoice_Stop(int voice)
+{
+    /* let go of the sample memory too, the chunk may be freed next */
+    IDirectSoundBuffer_Stop(voices[voice].buffer);
+    IDirectSoundBuffer_SetBufferData(voices[voice].buffer, NULL, 0);
+}
+
+void XboxVoice_Pause(int voice, SDL_bool pause)
+{
+    /* Stop() keeps the play position, so Play() carries on from there */
+    if (pause) {
+        IDirectSoundBuffer_Stop(voices[voice].buffer);
+    } else {
+        IDirectSoundBuffer_Play(voices[voice].buffer, 0, 0, voices[voice].play_flags);
+    }
+}
+
+SDL_bool XboxVoice_IsPlaying(int voice)
+{
+    DWORD status = 0;
+
+    if (IDirectSoundBuffer_GetStatus(voices[voice].buffer, &status) != DS_OK) {
+        return SDL_FALSE;
+    }
+    return (status & DSBSTATUS_PLAYING) ? SDL_TRUE : SDL_FALSE;
+}
+
+void XboxVoice_SetLevels(int voice, int volume, Uint8 left, Uint8 right, SDL_bool swap)
+{
+    const float gain = (float)volume / MIX_MAX_VOLUME;
+    DSMIXBINVOLUMEPAIR bins[2];
+    DSMIXBINS mb;
+
+    /* a mono voice feeds both bins; a stereo one feeds one channel to each */
+    bins[0].dwMixBin = swap ? DSMIXBIN_FRONT_RIGHT : DSMIXBIN_FRONT_LEFT;
+    bins[0].lVolume = gain_to_millibels(gain * (swap ? right : left) / 255.0f);
+    bins[1].dwMixBin = swap ? DSMIXBIN_FRONT_LEFT : DSMIXBIN_FRONT_RIGHT;
+    bins[1].lVolume = gain_to_millibels(gain * (swap ? left : right) / 255.0f);
+
+    mb.dwMixBinCount = 2;
+    mb.lpMixBinVolumePairs = bins;
+    IDirectSoundBuffer_SetMixBins(voices[voice].buffer, &mb);
+}
+
+void XboxVoice_SetFrequency(int voice, int frequency)
+{
+    IDirectSoundBuffer_SetFrequency(voices[voice].buffer,
+        (frequency > 0) ? (DWORD)frequency : DSBFREQUENCY_ORIGINAL);
+}
+
+void XboxVoice_Mix(Uint8 *stream, int len)
+{
+    /* the APU mixes the voices itself */
+    (void)stream;
+    (void)len;
+}
+
+#else
+
+/* Elsewhere the voices are mixed into the stream in software, so the
+   voice path of the mixer runs and can be tested off the console. They
+   play at the mixer rate and apply the louder of their two levels to both
+   channels. */
+
+typedef struct
+{
+    Uint8 *data;
+    Uint32 len;
+    Uint32 pos;
+    SDL_bool loop;
+    SDL_bool playing;
+    SDL_bool paused;
+    int volume;
+} XboxVoice;
+
+static SDL_AudioFormat voice_format;
+static XboxVoice *voices = NULL;
+static int num_voices = 0;
+
+int XboxVoice_Open(const SDL_AudioSpec *spec, int count)
+{
+    if (spec->format != AUDIO_U8 && spec->format != AUDIO_S16LSB) {
+        return Mix_SetError("Hardware voices need 8 or 16-bit integer audio");
+    }
+    if (spec->channels > 2) {
+        return Mix_SetError("Hardware voices need mono or stereo audio");
+    }
+
+    voices = (XboxVoice *)SDL_calloc((size_t)count, sizeof(*voices));
+    if (voices == NULL) {
+        return Mix_OutOfMemory();
+    }
+    voice_format = spec->format;
+    num_voices = count;
+    return num_voices;
+}
+
+void XboxVoice_Close(void)
+{
+    SDL_free(voices);
+    voices = NULL;
+    num_voices = 0;
+}
+
+int XboxVoice_Start(int voice, Uint8 *data, Uint32 len, SDL_bool loop)
+{
+    XboxVoice *v = &voices[voice];
+
+    v->data = data;
+    v->len = len;
+    v->pos = 0;
+    v->loop = loop;
+    v->playing = (len > 0) ? SDL_TRUE : SDL_FALSE;
+    v->paused = SDL_FALSE;
+    return 0;
+}
+
+void XboxVoice_Stop(int voice)
+{
+    XboxVoice *v = &voices[voice];
+
+    v->data = NULL;
+    v->len = 0;
+    v->pos = 0;
+    v->playing = SDL_FALSE;
+    v->paused = SDL_FALSE;
+}
+
+void XboxVoice_Pause(int voice, SDL_bool pause)
+{
+    voices[voice].paused = pause;
+}
+
+SDL_bool XboxVoice_IsPlaying(int voice)
+{
+    return (voices[voice].playing && !voices[voice].paused) ? SDL_TRUE : SDL_FALSE;
+}
+
+void XboxVoice_SetLevels(int voice, int volume, Uint8 left, Uint8 right, SDL_bool swap)
+{
+    (void)swap;
+    voices[voice].volume = (volume * SDL_max(left, right)) / 255;
+}
+
+void XboxVoice_SetFrequency(int voice, int frequency)
+{
+    (void)voice;
+    (void)frequency;
+}
+
+void XboxVoice_Mix(Uint8 *stream, int len)
+{
+    int i;
+
+    for (i = 0; i < num_voices; ++i) {
+        XboxVoice *v = &voices[i];
+        int index = 0;
+
+        while (v->playing && !v->paused && index < len) {
+            const Uint32 mixable = SDL_min(v->len - v->pos, (Uint32)(len - index));
+
+            SDL_MixAudioFormat(stream + index, v->data + v->pos, voice_format, mixable, v->volume);
+            v->pos += mixable;
+            index += (int)mixable;
+            if (v->pos == v->len) {
+                if (v->loop) {
+                    v->pos = 0;
+                } else {
+                    v->playing = SDL_FALSE;
+                }
+            }
+        }
+    }
+}
+
+#endif /* __XBOX__ */
+
+/* vi: set ts=4 sw=4 expandtab: */
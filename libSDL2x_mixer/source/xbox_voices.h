@@ -0,0 +1,48 @@
+/*
+  SDL_mixer:  An audio mixer library based on the SDL library
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef XBOX_VOICES_H_
+#define XBOX_VOICES_H_
+
+/* Hardware voices that play chunks straight from their sample memory.
+   Voices are numbered 0 to count-1; all of them share the mixer format.
+   Call these with the audio lock held. */
+
+extern int XboxVoice_Open(const SDL_AudioSpec *spec, int count);
+extern void XboxVoice_Close(void);
+
+extern int XboxVoice_Start(int voice, Uint8 *data, Uint32 len, SDL_bool loop);
+extern void XboxVoice_Stop(int voice);
+extern void XboxVoice_Pause(int voice, SDL_bool pause);
+extern SDL_bool XboxVoice_IsPlaying(int voice);
+
+/* volume is 0 to MIX_MAX_VOLUME, left and right are 0 to 255 like
+   Mix_SetPanning(); swap sends the left channel to the right speaker. */
+extern void XboxVoice_SetLevels(int voice, int volume, Uint8 left, Uint8 right, SDL_bool swap);
+/* frequency in Hz, or 0 for the mixer rate */
+extern void XboxVoice_SetFrequency(int voice, int frequency);
+
+/* Adds what the voices play during len bytes of the stream to it. The APU
+   mixes its voices itself, so this only does work off the Xbox. */
+extern void XboxVoice_Mix(Uint8 *stream, int len);
+
+#endif /* XBOX_VOICES_H_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
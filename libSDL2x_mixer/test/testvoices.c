@@ -0,0 +1,223 @@
+/*
+  SDL_mixer:  An audio mixer library based on the SDL library
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Runs the mixer's hardware voice path on the software stand-in voices and
+   checks how channels are given voices and how their loops are played. The
+   mixer source is built into this test so the checks can look at its
+   private state; the SDL functions it needs are stubbed below, with the
+   audio callback called directly. */
+
+#include "mixer.c"
+
+#include <string.h>
+
+#include "testxbox.h"
+
+/* ------------------------------- Harness --------------------------------- */
+
+#define TEST_PERIOD 1024
+
+static Uint32 ticks;
+static Uint8 samples[TEST_PERIOD];
+static Uint8 stream[TEST_PERIOD];
+static int mixed_bytes;
+static int finished[8];
+static int num_finished;
+
+Uint32 SDL_GetTicks(void) { return ticks; }
+Uint32 SDL_WasInit(Uint32 flags) { return flags; }
+int SDL_InitSubSystem(Uint32 flags) { (void)flags; return 0; }
+char *SDL_getenv(const char *name) { (void)name; return NULL; }
+int SDL_strcmp(const char *a, const char *b) { return strcmp(a, b); }
+int SDL_AtomicGet(SDL_atomic_t *a) { return a->value; }
+int SDL_AtomicSet(SDL_atomic_t *a, int v) { const int old = a->value; a->value = v; return old; }
+
+SDL_AudioDeviceID
+SDL_OpenAudioDevice(const char *device, int iscapture, const SDL_AudioSpec *desired,
+                    SDL_AudioSpec *obtained, int allowed_changes)
+{
+    (void)device; (void)iscapture; (void)allowed_changes;
+    *obtained = *desired;
+    obtained->silence = 0;
+    obtained->size = (Uint32)desired->samples * desired->channels * (SDL_AUDIO_BITSIZE(desired->format) / 8);
+    return 1;
+}
+
+void SDL_CloseAudioDevice(SDL_AudioDeviceID dev) { (void)dev; }
+void SDL_PauseAudioDevice(SDL_AudioDeviceID dev, int pause_on) { (void)dev; (void)pause_on; }
+void SDL_LockAudioDevice(SDL_AudioDeviceID dev) { (void)dev; }
+void SDL_UnlockAudioDevice(SDL_AudioDeviceID dev) { (void)dev; }
+
+/* Counts what the voices mix out of the test samples. */
+void
+SDL_MixAudioFormat(Uint8 *dst, const Uint8 *src, SDL_AudioFormat format, Uint32 len, int volume)
+{
+    (void)dst; (void)format; (void)volume;
+    if (src >= samples && src + len <= samples + sizeof(samples)) {
+        mixed_bytes += (int)len;
+    }
+}
+
+/* Loading is not tested; these only satisfy the linker. */
+int SDL_BuildAudioCVT(SDL_AudioCVT *cvt, SDL_AudioFormat sf, Uint8 sc, int sr, SDL_AudioFormat df, Uint8 dc, int dr)
+{ (void)cvt; (void)sf; (void)sc; (void)sr; (void)df; (void)dc; (void)dr; return SDL_Unsupported(); }
+int SDL_ConvertAudio(SDL_AudioCVT *cvt) { (void)cvt; return SDL_Unsupported(); }
+SDL_AudioSpec *SDL_LoadWAV_RW(SDL_RWops *src, int freesrc, SDL_AudioSpec *spec, Uint8 **buf, Uint32 *len)
+{ (void)src; (void)freesrc; (void)spec; (void)buf; (void)len; return NULL; }
+void SDL_FreeWAV(Uint8 *buf) { (void)buf; }
+SDL_AudioSpec *Mix_LoadAIFF_RW(SDL_RWops *src, int freesrc, SDL_AudioSpec *spec, Uint8 **buf, Uint32 *len)
+{ (void)src; (void)freesrc; (void)spec; (void)buf; (void)len; return NULL; }
+SDL_AudioSpec *Mix_LoadVOC_RW(SDL_RWops *src, int freesrc, SDL_AudioSpec *spec, Uint8 **buf, Uint32 *len)
+{ (void)src; (void)freesrc; (void)spec; (void)buf; (void)len; return NULL; }
+SDL_RWops *SDL_RWFromFile(const char *file, const char *mode) { (void)file; (void)mode; return NULL; }
+int SDL_RWclose(SDL_RWops *context) { (void)context; return 0; }
+size_t SDL_RWread(SDL_RWops *context, void *ptr, size_t size, size_t n) { (void)context; (void)ptr; (void)size; (void)n; return 0; }
+Sint64 SDL_RWseek(SDL_RWops *context, Sint64 offset, int whence) { (void)context; (void)offset; (void)whence; return -1; }
+Sint64 SDL_RWtell(SDL_RWops *context) { (void)context; return -1; }
+
+/* No music. */
+int get_num_music_interfaces(void) { return 0; }
+Mix_MusicInterface *get_music_interface(int index) { (void)index; return NULL; }
+Mix_MusicType detect_music_type(SDL_RWops *src) { (void)src; return MUS_NONE; }
+SDL_bool load_music_type(Mix_MusicType type) { (void)type; return SDL_FALSE; }
+SDL_bool open_music_type(Mix_MusicType type) { (void)type; return SDL_FALSE; }
+void open_music(const SDL_AudioSpec *spec) { (void)spec; }
+void SDLCALL music_mixer(void *udata, Uint8 *s, int len) { (void)udata; (void)s; (void)len; }
+void pause_async_music(int pause_on) { (void)pause_on; }
+void close_music(void) { }
+void unload_music(void) { }
+int Mix_SetMusicCMD(const char *command) { (void)command; return 0; }
+int Mix_VolumeMusic(int volume) { (void)volume; return MIX_MAX_VOLUME; }
+
+static void SDLCALL
+TestChannelFinished(int channel)
+{
+    if (num_finished < (int)SDL_arraysize(finished)) {
+        finished[num_finished] = channel;
+    }
+    ++num_finished;
+}
+
+/* Opens the mixer with two voices and returns a chunk of one period. */
+static Mix_Chunk *
+TestOpen(void)
+{
+    XBOX_CHECK_INT(Mix_OpenAudio(22050, AUDIO_S16LSB, 2, TEST_PERIOD / 4), 0);
+    XBOX_CHECK_INT(Mix_AllocateXboxVoices(2), 2);
+    Mix_ChannelFinished(TestChannelFinished);
+    num_finished = 0;
+    mixed_bytes = 0;
+    return Mix_QuickLoad_RAW(samples, sizeof(samples));
+}
+
+static void
+TestClose(Mix_Chunk *chunk)
+{
+    Mix_FreeChunk(chunk);
+    Mix_CloseAudio();
+}
+
+/* -------------------------------- Tests ---------------------------------- */
+
+/* With every voice busy, a new chunk takes the voice of the channel that
+   has been playing longest. */
+static void
+TestStealOldest(void)
+{
+    Mix_Chunk *chunk = TestOpen();
+    int voice;
+
+    ticks = 100;
+    XBOX_CHECK_INT(Mix_PlayChannel(0, chunk, -1), 0);
+    ticks = 200;
+    XBOX_CHECK_INT(Mix_PlayChannel(1, chunk, -1), 1);
+    XBOX_CHECK_INT(num_finished, 0);
+    voice = mix_channel[0].voice;
+    XBOX_CHECK(voice >= 0);
+
+    ticks = 300;
+    XBOX_CHECK_INT(Mix_PlayChannel(2, chunk, -1), 2);
+    XBOX_CHECK_INT(num_finished, 1);
+    XBOX_CHECK_INT(finished[0], 0);
+    XBOX_CHECK_INT(Mix_Playing(0), 0);
+    XBOX_CHECK_INT(mix_channel[0].voice, -1);
+    XBOX_CHECK_INT(mix_channel[2].voice, voice);
+    XBOX_CHECK_INT(voice_channel[voice], 2);
+
+    /* now channel 1 is the oldest */
+    ticks = 400;
+    XBOX_CHECK_INT(Mix_PlayChannel(0, chunk, -1), 0);
+    XBOX_CHECK_INT(num_finished, 2);
+    XBOX_CHECK_INT(finished[1], 1);
+    XBOX_CHECK_INT(Mix_Playing(1), 0);
+
+    /* restarting a channel finishes only that channel and reuses its voice */
+    ticks = 500;
+    XBOX_CHECK_INT(Mix_PlayChannel(2, chunk, -1), 2);
+    XBOX_CHECK_INT(num_finished, 3);
+    XBOX_CHECK_INT(finished[2], 2);
+    XBOX_CHECK_INT(Mix_Playing(0), 1);
+    XBOX_CHECK_INT(Mix_Playing(2), 1);
+
+    TestClose(chunk);
+}
+
+/* A chunk played with loops plays loops + 1 times, then finishes; -1 loops
+   until halted. */
+static void
+TestLoops(void)
+{
+    Mix_Chunk *chunk = TestOpen();
+    int i;
+
+    XBOX_CHECK_INT(Mix_PlayChannel(0, chunk, 2), 0);
+    for (i = 0; i < 8 && !num_finished; ++i) {
+        mix_channels(NULL, stream, sizeof(stream));
+    }
+    XBOX_CHECK_INT(num_finished, 1);
+    XBOX_CHECK_INT(mixed_bytes, 3 * TEST_PERIOD);
+    XBOX_CHECK_INT(Mix_Playing(0), 0);
+    XBOX_CHECK_INT(mix_channel[0].voice, -1);
+
+    mixed_bytes = 0;
+    XBOX_CHECK_INT(Mix_PlayChannel(1, chunk, -1), 1);
+    for (i = 0; i < 8; ++i) {
+        mix_channels(NULL, stream, sizeof(stream));
+    }
+    XBOX_CHECK_INT(num_finished, 1);
+    XBOX_CHECK_INT(mixed_bytes, 8 * TEST_PERIOD);
+    XBOX_CHECK_INT(Mix_HaltChannel(1), 0);
+    XBOX_CHECK_INT(num_finished, 2);
+    XBOX_CHECK_INT(finished[1], 1);
+
+    TestClose(chunk);
+}
+
+int
+main(int argc, char *argv[])
+{
+    TestStealOldest();
+    TestLoops();
+
+    return testxbox_done("testvoices");
+}
+
+/* vi: set ts=4 sw=4 expandtab: */